@@ -27,7 +27,7 @@ operator<<(std::ostream& out, const ExtensionCandidate& ec)
 		<< ec.sext << delim
 		<< ec.score << delim
 		<< ec.qsize << delim
-		<< ec.ssize << std::endl;
+		<< ec.ssize << "\n";
 	return out;
 }
 
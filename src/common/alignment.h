@@ -1,6 +1,7 @@
 #ifndef ALIGNMENT_H
 #define ALIGNMENT_H
 
+#include <algorithm>
 #include <fstream>
 
 #include "defs.h"
@@ -209,6 +210,7 @@ struct M5Record
 	double	ident;		// 20) identity percentage
 	idx_t	qext;
 	idx_t 	sext;
+	idx_t	aln_capacity;	// size of pm_q, pm_p and pm_s of a record made by NewM5Record
 };
 
 #define m5qid(m) 		((m).qid)
@@ -244,10 +246,26 @@ inline M5Record* NewM5Record(idx_t maxAlnSize)
 	m5qaln(*m5) = new char[maxAlnSize];
 	m5saln(*m5) = new char[maxAlnSize];
 	m5pat(*m5) = new char[maxAlnSize];
+	m5->aln_capacity = maxAlnSize;
 	
 	return m5;
 }
 
+// makes room for an alignment of alnSize characters and its terminating null,
+// the stored alignment is lost
+inline void ReserveM5Record(M5Record& m5, idx_t alnSize)
+{
+	if (alnSize + 1 <= m5.aln_capacity) return;
+	const idx_t capacity = std::max(alnSize + 1, 2 * m5.aln_capacity);
+	delete[] m5qaln(m5);
+	delete[] m5saln(m5);
+	delete[] m5pat(m5);
+	m5qaln(m5) = new char[capacity];
+	m5saln(m5) = new char[capacity];
+	m5pat(m5) = new char[capacity];
+	m5.aln_capacity = capacity;
+}
+
 inline M5Record* DeleteM5Record(M5Record* m5)
 {
 	if (!m5) return NULL;
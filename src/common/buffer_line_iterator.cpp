@@ -2,9 +2,8 @@
 
 BufferLineReader::BufferLineReader(const char* file_name)
 {
-    if (!fb_.open(file_name, std::ios::in)) ERROR("cannot open file \'%s\' for reading", file_name);
-
-    ins_ = new std::istream(&fb_);
+    in_ = gzopen(file_name, "rb");
+    if (!in_) ERROR("cannot open file \'%s\' for reading", file_name);
     buf_ = new char[kBufferSize];
     done_ = false;
     unget_line_ = false;
@@ -118,9 +117,12 @@ void BufferLineReader::x_load_long()
 
 bool BufferLineReader::x_read_buffer()
 {
-    std::streambuf* sb = ins_->rdbuf();
-    bool ok = sb && ins_->good();
-    std::streamsize r = ok ? sb->sgetn(buf_, kBufferSize) : 0;
+    int r = done_ ? 0 : gzread(in_, buf_, kBufferSize);
+    if (r < 0)
+    {
+        int errnum;
+        ERROR("failed to read input: %s", gzerror(in_, &errnum));
+    }
     buf_sz_ = (idx_t)r;
     cur_ = 0;
     if (buf_sz_ == 0)
@@ -135,7 +137,7 @@ bool BufferLineReader::x_read_buffer()
 
 BufferLineReader::~BufferLineReader()
 {
-    delete ins_;
+    gzclose(in_);
     delete[] buf_;
 }
 
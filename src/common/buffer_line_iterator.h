@@ -4,14 +4,15 @@
 #include <cstring>
 #include <stdint.h>
 
-#include <iostream> // std::ios std::istream
-#include <fstream>  // std::filebuf
 #include <string>
 #include <vector>
 
+#include <zlib.h>
+
 #include "defs.h"
 #include "pod_darr.h"
 
+// reads the lines of a plain or gzip compressed file
 class BufferLineReader
 {
 public:
@@ -37,8 +38,7 @@ private:
     bool x_read_buffer();
     
 private:
-    std::filebuf    fb_;
-    std::istream*   ins_;
+    gzFile          in_;
     static const idx_t kBufferSize = 1024 * 1024 * 8;
     char*           buf_;
     idx_t         cur_;
@@ -110,6 +110,18 @@ do { \
 	} \
 } while(0)
 
+// grows arr, that holds capacity elements, to hold count elements at least.
+// the elements are kept, capacity is updated.
+#define safe_reserve(arr, type, capacity, count) \
+do { \
+	if ((size_t)(count) > (size_t)(capacity)) \
+	{ \
+		size_t __sv__cap__ = MAX((size_t)(count), 2 * (size_t)(capacity)); \
+		safe_realloc(arr, type, __sv__cap__); \
+		(capacity) = __sv__cap__; \
+	} \
+} while(0)
+
 #include <new>
 #define snew(arr, type, count) \
 	do { \
@@ -199,11 +211,14 @@ const u1_t* get_dna_complement_table();
 #define FWD 0
 #define REV 1
 #define REVERSE_STRAND(s) (1-(s))
-#define MAX_SEQ_SIZE 500000
+// reads longer than this are skipped unless the ceiling is changed on the command line
+#define DEFAULT_MAX_READ_SIZE 10000000L
 #define MAX_INVALID_END_SIZE 200
 #define MIN_EXTEND_SIZE 500
 #define MIN_OVERLAP_SIZE 1000
 #define TECH_PACBIO 0
 #define TECH_NANOPORE 1
+#define EXT_KERNEL_DIFF 0
+#define EXT_KERNEL_SIMD 1
 
 #endif //  DEFS_H
@@ -9,115 +9,19 @@
 
 using namespace std;
 
-struct SCompareDPathData2
-{
-    bool operator()(const DPathData2& a, const DPathData2& b) {
-        return (a.d == b.d) ? (a.k < b.k) : (a.d < b.d);
-    }
-};
-
-struct DPathDataExtractor
-{
-	DPathData2* operator()(const int d, const int k)
-	{
-		target.d = d;
-		target.k = k;
-		return std::lower_bound(d_path_list, d_path_list + d_path_list_size, target, scmp);
-	}
-	
-	DPathDataExtractor(DPathData2* d_path, const int n)
-		: d_path_list(d_path),
-		  d_path_list_size(n) {
-		  }
-	
-    DPathData2 target;
-	SCompareDPathData2 scmp;
-	DPathData2* d_path_list;
-	const int d_path_list_size;
-};
-
-void
-GetAlignString(const char* query, const int q_len, 
-			   const char* target, const int t_len,
-			   DPathData2* d_path, const int d_path_size,
-			   PathPoint* aln_path, Alignment* align,
-			   const int qe, const int te, 
-			   int d, int k,
-			   const int right_extend)
-{
-	int cd = d;
-	int ck = k;
-	int aln_path_idx = 0;
-	int i;
-	DPathDataExtractor dpath_extrator(d_path, d_path_size);
-	while (cd >= 0 && aln_path_idx < q_len + t_len + 1)
-	{
-		DPathData2* d_path_aux = dpath_extrator(cd, ck);
-		aln_path[aln_path_idx].x = d_path_aux->x2;
-		aln_path[aln_path_idx].y = d_path_aux->y2;
-		++aln_path_idx;
-		aln_path[aln_path_idx].x = d_path_aux->x1;
-		aln_path[aln_path_idx].y = d_path_aux->y1;
-		++aln_path_idx;
-		ck = d_path_aux->pre_k;
-		cd -= 1;
-	}
-	--aln_path_idx;
-	int cx = aln_path[aln_path_idx].x;
-	int cy = aln_path[aln_path_idx].y;
-	align->aln_q_s = cx;
-	align->aln_t_s = cy;
-	int aln_pos = 0;
-	while (aln_path_idx > 0)
-	{
-		--aln_path_idx;
-		int nx = aln_path[aln_path_idx].x;
-		int ny = aln_path[aln_path_idx].y;
-		if (cx == nx && cy == ny) continue;
-		
-		if (cx == nx && cy != ny) {
-			for (i = 0; i < ny - cy; ++i) {
-				align->q_aln_str[aln_pos + i] = GAP_CODE;
-				align->t_aln_str[aln_pos + i] = extract_char<char>(target, cy + i, right_extend);
-			}
-			aln_pos += ny - cy;
-		} else if (cx != nx && cy == ny) {
-			for (i = 0; i < nx - cx; ++i) {
-				align->q_aln_str[aln_pos + i] = extract_char<char>(query, cx + i, right_extend);
-				align->t_aln_str[aln_pos + i] = GAP_CODE;
-			}
-			aln_pos += nx - cx;
-		} else {
-			for (i = 0; i < nx - cx; ++i) {
-				align->q_aln_str[aln_pos + i] = extract_char<char>(query, cx + i, right_extend);
-			}
-			for (i = 0; i < ny - cy; ++i) {
-				align->t_aln_str[aln_pos + i] = extract_char<char>(target, cy + i, right_extend);
-			}
-			aln_pos += ny - cy;
-		}
-		
-		cx = nx;
-		cy = ny;
-	}
-	align->aln_str_size = aln_pos;
-}
-			   
-
 int Align(const char* query, const int q_len, const char* target, const int t_len,
 		  const int band_tolerance, const int get_aln_str, Alignment* align,
-		  int* V, int* U, DPathData2* d_path, PathPoint* aln_path, const int right_extend)
+		  int* V, int* U, DiffTrace* trace, const int right_extend)
 {
 	int k_offset;
 	int  d;
 	int  k, k2;
 	int best_m;
-	int min_k, new_min_k, max_k, new_max_k, pre_k;
+	int min_k, new_min_k, max_k, new_max_k;
 	int x = -1, y = -1;
 	int max_d, band_size;
-	unsigned long d_path_idx = 0, max_idx = 0;
 	int aligned = 0;
-	int best_x = -1, best_y = -1, best_d = q_len + t_len + 100, best_k = 0, best_d_path_idx = -1;
+	int best_x = -1, best_y = -1, best_d = q_len + t_len + 100, best_k = 0;
 
 	max_d = (int)(.3 * (q_len + t_len));
 	k_offset = max_d;
@@ -126,34 +30,27 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
 	best_m = -1;
 	min_k = 0;
 	max_k = 0;
-	d_path_idx = 0;
-	max_idx = 0;
+	trace->clear();
 
 	for (d = 0; d < max_d; ++d)
 	{
 		if (max_k - min_k > band_size) break;
 		
+		trace->start_d(min_k, max_k);
 		for (k = min_k; k <= max_k; k += 2)
 		{
 			if( k == min_k || (k != max_k && V[k - 1 + k_offset] < V[k + 1 + k_offset]) )
-			{ pre_k = k + 1; x = V[k + 1 + k_offset]; }
+			{ x = V[k + 1 + k_offset]; }
 			else
-			{ pre_k = k - 1; x = V[k - 1 + k_offset] + 1; }
+			{ x = V[k - 1 + k_offset] + 1; }
 			y = x - k;
-			d_path[d_path_idx].d = d;
-			d_path[d_path_idx].k = k;
-			d_path[d_path_idx].x1 = x;
-			d_path[d_path_idx].y1 = y;
 
 			if (right_extend)
 				while( x < q_len && y < t_len && query[x] == target[y]) { ++x; ++y; }
 			else
 				while( x < q_len && y < t_len && query[-x] == target[-y]) { ++x; ++y; }
 
-			d_path[d_path_idx].x2 = x;
-			d_path[d_path_idx].y2 = y;
-			d_path[d_path_idx].pre_k = pre_k;
-			++d_path_idx;
+			trace->add(x);
 
 			V[k + k_offset] = x;
 			U[k + k_offset] = x + y;
@@ -163,10 +60,9 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
 				best_y = y;
 				best_d = d;
 				best_k = k;
-				best_d_path_idx = d_path_idx;
 			}
 			if (x >= q_len || y >= t_len)
-			{ aligned = 1; max_idx = d_path_idx; break; }
+			{ aligned = 1; break; }
 		}
 
 		// for banding
@@ -188,7 +84,7 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
 			align->aln_t_s = 0;
 
 			if (get_aln_str) {
-				GetAlignString(query, q_len, target, t_len, d_path, max_idx, aln_path, align, x, y, d, k, right_extend);
+				align->aln_str_size = trace->traceback(query, target, d, k, right_extend, GAP_CODE, align->q_aln_str, align->t_aln_str);
 			}
 			break;
 		} 
@@ -203,7 +99,7 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
 			align->aln_q_s = 0;
 			align->aln_t_s = 0;
 			if (get_aln_str) {
-				GetAlignString(query, q_len, target, t_len, d_path, best_d_path_idx, aln_path, align, best_x, best_y, best_d, best_k, right_extend);
+				align->aln_str_size = trace->traceback(query, target, best_d, best_k, right_extend, GAP_CODE, align->q_aln_str, align->t_aln_str);
 			}
 		} else {
 			align->aln_q_e = 0;
@@ -218,44 +114,79 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
 	return (align->aln_q_e == q_len || align->aln_t_e == t_len);
 }
 
-void dw_in_one_direction(const char* query, const int query_size, const char* target, const int target_size,
-						 int* U, int* V, Alignment* align, DPathData2* d_path, PathPoint* aln_path,
-						 DiffAlignParameters* swp, OutputStore* result, const int right_extend)
+void
+DiffAligner::align_block(const char* query, const int q_len,
+						 const char* target, const int t_len,
+						 const int right_extend)
+{
+	fill(dynq, dynq + param.row_size, 0);
+	fill(dynt, dynt + param.column_size, 0);
+	Align(query, q_len, target, t_len, 0.3 * max(q_len, t_len), 400, align, dynq, dynt, &trace, right_extend);
+}
+
+// the alignment of a block from the end point of diff_simd_align: like Align,
+// the furthest reaching point is kept when no end is reached
+static void
+get_block_alignment(const char* query, const char* target, const int right_extend,
+					const bool aligned, const DiffPoint& end, const DiffTrace& trace, Alignment* align)
 {
-	const int kTailMatchBP = 4;
-	const int kBlkSize = swp->segment_size;
-	int qidx = 0, tidx = 0;
+	align->init();
+	if (aligned || end.x > 0) {
+		align->aln_q_e = end.x;
+		align->aln_t_e = end.y;
+		align->dist = end.d;
+		align->aln_str_size = trace.traceback(query, target, end.d, end.k, right_extend, GAP_CODE, align->q_aln_str, align->t_aln_str);
+	} else {
+		align->dist = 0;
+	}
+}
+
+void
+SimdDiffAligner::align_block(const char* query, const int q_len,
+							 const char* target, const int t_len,
+							 const int right_extend)
+{
+	DiffPoint end;
+	const bool aligned = diff_simd_align(query, q_len, target, t_len, 0.3 * max(q_len, t_len), (int)(.3 * (q_len + t_len)),
+										 right_extend, &sd, &trace, end);
+	get_block_alignment(query, target, right_extend, aligned, end, trace, align);
+}
+
+// the block by block extension of dw_in_one_direction
+struct DiffExtension
+{
+	const char* query;
+	const char* target;
+	int query_size;
+	int target_size;
+	int right_extend;
+	int qidx, tidx;
 	int qblk, tblk;
-	const char* seq1;
-	const char* seq2;
-	while (1) {
-		fill(U, U + swp->row_size, 0);
-		fill(V, V + swp->column_size, 0);
-		bool last_block = retrieve_next_aln_block(query,
-												  qidx,
-												  query_size,
-												  target,
-												  tidx,
-												  target_size,
-												  kBlkSize,
-												  right_extend,
-												  seq1,
-												  seq2,
-												  qblk,
-												  tblk);	  
-		Align(seq1,
-			  qblk,
-			  seq2,
-			  tblk,
-			  0.3 * max(qblk, tblk),
-			  400,
-			  align,
-			  U, 
-			  V,
-			  d_path,
-			  aln_path,
-			  right_extend);
-		
+	bool last_block;
+
+	DiffExtension(const char* q, const int qsize, const char* t, const int tsize, const int r)
+		: query(q), target(t), query_size(qsize), target_size(tsize), right_extend(r),
+		  qidx(0), tidx(0), qblk(0), tblk(0), last_block(false) {}
+
+	// sets up the next block
+	void next_block(const int kBlkSize, const char*& seq1, const char*& seq2) {
+		last_block = retrieve_next_aln_block(query,
+											 qidx,
+											 query_size,
+											 target,
+											 tidx,
+											 target_size,
+											 kBlkSize,
+											 right_extend,
+											 seq1,
+											 seq2,
+											 qblk,
+											 tblk);
+	}
+
+	// appends the alignment of the block to result, false if the extension stops here
+	bool add_block(Alignment* align, OutputStore* result) {
+		const int kTailMatchBP = 4;
 		int qcnt = 0, tcnt = 0, acnt = 0;
 		const bool trim = trim_mismatch_end(align->q_aln_str, 
 											align->t_aln_str, 
@@ -264,7 +195,7 @@ void dw_in_one_direction(const char* query, const int query_size, const char* ta
 											qcnt, 
 											tcnt, 
 											acnt);
-		if (!trim) break;
+		if (!trim) return false;
 		
 		bool full_map = false;
 		if (qblk - align->aln_q_e <= 20 || tblk - align->aln_t_e <= 20) full_map = true;
@@ -285,27 +216,29 @@ void dw_in_one_direction(const char* query, const int query_size, const char* ta
 			result->left_store_size += align->aln_str_size;
 		}
 		
-		if (last_block || (!full_map)) break;
+		if (last_block || (!full_map)) return false;
 		qidx += (align->aln_q_e - qcnt);
 		tidx += (align->aln_t_e - tcnt);
+		return true;
 	}
+};
+
+void dw_in_one_direction(const char* query, const int query_size, const char* target, const int target_size,
+						 DiffAligner* aligner, const int right_extend)
+{
+	DiffExtension ext(query, query_size, target, target_size, right_extend);
+	const char* seq1;
+	const char* seq2;
+	do {
+		ext.next_block(aligner->param.segment_size, seq1, seq2);
+		aligner->align_block(seq1, ext.qblk, seq2, ext.tblk, right_extend);
+	} while (ext.add_block(aligner->align, aligner->result));
 }
 
-bool
-DiffAligner::go(const char* query, const int qstart, const int qsize, 
-				const char* target, const int tstart, const int tsize,
-				const int min_aln_size)
+// joins the left and right extensions in result into its output strings
+static bool
+merge_extensions(const int qstart, const int tstart, OutputStore* result, const int min_aln_size)
 {
-	result->init();
-	align->init();
-	dw_in_one_direction(query + qstart - 1, qstart, 
-						target + tstart - 1, tstart,
-						dynq, dynt, align, d_path, 
-						aln_path, &param, result, 0);
-	dw_in_one_direction(query + qstart, qsize - qstart,
-						target + tstart, tsize - tstart,
-						dynq, dynt, align, d_path,
-						aln_path, &param, result, 1);
 	int i, j, k, idx = 0;
 	const char* dt = "ACGT-";
 	for (k = result->left_store_size - 1, i = 0, j = 0; k >= 0; --k, ++idx) {
@@ -347,3 +280,95 @@ DiffAligner::go(const char* query, const int qstart, const int qsize,
 	
 	return result->out_store_size >= min_aln_size;
 }
+
+bool
+DiffAligner::go(const char* query, const int qstart, const int qsize, 
+				const char* target, const int tstart, const int tsize,
+				const int min_aln_size)
+{
+	// the alignment has qsize + tsize columns at most
+	result->reserve(qsize + tsize + 1);
+	result->init();
+	align->init();
+	dw_in_one_direction(query + qstart - 1, qstart, 
+						target + tstart - 1, tstart,
+						this, 0);
+	dw_in_one_direction(query + qstart, qsize - qstart,
+						target + tstart, tsize - tstart,
+						this, 1);
+	return merge_extensions(qstart, tstart, result, min_aln_size);
+}
+
+DiffBatchAligner::DiffBatchAligner(const int large_block, const int num_slots)
+{
+	param.init(large_block);
+	slot_capacity = num_slots;
+	snew(results, OutputStore*, slot_capacity);
+	snew(aligns, Alignment*, 2 * slot_capacity);
+	for (int i = 0; i < slot_capacity; ++i) results[i] = new OutputStore(param.max_aln_size);
+	for (int i = 0; i < 2 * slot_capacity; ++i) aligns[i] = new Alignment(param.segment_aln_size);
+	snew(traces, DiffTrace, 2 * slot_capacity);
+	snew(blocks, DiffSimdBlock, 2 * slot_capacity);
+}
+
+DiffBatchAligner::~DiffBatchAligner()
+{
+	for (int i = 0; i < slot_capacity; ++i) delete results[i];
+	for (int i = 0; i < 2 * slot_capacity; ++i) delete aligns[i];
+	sfree(results);
+	sfree(aligns);
+	sfree(traces);
+	sfree(blocks);
+}
+
+void
+DiffBatchAligner::go(DiffBatchSlot* slots, const int n, const int min_aln_size)
+{
+	r_assert(n <= slot_capacity);
+
+	// extension 2 * i is the left extension of slot i, 2 * i + 1 its right extension
+	vector<DiffExtension> exts;
+	exts.reserve(2 * n);
+	for (int i = 0; i < n; ++i) {
+		DiffBatchSlot& slot = slots[i];
+		slot.result = results[i];
+		slot.result->reserve(slot.qsize + slot.tsize + 1);
+		slot.result->init();
+		exts.push_back(DiffExtension(slot.query + slot.qstart - 1, slot.qstart,
+									 slot.target + slot.tstart - 1, slot.tstart, 0));
+		exts.push_back(DiffExtension(slot.query + slot.qstart, slot.qsize - slot.qstart,
+									 slot.target + slot.tstart, slot.tsize - slot.tstart, 1));
+	}
+
+	// every round aligns the next block of all the running extensions together
+	vector<int> running;
+	for (int e = 0; e < 2 * n; ++e) running.push_back(e);
+	while (!running.empty()) {
+		const int num_blocks = running.size();
+		for (int i = 0; i < num_blocks; ++i) {
+			DiffExtension& ext = exts[running[i]];
+			DiffSimdBlock& b = blocks[i];
+			ext.next_block(param.segment_size, b.query, b.target);
+			b.q_len = ext.qblk;
+			b.t_len = ext.tblk;
+			b.band_tolerance = 0.3 * max(b.q_len, b.t_len);
+			b.max_d = (int)(.3 * (b.q_len + b.t_len));
+			b.right_extend = ext.right_extend;
+			b.trace = traces + i;
+		}
+		diff_simd_align_batch(blocks, num_blocks, &sd);
+
+		int r = 0;
+		for (int i = 0; i < num_blocks; ++i) {
+			const int e = running[i];
+			const DiffSimdBlock& b = blocks[i];
+			Alignment* align = aligns[e];
+			get_block_alignment(b.query, b.target, b.right_extend, b.aligned, b.end, *b.trace, align);
+			if (exts[e].add_block(align, slots[e / 2].result)) running[r++] = e;
+		}
+		running.resize(r);
+	}
+
+	for (int i = 0; i < n; ++i)
+		slots[i].aligned = merge_extensions(slots[i].qstart, slots[i].tstart, slots[i].result, min_aln_size);
+}
@@ -3,8 +3,11 @@
 
 #include "defs.h"
 #include "alignment.h"
+#include "diff_simd.h"
+#include "diff_trace.h"
 #include "gapalign.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -16,10 +19,7 @@ struct DiffAlignParameters
     idx row_size;
     idx column_size;
     idx segment_aln_size;
-    idx max_seq_size;
-    idx max_aln_size;
-    idx d_path_size;
-    idx aln_path_size;
+    idx max_aln_size;	// initial size of the output, grown for longer sequences
 	
 	void init(const int large_block = 0) {
 		if (large_block) {
@@ -27,19 +27,13 @@ struct DiffAlignParameters
             row_size = 4096;
             column_size = 4096;
             segment_aln_size = 4096;
-            max_seq_size = MAX_SEQ_SIZE;
-            max_aln_size = MAX_SEQ_SIZE;
-            d_path_size = 5000000;
-            aln_path_size = 5000000;
+            max_aln_size = 100000;
         } else {
             segment_size = 500;
             row_size = 4096;
             column_size = 4096;
             segment_aln_size = 4096;
-            max_seq_size = MAX_SEQ_SIZE;
-            max_aln_size = MAX_SEQ_SIZE;
-            d_path_size = 5000000;
-            aln_path_size = 5000000;
+            max_aln_size = 100000;
         }
 	}
 };
@@ -86,6 +80,7 @@ struct OutputStore
 	int out_store_size;
 	int query_start, query_end;
 	int target_start, target_end;
+	idx capacity;
 	
 	double calc_ident() const {
 		if (out_store_size == 0) return 0.0;
@@ -97,15 +92,31 @@ struct OutputStore
 	}
 	
 	OutputStore(const idx max_aln_size) {
-		snew(left_store1, char, max_aln_size);
-		snew(left_store2, char, max_aln_size);
-		snew(right_store1, char, max_aln_size);
-		snew(right_store2, char, max_aln_size);
-		snew(out_store1, char, max_aln_size);
-		snew(out_store2, char, max_aln_size);
+		alloc(max_aln_size);
 	}
 	
 	~OutputStore() {
+		release();
+	}
+	
+	// makes room for an alignment of aln_size columns, the stored one is lost
+	void reserve(const idx aln_size) {
+		if (aln_size <= capacity) return;
+		release();
+		alloc(std::max(aln_size, 2 * capacity));
+	}
+	
+	void alloc(const idx size) {
+		capacity = size;
+		snew(left_store1, char, size);
+		snew(left_store2, char, size);
+		snew(right_store1, char, size);
+		snew(right_store2, char, size);
+		snew(out_store1, char, size);
+		snew(out_store2, char, size);
+	}
+	
+	void release() {
 		sfree(left_store1);
 		sfree(left_store2);
 		sfree(right_store1);
@@ -119,21 +130,6 @@ struct OutputStore
 	}
 };
 
-struct DPathData
-{
-    int pre_k, x1, y1, x2, y2;
-};
-
-struct DPathData2
-{
-    int d, k, pre_k, x1, y1, x2, y2;
-};
-
-struct PathPoint
-{
-    int x, y;
-};
-
 class DiffAligner : public GapAligner
 {
 public:
@@ -143,8 +139,6 @@ public:
 		result = new OutputStore(param.max_aln_size);
         snew(dynq, int, param.row_size);
         snew(dynt, int, param.column_size);
-        snew(d_path, DPathData2, param.d_path_size);
-        snew(aln_path, PathPoint, param.aln_path_size);
     }
     
     virtual ~DiffAligner() {
@@ -152,8 +146,6 @@ public:
 		delete result;
         sfree(dynq);
         sfree(dynt);
-        sfree(d_path);
-        sfree(aln_path);
     }
 
 	virtual bool go(const char* query, const int qstart, const int qsize, 
@@ -188,14 +180,73 @@ public:
 		return result->out_store2;
 	}
 
+	// aligns one block of an extension into align
+	virtual void align_block(const char* query, const int q_len,
+							 const char* target, const int t_len,
+							 const int right_extend);
+
 public:
     DiffAlignParameters    	param;
     int*           		 	dynq;
     int*            		dynt;
     Alignment*       		align;
     OutputStore*     		result;
-    DPathData2*     		d_path;
-    PathPoint*      		aln_path;
+    DiffTrace				trace;
+};
+
+// a DiffAligner whose blocks are aligned by the vectorized kernel of diff_simd.h,
+// which gives the alignments of Align.
+class SimdDiffAligner : public DiffAligner
+{
+public:
+	SimdDiffAligner(const int large_block) : DiffAligner(large_block) {}
+
+	virtual void align_block(const char* query, const int q_len,
+							 const char* target, const int t_len,
+							 const int right_extend);
+
+private:
+	DiffSimdData sd;
+};
+
+// one candidate of DiffBatchAligner: the arguments of DiffAligner::go and its result
+struct DiffBatchSlot
+{
+	const char* query;
+	int qstart;
+	int qsize;
+	const char* target;
+	int tstart;
+	int tsize;
+
+	OutputStore* result;
+	bool aligned;
+};
+
+// aligns up to num_slots candidates of a read like SimdDiffAligner does.
+// the left and right extensions of all the candidates advance one block at a time,
+// the blocks of a round being aligned together by diff_simd_align_batch.
+// the results are kept in the aligner and handed out to the slots of go.
+class DiffBatchAligner
+{
+public:
+	DiffBatchAligner(const int large_block, const int num_slots);
+	~DiffBatchAligner();
+
+	void go(DiffBatchSlot* slots, const int num_slots, const int min_aln_size);
+
+	int max_slots() const {
+		return slot_capacity;
+	}
+
+private:
+	DiffAlignParameters		param;
+	int						slot_capacity;
+	OutputStore**			results;
+	Alignment**				aligns;		// 2 * i is the left extension of slot i, 2 * i + 1 its right one
+	DiffTrace*				traces;
+	DiffSimdBlock*			blocks;
+	DiffSimdData			sd;
 };
 
 #endif // DIFF_GAPALIGN_H
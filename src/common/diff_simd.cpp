@@ -0,0 +1,474 @@
+#include "diff_simd.h"
+
+#include <algorithm>
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIFF_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+// the snakes read up to 8 bytes past the end of a block
+#define DIFF_SIMD_PAD 16
+// the padding of the query and of the target differ from each other and from the bases,
+// so a snake stops at the end of a block without checking for it
+#define QUERY_PAD_BASE 0xFE
+#define TARGET_PAD_BASE 0xFF
+
+DiffSimdData::DiffSimdData()
+	: seqs(NULL), seqs_capacity(0), diags(NULL), deltas(NULL), diags_capacity(0), order(NULL), order_capacity(0)
+{
+}
+
+DiffSimdData::~DiffSimdData()
+{
+	if (seqs) safe_free(seqs);
+	if (diags) safe_free(diags);
+	if (deltas) safe_free(deltas);
+	if (order) safe_free(order);
+}
+
+void
+DiffSimdData::reserve(const long seqs_size, const long num_diags)
+{
+	if (seqs_size > seqs_capacity)
+	{
+		if (seqs) safe_free(seqs);
+		seqs_capacity = std::max(seqs_size, 2 * seqs_capacity);
+		safe_malloc(seqs, u1_t, seqs_capacity);
+	}
+	if (num_diags > diags_capacity)
+	{
+		if (diags) safe_free(diags);
+		if (deltas) safe_free(deltas);
+		diags_capacity = std::max(num_diags, 2 * diags_capacity);
+		safe_malloc(diags, int, diags_capacity);
+		safe_malloc(deltas, int, diags_capacity);
+	}
+}
+
+// copies a block to s followed by its padding, returns the size taken
+static long
+copy_block(const char* seq, const int len, const int right_extend, const u1_t pad, u1_t* s)
+{
+	if (right_extend) memcpy(s, seq, len);
+	else for (int i = 0; i < len; ++i) s[i] = seq[-i];
+	memset(s + len, pad, DIFF_SIMD_PAD);
+	return len + DIFF_SIMD_PAD;
+}
+
+// follows the matches from query position a of s to target position a + delta, 8 bases at a time.
+// returns the query position of the first mismatch.
+static inline int
+snake(const u1_t* s, const int a, const int delta)
+{
+	const u1_t* p = s + a;
+	const u1_t* q = p + delta;
+	while (1)
+	{
+		u8_t u, v;
+		memcpy(&u, p, sizeof(u8_t));
+		memcpy(&v, q, sizeof(u8_t));
+		const u8_t z = u ^ v;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		if (z) return (int)(p - s) + (__builtin_clzll(z) >> 3);
+#else
+		if (z) return (int)(p - s) + (__builtin_ctzll(z) >> 3);
+#endif
+		p += 8;
+		q += 8;
+	}
+}
+
+// runs the snakes of the diagonals starting at the query positions A[0, n) of s.
+// the target position of diagonal i is A[i] + D[i], or A[i] + delta - 2 * i
+// for the consecutive diagonals of one block, which pass no D.
+static void
+extend_snakes(const u1_t* s, int* A, const int* D, const int delta, const int n)
+{
+	if (D) for (int i = 0; i < n; ++i) A[i] = snake(s, A[i], D[i]);
+	else for (int i = 0; i < n; ++i) A[i] = snake(s, A[i], delta - 2 * i);
+}
+
+#ifdef DIFF_SIMD_AVX2
+// 8 diagonals at a time: the next 4 bases of every diagonal are gathered and compared
+// together, the diagonals that match all of them continue one by one.
+__attribute__((target("avx2"))) static void
+extend_snakes_avx2(const u1_t* s, int* A, const int* D, const int delta, const int n)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i four = _mm256_set1_epi32(4);
+	const __m256i byte_mask = _mm256_set1_epi32(0xff);
+	const __m256i bias = _mm256_set1_epi32(127);
+	const __m256i step = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(A + i));
+		const __m256i dv = D ? _mm256_loadu_si256((const __m256i*)(D + i))
+							 : _mm256_sub_epi32(_mm256_set1_epi32(delta - 2 * i), step);
+		const __m256i a = _mm256_i32gather_epi32((const int*)s, x, 1);
+		const __m256i b = _mm256_i32gather_epi32((const int*)s, _mm256_add_epi32(x, dv), 1);
+		const __m256i z = _mm256_xor_si256(a, b);
+		const __m256i full = _mm256_cmpeq_epi32(z, zero);
+		// the matching bytes below the lowest set bit of z, which is found
+		// in the exponent of that bit converted to a float
+		const __m256i low = _mm256_and_si256(z, _mm256_sub_epi32(zero, z));
+		const __m256i e = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(low)), 23);
+		const __m256i bytes = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_and_si256(e, byte_mask), bias), 3);
+		x = _mm256_add_epi32(x, _mm256_blendv_epi8(bytes, four, full));
+		_mm256_storeu_si256((__m256i*)(A + i), x);
+		for (int m = _mm256_movemask_ps(_mm256_castsi256_ps(full)); m; m &= m - 1)
+		{
+			const int l = i + __builtin_ctz(m);
+			A[l] = snake(s, A[l], D ? D[l] : delta - 2 * l);
+		}
+	}
+	for (; i < n; ++i) A[i] = snake(s, A[i], D ? D[i] : delta - 2 * i);
+}
+#endif
+
+static inline void
+set_point(DiffPoint& p, const int x, const int y, const int d, const int k)
+{
+	p.x = x;
+	p.y = y;
+	p.d = d;
+	p.k = k;
+}
+
+// a block being aligned, laid out in DiffSimdData::seqs
+struct DiffState
+{
+	int q_off, t_off;
+	int q_len, t_len;
+	int band_tolerance, max_d;
+	DiffTrace* trace;
+	int d, min_k, max_k, best_m;
+	int* X;		// the points of the diagonals of d in the trace
+	int n;
+	DiffPoint end;
+
+	void init(const int qo, const int ql, const int to, const int tl,
+			  const int tolerance, const int md, DiffTrace* tr) {
+		q_off = qo;
+		q_len = ql;
+		t_off = to;
+		t_len = tl;
+		band_tolerance = tolerance;
+		max_d = md;
+		trace = tr;
+		d = min_k = max_k = 0;
+		best_m = -1;
+		set_point(end, -1, -1, 0, 0);
+		trace->clear();
+	}
+};
+
+// the kernel steps below are inlined into a plain and an AVX2 build, the loops
+// over the diagonals of a d are written for the compiler to vectorize.
+
+// starts the diagonals of the next d: the diagonal k starts from the furthest of
+// k + 1 and k - 1 (plus one) of d - 1, the outermost diagonals from their only neighbour.
+// the start points are written to A as positions in seqs, or to the room for the
+// points of d taken in the trace when A is NULL. returns the number of diagonals,
+// 0 once the block is out of distance or band.
+static inline __attribute__((always_inline)) int
+start_d(DiffState& s, int* A)
+{
+	if (s.d >= s.max_d || s.max_k - s.min_k > s.band_tolerance * 2) return 0;
+	const int n = (s.max_k - s.min_k) / 2 + 1;
+	const int off = s.q_off;
+	s.X = s.trace->start_d_points(s.min_k, s.max_k);
+	s.n = n;
+	if (!A) A = s.X;
+	if (s.d == 0)
+	{
+		A[0] = off;
+	}
+	else
+	{
+		int prev_min_k;
+		const int* P = s.trace->points_of(s.d - 1, prev_min_k);
+		// R[i] is diagonal k + 1 of the point i at d - 1, R[i - 1] its diagonal k - 1
+		const int* R = P + (s.min_k + 1 - prev_min_k) / 2;
+		A[0] = R[0] + off;
+		for (int i = 1; i < n - 1; ++i) A[i] = std::max(R[i], R[i - 1] + 1) + off;
+		if (n > 1) A[n - 1] = R[n - 2] + 1 + off;
+	}
+	return n;
+}
+
+// the offsets from the query to the target position of the diagonals of d
+static inline __attribute__((always_inline)) void
+set_deltas(const DiffState& s, int* D)
+{
+	const int delta = s.t_off - s.q_off - s.min_k;
+	const int n = s.n;
+	for (int i = 0; i < n; ++i) D[i] = delta - 2 * i;
+}
+
+// keeps the ends A of the snakes of d in the trace, takes their best point and
+// prunes the band for d + 1. returns true when a diagonal reached the end of a block.
+static inline __attribute__((always_inline)) bool
+end_d(DiffState& s, const int* A)
+{
+	int* X = s.X;
+	const int n = s.n;
+	const int d = s.d;
+	const int off = s.q_off;
+	int min_k = s.min_k, max_k = s.max_k;
+
+	// the largest x + y of d and whether a diagonal reached the end of a block,
+	// the ends are moved to the trace on the way when the snakes ran elsewhere
+	int m = -1, reached = 0;
+	const int q_len = s.q_len, t_len = s.t_len;
+	if (A != X) for (int i = 0; i < n; ++i)
+	{
+		const int k = min_k + 2 * i;
+		const int x = A[i] - off;
+		X[i] = x;
+		m = std::max(m, 2 * x - k);
+		reached |= (x >= q_len) | (x - k >= t_len);
+	}
+	else for (int i = 0; i < n; ++i)
+	{
+		const int k = min_k + 2 * i;
+		m = std::max(m, 2 * X[i] - k);
+		reached |= (X[i] >= q_len) | (X[i] - k >= t_len);
+	}
+	if (reached)
+	{
+		// the first diagonal to reach the end is taken, after the best
+		// point of the diagonals before it
+		for (int i = 0; ; ++i)
+		{
+			const int k = min_k + 2 * i;
+			const int x = X[i];
+			const int y = x - k;
+			if (x + y > s.best_m)
+			{
+				s.best_m = x + y;
+				set_point(s.end, x, y, d, k);
+			}
+			if (x >= s.q_len || y >= s.t_len)
+			{
+				set_point(s.end, x, y, d, k);
+				return true;
+			}
+		}
+	}
+	if (m > s.best_m)
+	{
+		int i = 0;
+		while (2 * X[i] - (min_k + 2 * i) != m) ++i;
+		s.best_m = m;
+		set_point(s.end, X[i], X[i] - (min_k + 2 * i), d, min_k + 2 * i);
+	}
+
+	// for banding, the diagonals from the first to the last one within band_tolerance of best_m
+	const int min_m = s.best_m - s.band_tolerance;
+	int lo = 0, hi = n - 1;
+	while (lo < n && 2 * X[lo] - (min_k + 2 * lo) < min_m) ++lo;
+	if (lo == n)
+	{
+		std::swap(min_k, max_k);
+	}
+	else
+	{
+		while (2 * X[hi] - (min_k + 2 * hi) < min_m) --hi;
+		max_k = min_k + 2 * hi;
+		min_k += 2 * lo;
+	}
+	s.min_k = min_k - 1;
+	s.max_k = max_k + 1;
+	++s.d;
+	return false;
+}
+
+static inline __attribute__((always_inline)) void
+run_snakes(const u1_t* seqs, int* A, const int* D, const int delta, const int n, const bool avx2)
+{
+#ifdef DIFF_SIMD_AVX2
+	if (avx2) extend_snakes_avx2(seqs, A, D, delta, n);
+	else
+#endif
+	extend_snakes(seqs, A, D, delta, n);
+}
+
+// the diff of Align over one block, see diff_simd_align.
+// the query is at the start of seqs, so the points in the trace are positions in seqs.
+static inline __attribute__((always_inline)) bool
+diff_block(DiffState& s, DiffSimdData* data, const bool avx2)
+{
+	while (start_d(s, NULL))
+	{
+		run_snakes(data->seqs, s.X, NULL, s.t_off - s.min_k, s.n, avx2);
+		if (end_d(s, s.X)) return true;
+	}
+	return false;
+}
+
+// the diff of Align over the blocks of a batch in lock step, see diff_simd_align_batch.
+// every d, the diagonals of all the running blocks are gathered into data->diags
+// as positions in data->seqs and run their snakes together.
+static inline __attribute__((always_inline)) void
+diff_batch(DiffState* S, bool* aligned, const int num_blocks, DiffSimdData* data, const bool avx2)
+{
+	int running[DIFF_SIMD_BATCH_BLOCKS];
+	int begin[DIFF_SIMD_BATCH_BLOCKS];
+	int num_running = 0;
+	for (int b = 0; b < num_blocks; ++b)
+	{
+		aligned[b] = false;
+		running[num_running++] = b;
+	}
+	while (num_running)
+	{
+		int num_diags = 0, r = 0;
+		for (int i = 0; i < num_running; ++i)
+		{
+			DiffState& s = S[running[i]];
+			if (!start_d(s, data->diags + num_diags)) continue;
+			set_deltas(s, data->deltas + num_diags);
+			begin[r] = num_diags;
+			num_diags += s.n;
+			running[r++] = running[i];
+		}
+		num_running = r;
+
+		run_snakes(data->seqs, data->diags, data->deltas, 0, num_diags, avx2);
+
+		r = 0;
+		for (int i = 0; i < num_running; ++i)
+		{
+			const int b = running[i];
+			if (end_d(S[b], data->diags + begin[i])) aligned[b] = true;
+			else running[r++] = b;
+		}
+		num_running = r;
+	}
+}
+
+static bool
+diff_block_plain(DiffState& s, DiffSimdData* data)
+{
+	return diff_block(s, data, false);
+}
+
+static void
+diff_batch_plain(DiffState* S, bool* aligned, const int num_blocks, DiffSimdData* data)
+{
+	diff_batch(S, aligned, num_blocks, data, false);
+}
+
+#ifdef DIFF_SIMD_AVX2
+__attribute__((target("avx2"))) static bool
+diff_block_avx2(DiffState& s, DiffSimdData* data)
+{
+	return diff_block(s, data, true);
+}
+
+__attribute__((target("avx2"))) static void
+diff_batch_avx2(DiffState* S, bool* aligned, const int num_blocks, DiffSimdData* data)
+{
+	diff_batch(S, aligned, num_blocks, data, true);
+}
+#endif
+
+// the AVX2 builds are taken when the cpu running the program has AVX2
+static bool
+select_avx2()
+{
+#ifdef DIFF_SIMD_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return true;
+#endif
+	return false;
+}
+
+static const bool use_avx2 = select_avx2();
+
+bool
+diff_simd_align(const char* query, const int q_len,
+				const char* target, const int t_len,
+				const int band_tolerance, const int max_d, const int right_extend,
+				DiffSimdData* data, DiffTrace* trace, DiffPoint& end)
+{
+	data->reserve(q_len + t_len + 2 * DIFF_SIMD_PAD, 0);
+	const long t_off = copy_block(query, q_len, right_extend, QUERY_PAD_BASE, data->seqs);
+	copy_block(target, t_len, right_extend, TARGET_PAD_BASE, data->seqs + t_off);
+
+	DiffState s;
+	s.init(0, q_len, t_off, t_len, band_tolerance, max_d, trace);
+#ifdef DIFF_SIMD_AVX2
+	const bool aligned = use_avx2 ? diff_block_avx2(s, data) : diff_block_plain(s, data);
+#else
+	const bool aligned = diff_block_plain(s, data);
+#endif
+	end = s.end;
+	return aligned;
+}
+
+struct CmpDiffSimdBlockBySize
+{
+	const DiffSimdBlock* blocks;
+	CmpDiffSimdBlockBySize(const DiffSimdBlock* b) : blocks(b) {}
+	bool operator()(const int a, const int b) const {
+		return blocks[a].q_len + blocks[a].t_len > blocks[b].q_len + blocks[b].t_len;
+	}
+};
+
+void
+diff_simd_align_batch(DiffSimdBlock* blocks, const int num_blocks, DiffSimdData* data)
+{
+	if (num_blocks > data->order_capacity)
+	{
+		if (data->order) safe_free(data->order);
+		data->order_capacity = std::max(num_blocks, 2 * data->order_capacity);
+		safe_malloc(data->order, int, data->order_capacity);
+	}
+	int* order = data->order;
+	for (int i = 0; i < num_blocks; ++i) order[i] = i;
+	std::stable_sort(order, order + num_blocks, CmpDiffSimdBlockBySize(blocks));
+
+	DiffState S[DIFF_SIMD_BATCH_BLOCKS];
+	bool aligned[DIFF_SIMD_BATCH_BLOCKS];
+	for (int g = 0; g < num_blocks; g += DIFF_SIMD_BATCH_BLOCKS)
+	{
+		const int n = std::min(num_blocks - g, DIFF_SIMD_BATCH_BLOCKS);
+		long seqs_size = 0, num_diags = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			const DiffSimdBlock& b = blocks[order[g + i]];
+			seqs_size += b.q_len + b.t_len + 2 * DIFF_SIMD_PAD;
+			num_diags += b.band_tolerance + 1;
+		}
+		data->reserve(seqs_size, num_diags);
+
+		long off = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			const DiffSimdBlock& b = blocks[order[g + i]];
+			const long q_off = off;
+			off += copy_block(b.query, b.q_len, b.right_extend, QUERY_PAD_BASE, data->seqs + off);
+			const long t_off = off;
+			off += copy_block(b.target, b.t_len, b.right_extend, TARGET_PAD_BASE, data->seqs + off);
+			S[i].init(q_off, b.q_len, t_off, b.t_len, b.band_tolerance, b.max_d, b.trace);
+		}
+
+#ifdef DIFF_SIMD_AVX2
+		if (use_avx2) diff_batch_avx2(S, aligned, n, data);
+		else
+#endif
+		diff_batch_plain(S, aligned, n, data);
+
+		for (int i = 0; i < n; ++i)
+		{
+			DiffSimdBlock& b = blocks[order[g + i]];
+			b.aligned = aligned[i];
+			b.end = S[i].end;
+		}
+	}
+}
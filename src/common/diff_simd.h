@@ -0,0 +1,72 @@
+#ifndef DIFF_SIMD_H
+#define DIFF_SIMD_H
+
+#include "defs.h"
+#include "diff_trace.h"
+
+// vectorized block kernel of the O(ND) diff aligners.
+// it runs the recurrence of Align exactly: the same diagonals are started from the
+// same points of d - 1, the band is pruned from the same best point and the first
+// diagonal to reach the end of a sequence is taken, so the ends and the traceback
+// are those of Align. the work is reorganized across the diagonals of a d:
+// the start points of all the diagonals are computed together, the snakes compare
+// 8 bases at a time and, on cpus with AVX2, 8 diagonals run their snakes side by side.
+
+// number of blocks diff_simd_align_batch advances together
+#define DIFF_SIMD_BATCH_BLOCKS 8
+
+struct DiffSimdData
+{
+	u1_t* seqs;		// the blocks in the order they are aligned, each padded with bases that match nothing
+	long seqs_capacity;
+	int* diags;		// the diagonals whose snakes run together: query positions in seqs
+	int* deltas;	// and the offset from there to the target position
+	long diags_capacity;
+	int* order;		// the blocks of a batch by size
+	int order_capacity;
+
+	DiffSimdData();
+	~DiffSimdData();
+	void reserve(const long seqs_size, const long num_diags);
+};
+
+// the furthest reaching point x (query), y (target) of diagonal k = x - y with d indels
+struct DiffPoint
+{
+	int x, y, d, k;
+};
+
+// aligns query[0, q_len) and target[0, t_len) (query[0], query[-1], ... when right_extend is 0)
+// as Align does with the given band tolerance and distance bound, leaving the points in trace.
+// returns true when the end of one of them is reached, end is then the point that reached it.
+// otherwise end is the first point with the largest x + y, end.x is -1 if there is none.
+bool
+diff_simd_align(const char* query, const int q_len,
+				const char* target, const int t_len,
+				const int band_tolerance, const int max_d, const int right_extend,
+				DiffSimdData* data, DiffTrace* trace, DiffPoint& end);
+
+// one block of diff_simd_align_batch: the arguments of diff_simd_align and its results
+struct DiffSimdBlock
+{
+	const char* query;
+	int q_len;
+	const char* target;
+	int t_len;
+	int band_tolerance;
+	int max_d;
+	int right_extend;
+	DiffTrace* trace;
+
+	bool aligned;
+	DiffPoint end;
+};
+
+// aligns every block as diff_simd_align does. the blocks are taken by size,
+// DIFF_SIMD_BATCH_BLOCKS of similar size at a time, and advance d in lock step:
+// the snakes of the diagonals of all of them share the vector lanes, so a
+// vector mixes the diagonals of several blocks.
+void
+diff_simd_align_batch(DiffSimdBlock* blocks, const int num_blocks, DiffSimdData* data);
+
+#endif // DIFF_SIMD_H
@@ -0,0 +1,49 @@
+#include "diff_trace.h"
+
+#include <algorithm>
+
+int
+DiffTrace::traceback(const char* query, const char* target,
+					 int d, int k, const int right_extend, const char gap,
+					 char* q_aln_str, char* t_aln_str) const
+{
+	const int dir = right_extend ? 1 : -1;
+	int n = 0;
+	int x = point(d, k);
+	while (1) {
+		int x1 = 0, pre_k = k;
+		if (d > 0) {
+			const Band& b = bands[d];
+			if (k == b.min_k || (k != b.max_k && point(d - 1, k - 1) < point(d - 1, k + 1))) {
+				pre_k = k + 1;
+				x1 = point(d - 1, k + 1);
+			} else {
+				pre_k = k - 1;
+				x1 = point(d - 1, k - 1) + 1;
+			}
+		}
+
+		for (; x > x1; --x, ++n) {
+			q_aln_str[n] = query[dir * (x - 1)];
+			t_aln_str[n] = target[dir * (x - 1 - k)];
+		}
+		if (d == 0) break;
+
+		if (pre_k == k + 1) {
+			q_aln_str[n] = gap;
+			t_aln_str[n] = target[dir * (x - 1 - k)];
+		} else {
+			q_aln_str[n] = query[dir * (x - 1)];
+			t_aln_str[n] = gap;
+		}
+		++n;
+
+		x = point(d - 1, pre_k);
+		k = pre_k;
+		--d;
+	}
+
+	std::reverse(q_aln_str, q_aln_str + n);
+	std::reverse(t_aln_str, t_aln_str + n);
+	return n;
+}
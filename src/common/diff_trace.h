@@ -0,0 +1,72 @@
+#ifndef DIFF_TRACE_H
+#define DIFF_TRACE_H
+
+#include <algorithm>
+#include <vector>
+
+// traceback store of the O(ND) diff.
+// for every edit distance d, the furthest reaching x of the diagonals
+// min_k, min_k + 2, ..., max_k is kept in a flat array indexed by d and k.
+// the diagonal a point comes from is recomputed from the points of d - 1
+// the same way the diff chose it, so the traceback needs no search and runs
+// in time linear in the alignment size.
+class DiffTrace
+{
+public:
+	void clear() {
+		points.clear();
+		bands.clear();
+	}
+
+	// starts the diagonals min_k, min_k + 2, ..., max_k of the next d
+	void start_d(const int min_k, const int max_k) {
+		Band b;
+		b.offset = points.size();
+		b.min_k = min_k;
+		b.max_k = max_k;
+		bands.push_back(b);
+	}
+
+	// the furthest reaching x of the next diagonal of the current d
+	void add(const int x) {
+		points.push_back(x);
+	}
+
+	// starts the next d like start_d and returns the room for the points of its
+	// diagonals, which the caller fills in instead of adding them one by one
+	int* start_d_points(const int min_k, const int max_k) {
+		start_d(min_k, max_k);
+		points.resize(points.size() + std::max(0, (max_k - min_k) / 2 + 1));
+		return points.data() + bands.back().offset;
+	}
+
+	// the points of the diagonals min_k, min_k + 2, ... of distance d
+	const int* points_of(const int d, int& min_k) const {
+		min_k = bands[d].min_k;
+		return points.data() + bands[d].offset;
+	}
+
+	// writes the alignment of query[0, x) and target[0, x - k) that ends with
+	// diagonal k of distance d, query[0], query[-1], ... when right_extend is 0.
+	// returns the size of the alignment.
+	int traceback(const char* query, const char* target,
+				  int d, int k, const int right_extend, const char gap,
+				  char* q_aln_str, char* t_aln_str) const;
+
+private:
+	int point(const int d, const int k) const {
+		const Band& b = bands[d];
+		return points[b.offset + ((k - b.min_k) >> 1)];
+	}
+
+private:
+	struct Band
+	{
+		int offset;
+		int min_k, max_k;
+	};
+	std::vector<int>  points;
+	std::vector<Band> bands;
+};
+
+#endif // DIFF_TRACE_H
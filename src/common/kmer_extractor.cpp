@@ -0,0 +1,107 @@
+#include "kmer_extractor.h"
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+void
+pack_codes(const char* s, const int size, u1_t* pac)
+{
+	int i = 0;
+#ifdef __AVX2__
+	{
+		const __m256i w1 = _mm256_set1_epi16(0x0104);
+		const __m256i w2 = _mm256_set1_epi32(0x00010010);
+		const __m256i shf = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+											 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+			v = _mm256_madd_epi16(_mm256_maddubs_epi16(v, w1), w2);
+			v = _mm256_shuffle_epi8(v, shf);
+			int lo = _mm256_extract_epi32(v, 0), hi = _mm256_extract_epi32(v, 4);
+			memcpy(pac + i / 4, &lo, 4);
+			memcpy(pac + i / 4 + 4, &hi, 4);
+		}
+	}
+#endif
+#ifdef __SSSE3__
+	{
+		// c0 * 4 + c1 per 16-bit lane, then (c0 * 4 + c1) * 16 + c2 * 4 + c3 per 32-bit lane
+		const __m128i w1 = _mm_set1_epi16(0x0104);
+		const __m128i w2 = _mm_set1_epi32(0x00010010);
+		const __m128i shf = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+			v = _mm_madd_epi16(_mm_maddubs_epi16(v, w1), w2);
+			v = _mm_shuffle_epi8(v, shf);
+			int x = _mm_cvtsi128_si32(v);
+			memcpy(pac + i / 4, &x, 4);
+		}
+	}
+#endif
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	// 8 codes at a time in a 64-bit word
+	for (; i + 8 <= size; i += 8)
+	{
+		u8_t x;
+		memcpy(&x, s + i, 8);
+		x = ((x << 2) | (x >> 8)) & 0x00ff00ff00ff00ffULL;
+		x = ((x << 4) | (x >> 16)) & 0x000000ff000000ffULL;
+		pac[i / 4] = (u1_t)x;
+		pac[i / 4 + 1] = (u1_t)(x >> 32);
+	}
+#endif
+	for (; i < size; i += 4)
+	{
+		u1_t b = 0;
+		for (int j = 0; j < 4; ++j) b = (b << 2) | (i + j < size ? s[i + j] : 0);
+		pac[i / 4] = b;
+	}
+}
+
+int
+extract_strided_kmers(const u1_t* pac, const idx_t pac_bytes, const idx_t start, const int size,
+					  const int kmer_size, const int stride, int* kmer_ids)
+{
+	if (size < kmer_size) return 0;
+	int num_kmers = (size - kmer_size) / stride + 1;
+	for (int i = 0; i < num_kmers; ++i)
+		kmer_ids[i] = pac_kmer(pac, pac_bytes, start + (idx_t)i * stride, kmer_size);
+	return num_kmers;
+}
+
+int
+extract_strided_kmers_ascii(const char* s, const int size, const int kmer_size, const int stride,
+							u1_t* pac, int* kmer_ids)
+{
+	if (size < kmer_size) return 0;
+	const u1_t* et = get_dna_encode_table();
+	const idx_t pac_bytes = (size + 3) / 4;
+	bool has_ambig = false;
+	for (int i = 0; i < size; i += 4)
+	{
+		u1_t b = 0;
+		for (int j = 0; j < 4; ++j)
+		{
+			u1_t c = (i + j < size) ? et[(u1_t)s[i + j]] : 0;
+			if (c > 3) { has_ambig = true; c = 0; }
+			b = (b << 2) | c;
+		}
+		pac[i / 4] = b;
+	}
+	int num_kmers = extract_strided_kmers(pac, pac_bytes, 0, size, kmer_size, stride, kmer_ids);
+	if (!has_ambig) return num_kmers;
+
+	for (int i = 0; i < size; ++i)
+	{
+		if (et[(u1_t)s[i]] < 4) continue;
+		// k-mers [ceil((i - k + 1) / stride), i / stride] cover base i
+		int from = (i - kmer_size + 1 > 0) ? (i - kmer_size + stride) / stride : 0;
+		int to = i / stride;
+		if (to >= num_kmers) to = num_kmers - 1;
+		for (int j = from; j <= to; ++j) kmer_ids[j] = -1;
+	}
+	return num_kmers;
+}
@@ -0,0 +1,86 @@
+#ifndef KMER_EXTRACTOR_H
+#define KMER_EXTRACTOR_H
+
+#include "defs.h"
+
+#include <cstring>
+
+// k-mer extraction on 2-bit packed sequences.
+// the layout is the one of PackedDB: base i is stored in byte i / 4,
+// the first base of a byte in its two highest bits.
+// k-mers are hashed with the dna encode table (A = 0, C = 1, G = 2, T = 3),
+// the first base in the highest bits.
+
+#define MAX_PAC_KMER_SIZE 29
+
+// 8 bytes of a pac starting at byte i, as a 64-bit word whose highest two bits hold the first base.
+// bytes at or beyond pac_bytes are read as 0.
+static inline u8_t
+load_pac_word(const u1_t* pac, const idx_t i, const idx_t pac_bytes)
+{
+	u8_t w = 0;
+	if (i + 8 <= pac_bytes)
+	{
+		memcpy(&w, pac + i, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		w = __builtin_bswap64(w);
+#endif
+	}
+	else
+	{
+		for (idx_t j = i; j < i + 8; ++j) w = (w << 8) | (j < pac_bytes ? pac[j] : 0);
+	}
+	return w;
+}
+
+// the k-mer starting at base pos
+static inline u8_t
+pac_kmer(const u1_t* pac, const idx_t pac_bytes, const idx_t pos, const int kmer_size)
+{
+	u8_t w = load_pac_word(pac, pos >> 2, pac_bytes);
+	return (w << ((pos & 3) << 1)) >> (64 - 2 * kmer_size);
+}
+
+// calls f(kmer, pos) for every k-mer of the bases [start, start + size), pos being the start of the k-mer.
+// the pac is consumed one 64-bit word (32 bases) at a time.
+template <typename F>
+inline void
+for_each_pac_kmer(const u1_t* pac, const idx_t pac_bytes, const idx_t start, const idx_t size, const int kmer_size, F f)
+{
+	const u8_t mask = (kmer_size >= 32) ? ~(u8_t)0 : ((u8_t)1 << (2 * kmer_size)) - 1;
+	const idx_t end = start + size;
+	idx_t p = start;
+	idx_t n = 0;
+	u8_t kmer = 0;
+	while (p < end)
+	{
+		int skip = p & 3;
+		u8_t w = load_pac_word(pac, p >> 2, pac_bytes) << (skip << 1);
+		idx_t nb = 32 - skip;
+		if (nb > end - p) nb = end - p;
+		for (idx_t j = 0; j < nb; ++j, w <<= 2)
+		{
+			kmer = ((kmer << 2) | (w >> 62)) & mask;
+			if (++n >= kmer_size) f(kmer, p + j + 1 - kmer_size);
+		}
+		p += nb;
+	}
+}
+
+// 2-bit pack size codes (each 0..3) into pac, pac must hold (size + 3) / 4 bytes.
+void
+pack_codes(const char* s, const int size, u1_t* pac);
+
+// k-mers starting at bases start, start + stride, start + 2 * stride, ...
+// of the size bases beginning at start. returns the number of k-mers.
+int
+extract_strided_kmers(const u1_t* pac, const idx_t pac_bytes, const idx_t start, const int size,
+					  const int kmer_size, const int stride, int* kmer_ids);
+
+// as above but from an ascii sequence. pac is used as a work buffer and must hold (size + 3) / 4 bytes.
+// k-mers containing a base other than A, C, G or T are set to -1.
+int
+extract_strided_kmers_ascii(const char* s, const int size, const int kmer_size, const int stride,
+							u1_t* pac, int* kmer_ids);
+
+#endif // KMER_EXTRACTOR_H
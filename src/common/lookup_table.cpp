@@ -1,14 +1,27 @@
 #include "lookup_table.h"
 #include "packed_db.h"
+#include "kmer_extractor.h"
 
 #include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 ref_index*
 destroy_ref_index(ref_index* ridx)
 {
-	safe_free(ridx->kmer_counts);
+	if (ridx->map_addr)
+	{
+		munmap(ridx->map_addr, ridx->map_size);
+	}
+	else
+	{
+		safe_free(ridx->kmer_counts);
+		safe_free(ridx->kmer_offsets);
+	}
 	safe_free(ridx->kmer_starts);
-	safe_free(ridx->kmer_offsets);
 	safe_free(ridx);
 	return NULL;
 }
@@ -16,95 +29,161 @@ destroy_ref_index(ref_index* ridx)
 typedef struct
 {
 	ref_index* ridx;
-	uint32_t min_key;
-	uint32_t max_key;
 	volume_t* v;
-	int kmer_size;
+	// reads [read_from, read_to) for counting and filling
+	int read_from, read_to;
+	// hash keys [min_key, max_key] for sorting the offset lists
+	uint32_t min_key, max_key;
+	int atomic;
 } ref_index_thread_info;
 
+// walk over all k-mers of reads [read_from, read_to).
+// cnt_func(eit, pos) is called with the index key of the k-mer and its start position.
+template <typename CntFunc>
+static void
+scan_volume_kmers(volume_t* v, const int read_from, const int read_to, const ref_index* ridx, CntFunc cnt_func)
+{
+	const idx_t pac_bytes = ((idx_t)v->curr + 3) / 4;
+	for (int i = read_from; i < read_to; ++i)
+	{
+		int read_start = v->offset_list->offset_list[i].offset;
+		int read_size = v->offset_list->offset_list[i].size;
+		for_each_pac_kmer(v->data, pac_bytes, read_start, read_size, ridx->kmer_size,
+						  [&cnt_func, ridx](u8_t kmer, idx_t pos) { cnt_func(ref_index_key(ridx, kmer), (int)pos); });
+	}
+}
+
+void*
+count_ref_index_kmers_func(void* arg)
+{
+	ref_index_thread_info* riti = (ref_index_thread_info*)(arg);
+	int* kmer_counts = riti->ridx->kmer_counts;
+	if (riti->atomic)
+		scan_volume_kmers(riti->v, riti->read_from, riti->read_to, riti->ridx, 
+						  [kmer_counts](uint32_t eit, int) { __sync_fetch_and_add(kmer_counts + eit, 1); });
+	else
+		scan_volume_kmers(riti->v, riti->read_from, riti->read_to, riti->ridx, 
+						  [kmer_counts](uint32_t eit, int) { ++kmer_counts[eit]; });
+	return NULL;
+}
+
 void*
 fill_ref_index_offsets_func(void* arg)
 {
 	ref_index_thread_info* riti = (ref_index_thread_info*)(arg);
-	volume_t* v = riti->v;
-	int num_reads = v->num_reads;
 	ref_index* index = riti->ridx;
-	int kmer_size = riti->kmer_size;
-	uint32_t index_count = 1 << (kmer_size * 2);
-	uint32_t leftnum = 34 - 2 * kmer_size;
-	int i, j;
-	for (i = 0; i < num_reads; ++i)
+	int* kmer_counts = index->kmer_counts;
+	int** kmer_starts = index->kmer_starts;
+	// kmer_counts are used as per-kmer cursors here, they are restored to the counts when all threads finish
+	if (riti->atomic)
+		scan_volume_kmers(riti->v, riti->read_from, riti->read_to, riti->ridx, 
+						  [kmer_counts, kmer_starts](uint32_t eit, int pos)
+						  {
+							  if (kmer_starts[eit]) kmer_starts[eit][__sync_fetch_and_add(kmer_counts + eit, 1)] = pos;
+						  });
+	else
+		scan_volume_kmers(riti->v, riti->read_from, riti->read_to, riti->ridx, 
+						  [kmer_counts, kmer_starts](uint32_t eit, int pos)
+						  {
+							  if (kmer_starts[eit]) kmer_starts[eit][kmer_counts[eit]++] = pos;
+						  });
+	return NULL;
+}
+
+void*
+sort_ref_index_offsets_func(void* arg)
+{
+	ref_index_thread_info* riti = (ref_index_thread_info*)(arg);
+	ref_index* index = riti->ridx;
+	for (uint32_t i = riti->min_key; i <= riti->max_key; ++i)
 	{
-		int read_start = v->offset_list->offset_list[i].offset;
-		int read_size = v->offset_list->offset_list[i].size;
-		uint32_t eit = 0;
-		for (j = 0; j < read_size; ++j)
+		int n = index->kmer_counts[i];
+		if (n < 2) continue;
+		int* a = index->kmer_starts[i];
+		// offset lists are short (at most max_kmer_occ), insertion sort is enough
+		for (int j = 1; j < n; ++j)
 		{
-			int k = read_start + j;
-			uint8_t c = PackedDB::get_char(v->data, k);
-			eit = (eit << 2) | c;
-			assert(eit < index_count);
-			if (j >= kmer_size - 1)
-			{
-				if (index->kmer_starts[eit] && eit >= riti->min_key && eit <= riti->max_key)
-				{
-					index->kmer_starts[eit][index->kmer_counts[eit]] = k + 1 - kmer_size;
-					++index->kmer_counts[eit];
-				}
-				eit <<= leftnum;
-				eit >>= leftnum;
-			}
+			int x = a[j], k = j - 1;
+			while (k >= 0 && a[k] > x) { a[k + 1] = a[k]; --k; }
+			a[k + 1] = x;
 		}
 	}
-	
 	return NULL;
 }
 
+static void
+run_ref_index_threads(void* (*func)(void*), ref_index_thread_info* ritis, const int num_threads)
+{
+	if (num_threads == 1) { func(ritis); return; }
+	pthread_t tids[num_threads];
+	for (int j = 0; j < num_threads; ++j)
+		pthread_create(tids + j, NULL, func, (void*)(ritis + j));
+	for (int j = 0; j < num_threads; ++j)
+		pthread_join(tids[j], NULL);
+}
+
+static ref_index*
+new_ref_index(volume_t* v, int kmer_size, int max_kmer_occ)
+{
+	r_assert(kmer_size > 0 && kmer_size <= MAX_INDEX_KMER_SIZE);
+	ref_index* index = (ref_index*)malloc(sizeof(ref_index));
+	index->kmer_counts = NULL;
+	index->kmer_starts = NULL;
+	index->kmer_offsets = NULL;
+	index->kmer_size = kmer_size;
+	index->max_kmer_occ = max_kmer_occ;
+	index->num_kmers = 0;
+	index->hashed = (2 * kmer_size > MAX_INDEX_KEY_BITS);
+	index->key_bits = index->hashed ? MAX_INDEX_KEY_BITS : 2 * kmer_size;
+	index->pac = v->data;
+	index->pac_bytes = ((int64_t)v->curr + 3) / 4;
+	index->map_addr = NULL;
+	index->map_size = 0;
+	return index;
+}
+
 ref_index*
-create_ref_index(volume_t* v, int kmer_size, int num_threads)
+create_ref_index(volume_t* v, int kmer_size, int max_kmer_occ, int num_threads)
 {
 	DynamicTimer dtimer(__func__);
-	uint32_t index_count = 1 << (kmer_size * 2);
-	uint32_t leftnum = 34 - 2 * kmer_size;
-	ref_index* index = (ref_index*)malloc(sizeof(ref_index));
+	ref_index* index = new_ref_index(v, kmer_size, max_kmer_occ);
+	uint32_t index_count = 1U << index->key_bits;
 	safe_calloc(index->kmer_counts, int, index_count);
+	safe_malloc(index->kmer_starts, int*, index_count);
+	
+	if (v->curr < 10 * 1000000) num_threads = 1;
+	fprintf(stderr, "%d threads are used for building the kmer index.\n", num_threads);
+	ref_index_thread_info ritis[num_threads];
+	// split the reads so that every thread scans about the same number of bases
 	int num_reads = v->num_reads;
-	for (uint32_t i = 0; i != index_count; ++i) assert(index->kmer_counts[i] == 0);
-	for (int i = 0; i != num_reads; ++i)
+	int64_t bases_per_thread = ((int64_t)v->curr + num_threads - 1) / num_threads;
+	int rid = 0;
+	for (int i = 0; i != num_threads; ++i)
 	{
-		int read_start = v->offset_list->offset_list[i].offset;
-		int read_size = v->offset_list->offset_list[i].size;
-		uint32_t eit = 0;
-		for (int j = 0; j < read_size; ++j)
-		{
-			int k = read_start + j;
-			uint8_t c = PackedDB::get_char(v->data, k);
-			assert(c>= 0 && c < 4);
-			eit = (eit << 2) | c;
-			if (j >= kmer_size - 1)
-			{
-				assert(eit < index_count);
-				++index->kmer_counts[eit];
-				eit = eit << leftnum;
-				eit = eit >> leftnum;
-			}
-		}
+		ritis[i].ridx = index;
+		ritis[i].v = v;
+		ritis[i].atomic = (num_threads > 1);
+		ritis[i].read_from = rid;
+		if (i == num_threads - 1) rid = num_reads;
+		else while (rid < num_reads && v->offset_list->offset_list[rid].offset < bases_per_thread * (i + 1)) ++rid;
+		ritis[i].read_to = rid;
 	}
 	
+	// 1) count
+	run_ref_index_threads(count_ref_index_kmers_func, ritis, num_threads);
+	
+	// 2) prefix sum, kmers occurring too often are dropped
 	int num_kmers = 0;
 	for (uint32_t i = 0; i != index_count; ++i) 
 	{
-		if (index->kmer_counts[i] > 128) index->kmer_counts[i] = 0;
+		if (index->kmer_counts[i] > max_kmer_occ) index->kmer_counts[i] = 0;
 		num_kmers += index->kmer_counts[i];
 	}
 	printf("number of kmers: %d\n", num_kmers);
+	index->num_kmers = num_kmers;
 	safe_malloc(index->kmer_offsets, int, num_kmers);
-	safe_malloc(index->kmer_starts, int*, index_count);
 	
-	if (v->curr < 10 * 1000000) num_threads = 1;
 	int kmers_per_thread = (num_kmers + num_threads - 1) / num_threads;
-	fprintf(stderr, "%d threads are used for filling offset lists.\n", num_threads);
-	uint32_t hash_boundaries[2 * num_threads];
 	uint32_t L = 0;
 	num_kmers = 0;
 	int kmer_cnt = 0;
@@ -118,11 +197,10 @@ create_ref_index(volume_t* v, int kmer_size, int num_threads)
 			kmer_cnt += index->kmer_counts[i];
 			index->kmer_counts[i] = 0;
 			
-			if (kmer_cnt >= kmers_per_thread)
+			if (kmer_cnt >= kmers_per_thread && tid < num_threads - 1)
 			{
-				printf("thread %d: %d\t%d\n", tid, L, i);
-				hash_boundaries[2 * tid] = L;
-				hash_boundaries[2 * tid + 1] = i;
+				ritis[tid].min_key = L;
+				ritis[tid].max_key = i;
 				++tid;
 				L = i + 1;
 				kmer_cnt = 0;
@@ -133,28 +211,166 @@ create_ref_index(volume_t* v, int kmer_size, int num_threads)
 			index->kmer_starts[i] = NULL;
 		}
 	}
-	if (kmer_cnt)
+	for (; tid < num_threads; ++tid)
 	{
-		printf("thread %d: %d\t%d\n", tid, L, index_count - 1);
-		hash_boundaries[2 * tid] = L;
-		hash_boundaries[2 * tid + 1] = index_count - 1;
+		ritis[tid].min_key = L;
+		ritis[tid].max_key = index_count - 1;
+		L = index_count;
 	}
 	
-	ref_index_thread_info ritis[num_threads];
-	for (int i = 0; i != num_threads; ++i)
+	// 3) fill, a single scan of the volume
+	run_ref_index_threads(fill_ref_index_offsets_func, ritis, num_threads);
+	
+	// 4) concurrent fills do not keep the offsets in order
+	if (num_threads > 1) run_ref_index_threads(sort_ref_index_offsets_func, ritis, num_threads);
+	
+	return index;
+}
+
+void
+generate_ref_index_file_name(const char* vol_name, char* ridx_name)
+{
+	strcpy(ridx_name, vol_name);
+	strcat(ridx_name, ".ridx");
+}
+
+static uint64_t
+volume_checksum(volume_t* v)
+{
+	// FNV-1a over the offset list and the pac, 8 bytes at a time
+	const uint64_t prime = 1099511628211ULL;
+	uint64_t h = 14695981039346656037ULL;
+	const uint8_t* blocks[2] = { (const uint8_t*)v->offset_list->offset_list, v->data };
+	const int64_t sizes[2] = { (int64_t)sizeof(offset_t) * v->num_reads, ((int64_t)v->curr + 3) / 4 };
+	for (int b = 0; b < 2; ++b)
 	{
-		ritis[i].ridx = index;
-		ritis[i].min_key = hash_boundaries[2 * i];
-		ritis[i].max_key = hash_boundaries[2 * i + 1];
-		ritis[i].v = v;
-		ritis[i].kmer_size = kmer_size;
+		const uint8_t* p = blocks[b];
+		int64_t n = sizes[b], i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			uint64_t w;
+			memcpy(&w, p + i, 8);
+			h = (h ^ w) * prime;
+		}
+		for (; i < n; ++i) h = (h ^ p[i]) * prime;
 	}
+	return h;
+}
+
+static inline int64_t
+ridx_align(int64_t n)
+{
+	return (n + RIDX_ALIGN - 1) / RIDX_ALIGN * RIDX_ALIGN;
+}
+
+static void
+fill_ref_index_header(ref_index_header_t* h, volume_t* v, ref_index* ridx)
+{
+	uint32_t index_count = 1U << ridx->key_bits;
+	memset(h, 0, sizeof(ref_index_header_t));
+	h->magic = RIDX_MAGIC;
+	h->version = RIDX_VERSION;
+	h->kmer_size = ridx->kmer_size;
+	h->max_kmer_occ = ridx->max_kmer_occ;
+	h->num_reads = v->num_reads;
+	h->num_bases = v->curr;
+	h->num_kmers = ridx->num_kmers;
+	h->key_bits = ridx->key_bits;
+	h->volume_checksum = volume_checksum(v);
+	h->counts_start = ridx_align(sizeof(ref_index_header_t));
+	h->offsets_start = ridx_align(h->counts_start + (int64_t)sizeof(int) * index_count);
+}
+
+void
+dump_ref_index(const char* ridx_name, ref_index* ridx, volume_t* v)
+{
+	DynamicTimer dtimer(__func__);
+	static const char zeros[RIDX_ALIGN] = { 0 };
+	uint32_t index_count = 1U << ridx->key_bits;
+	ref_index_header_t h;
+	fill_ref_index_header(&h, v, ridx);
 	
-	pthread_t tids[num_threads];
-	for (int j = 0; j < num_threads; ++j)
-		pthread_create(tids + j, NULL, fill_ref_index_offsets_func, (void*)(ritis + j));
-	for (int j = 0; j < num_threads; ++j)
-		pthread_join(tids[j], NULL);
+	// write to a temporary file first so that an interrupted run never leaves a truncated index behind
+	char tmp_name[2048];
+	sprintf(tmp_name, "%s.working", ridx_name);
+	FILE* out = fopen(tmp_name, "wb");
+	if (!out) { LOG(stderr, "failed to open file \'%s\', the k-mer index will not be saved.", tmp_name); return; }
+	// 1) header
+	SAFE_WRITE(&h, ref_index_header_t, 1, out);
+	SAFE_WRITE(zeros, char, h.counts_start - sizeof(ref_index_header_t), out);
+	// 2) kmer counts
+	SAFE_WRITE(ridx->kmer_counts, int, index_count, out);
+	SAFE_WRITE(zeros, char, h.offsets_start - h.counts_start - (int64_t)sizeof(int) * index_count, out);
+	// 3) kmer offsets
+	SAFE_WRITE(ridx->kmer_offsets, int, ridx->num_kmers, out);
+	fclose(out);
+	if (rename(tmp_name, ridx_name)) ERROR("failed to rename \'%s\' to \'%s\'.", tmp_name, ridx_name);
+}
+
+ref_index*
+load_ref_index(const char* ridx_name, volume_t* v, int kmer_size, int max_kmer_occ)
+{
+	int fd = open(ridx_name, O_RDONLY);
+	if (fd == -1) return NULL;
+	struct stat sb;
+	ref_index_header_t h;
+	if (fstat(fd, &sb) == -1
+		|| (size_t)sb.st_size < sizeof(ref_index_header_t)
+		|| read(fd, &h, sizeof(ref_index_header_t)) != (ssize_t)sizeof(ref_index_header_t)
+		|| h.magic != RIDX_MAGIC
+		|| h.version != RIDX_VERSION
+		|| h.kmer_size != kmer_size
+		|| h.max_kmer_occ != max_kmer_occ
+		|| h.num_reads != v->num_reads
+		|| h.num_bases != v->curr
+		|| h.offsets_start + (int64_t)sizeof(int) * h.num_kmers != sb.st_size)
+	{
+		close(fd);
+		return NULL;
+	}
+	ref_index* index = new_ref_index(v, kmer_size, max_kmer_occ);
+	index->num_kmers = h.num_kmers;
+	ref_index_header_t vh;
+	fill_ref_index_header(&vh, v, index);
+	if (vh.volume_checksum != h.volume_checksum
+		|| vh.key_bits != h.key_bits
+		|| vh.counts_start != h.counts_start
+		|| vh.offsets_start != h.offsets_start)
+	{
+		close(fd);
+		free(index);
+		return NULL;
+	}
+	
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	flags |= MAP_POPULATE;
+#endif
+	void* addr = mmap(NULL, sb.st_size, PROT_READ, flags, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) { free(index); return NULL; }
+	madvise(addr, sb.st_size, MADV_RANDOM);
 	
+	uint32_t index_count = 1U << index->key_bits;
+	index->map_addr = addr;
+	index->map_size = sb.st_size;
+	index->kmer_counts = (int*)((uint8_t*)addr + h.counts_start);
+	index->kmer_offsets = (int*)((uint8_t*)addr + h.offsets_start);
+	safe_malloc(index->kmer_starts, int*, index_count);
+	int64_t num_kmers = 0;
+	for (uint32_t i = 0; i != index_count; ++i)
+	{
+		if (index->kmer_counts[i])
+		{
+			index->kmer_starts[i] = index->kmer_offsets + num_kmers;
+			num_kmers += index->kmer_counts[i];
+		}
+		else
+		{
+			index->kmer_starts[i] = NULL;
+		}
+	}
+	r_assert(num_kmers == h.num_kmers);
+	LOG(stderr, "load k-mer index from \'%s\' (%d kmers).", ridx_name, h.num_kmers);
 	return index;
 }
@@ -3,17 +3,67 @@
 
 #include "split_database.h"
 
+// default cutoff, k-mers occurring more often than this in a volume are not indexed
+#define MAX_KMER_OCC 128
+#define MAX_INDEX_KMER_SIZE 16
+// k-mers longer than MAX_INDEX_KEY_BITS / 2 are hashed into a table of 2^MAX_INDEX_KEY_BITS entries
+#define MAX_INDEX_KEY_BITS 28
+
 typedef struct
 {
 	int*  kmer_counts;
 	int** kmer_starts;
 	int*  kmer_offsets;
+	int   kmer_size;
+	int   max_kmer_occ;
+	int   num_kmers;
+	int   key_bits;
+	// in a hashed index different k-mers share an entry, seeds must be checked against the volume
+	int   hashed;
+	const uint8_t* pac;
+	int64_t pac_bytes;
+	// non-NULL if kmer_counts and kmer_offsets are mapped from an index file
+	void* map_addr;
+	size_t map_size;
 } ref_index;
 
+static inline uint32_t
+ref_index_key(const ref_index* ridx, const uint64_t kmer)
+{
+	if (!ridx->hashed) return (uint32_t)kmer;
+	return (uint32_t)((kmer * 0x9E3779B97F4A7C15ULL) >> (64 - ridx->key_bits));
+}
+
+// on-disk layout of a ref_index:
+// [header | pad] [kmer_counts | pad] [kmer_offsets]
+#define RIDX_MAGIC 0x5844494d // "MIDX"
+#define RIDX_VERSION 2
+#define RIDX_ALIGN 4096
+
+typedef struct
+{
+	int magic, version;
+	int kmer_size, max_kmer_occ;
+	int num_reads, num_bases;
+	int num_kmers, key_bits;
+	uint64_t volume_checksum;
+	int64_t counts_start, offsets_start;
+} ref_index_header_t;
+
 ref_index*
 destroy_ref_index(ref_index* ridx);
 
 ref_index*
-create_ref_index(volume_t* v, int kmer_size, const int num_threads);
+create_ref_index(volume_t* v, int kmer_size, int max_kmer_occ, const int num_threads);
+
+void
+generate_ref_index_file_name(const char* vol_name, char* ridx_name);
+
+void
+dump_ref_index(const char* ridx_name, ref_index* ridx, volume_t* v);
+
+// returns NULL if the file does not exist or was built from a different volume, k-mer size or cutoff
+ref_index*
+load_ref_index(const char* ridx_name, volume_t* v, int kmer_size, int max_kmer_occ);
 
 #endif // LOOKUP_TABLE_H
@@ -0,0 +1,191 @@
+#include "overlap_file.h"
+
+#include <cstring>
+
+using namespace std;
+
+static inline char*
+put_varint(char* p, u8_t v)
+{
+	while (v >= 0x80) 
+	{
+		*p++ = (char)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (char)v;
+	return p;
+}
+
+static inline char*
+put_zigzag(char* p, const i8_t v)
+{
+	return put_varint(p, ((u8_t)v << 1) ^ (u8_t)(v >> 63));
+}
+
+void
+write_overlap_file_header(std::ostream& out, const int record_type, const int flags)
+{
+	OverlapFileHeader h;
+	memset(&h, 0, sizeof(OverlapFileHeader));
+	h.magic = OVLP_FILE_MAGIC;
+	h.version = OVLP_FILE_VERSION;
+	h.record_type = record_type;
+	h.record_size = OVLP_MAX_RECORD_SIZE;
+	h.flags = flags;
+	out.write((const char*)&h, sizeof(OverlapFileHeader));
+}
+
+void
+write_binary_record(std::ostream& out, const ExtensionCandidate& ec)
+{
+	char buf[OVLP_MAX_RECORD_SIZE];
+	char* p = buf;
+	p = put_varint(p, ec.qid);
+	p = put_zigzag(p, ec.sid - ec.qid);
+	*p++ = (char)(ec.qdir | (ec.sdir << 1));
+	p = put_zigzag(p, ec.score);
+	p = put_varint(p, ec.qext);
+	p = put_zigzag(p, ec.qsize - ec.qext);
+	p = put_varint(p, ec.sext);
+	p = put_zigzag(p, ec.ssize - ec.sext);
+	out.write(buf, p - buf);
+}
+
+void
+write_binary_record(std::ostream& out, const M4Record& m4, const bool gapped_start)
+{
+	char buf[OVLP_MAX_RECORD_SIZE];
+	char* p = buf;
+	p = put_varint(p, m4qid(m4));
+	p = put_zigzag(p, m4sid(m4) - m4qid(m4));
+	p = put_varint(p, (u8_t)(m4ident(m4) * OVLP_IDENT_SCALE + 0.5));
+	p = put_zigzag(p, m4vscore(m4));
+	*p++ = (char)(m4qdir(m4) | (m4sdir(m4) << 1));
+	p = put_varint(p, m4qoff(m4));
+	p = put_zigzag(p, m4qend(m4) - m4qoff(m4));
+	p = put_zigzag(p, m4qsize(m4) - m4qend(m4));
+	p = put_varint(p, m4soff(m4));
+	p = put_zigzag(p, m4send(m4) - m4soff(m4));
+	p = put_zigzag(p, m4ssize(m4) - m4send(m4));
+	if (gapped_start)
+	{
+		p = put_zigzag(p, m4qext(m4) - m4qoff(m4));
+		p = put_zigzag(p, m4sext(m4) - m4soff(m4));
+	}
+	out.write(buf, p - buf);
+}
+
+OverlapFileReader::OverlapFileReader(const char* p, const int record_type)
+	: path(p), binary(false), bin_in(NULL), buffer(NULL), buf_size(0), buf_pos(0)
+{
+	memset(&header, 0, sizeof(OverlapFileHeader));
+	bin_in = fopen(path, "rb");
+	if (!bin_in) ERROR("failed to open file '%s'", path);
+	if (fread(&header, sizeof(OverlapFileHeader), 1, bin_in) == 1 && header.magic == OVLP_FILE_MAGIC)
+	{
+		binary = true;
+		if (header.version != OVLP_FILE_VERSION)
+			ERROR("'%s' has version %d, expected %d", path, header.version, OVLP_FILE_VERSION);
+		if (header.record_type != record_type)
+			ERROR("'%s' holds %s records, expected %s records", path,
+				  header.record_type == OVLP_RECORD_CAN ? "can" : "m4",
+				  record_type == OVLP_RECORD_CAN ? "can" : "m4");
+		safe_malloc(buffer, char, kBufferSize);
+	}
+	else
+	{
+		memset(&header, 0, sizeof(OverlapFileHeader));
+		fclose(bin_in);
+		bin_in = NULL;
+		open_fstream(text_in, path, ios::in);
+	}
+}
+
+OverlapFileReader::~OverlapFileReader()
+{
+	if (bin_in) fclose(bin_in);
+	if (buffer) safe_free(buffer);
+	if (text_in.is_open()) close_fstream(text_in);
+}
+
+bool
+OverlapFileReader::fill_buffer()
+{
+	const size_t left = buf_size - buf_pos;
+	if (left) memmove(buffer, buffer + buf_pos, left);
+	buf_size = left + fread(buffer + left, 1, kBufferSize - left, bin_in);
+	buf_pos = 0;
+	return buf_size > left;
+}
+
+// makes sure that a whole record is in the buffer unless the file ends first
+bool
+OverlapFileReader::next_record()
+{
+	if (buf_size - buf_pos < OVLP_MAX_RECORD_SIZE) fill_buffer();
+	return buf_pos < buf_size;
+}
+
+u8_t
+OverlapFileReader::get_varint()
+{
+	u8_t v = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (buf_pos == buf_size) ERROR("'%s' is truncated", path);
+		const u8_t c = (u1_t)buffer[buf_pos++];
+		v |= (c & 0x7f) << shift;
+		if (!(c & 0x80)) return v;
+	}
+	ERROR("'%s' is corrupted", path);
+	return 0;
+}
+
+bool
+OverlapFileReader::read(ExtensionCandidate& ec)
+{
+	if (!binary) return (bool)(text_in >> ec);
+
+	if (!next_record()) return false;
+	ec.qid = get_varint();
+	ec.sid = ec.qid + get_zigzag();
+	if (buf_pos == buf_size) ERROR("'%s' is truncated", path);
+	const int dirs = buffer[buf_pos++];
+	ec.qdir = dirs & 1;
+	ec.sdir = (dirs >> 1) & 1;
+	ec.score = get_zigzag();
+	ec.qext = get_varint();
+	ec.qsize = ec.qext + get_zigzag();
+	ec.sext = get_varint();
+	ec.ssize = ec.sext + get_zigzag();
+	return true;
+}
+
+bool
+OverlapFileReader::read(M4Record& m4)
+{
+	m4qext(m4) = m4sext(m4) = INVALID_IDX;
+	if (!binary) return (bool)(text_in >> m4);
+
+	if (!next_record()) return false;
+	m4qid(m4) = get_varint();
+	m4sid(m4) = m4qid(m4) + get_zigzag();
+	m4ident(m4) = (double)get_varint() / OVLP_IDENT_SCALE;
+	m4vscore(m4) = get_zigzag();
+	if (buf_pos == buf_size) ERROR("'%s' is truncated", path);
+	const int dirs = buffer[buf_pos++];
+	m4qdir(m4) = dirs & 1;
+	m4sdir(m4) = (dirs >> 1) & 1;
+	m4qoff(m4) = get_varint();
+	m4qend(m4) = m4qoff(m4) + get_zigzag();
+	m4qsize(m4) = m4qend(m4) + get_zigzag();
+	m4soff(m4) = get_varint();
+	m4send(m4) = m4soff(m4) + get_zigzag();
+	m4ssize(m4) = m4send(m4) + get_zigzag();
+	if (header.flags & OVLP_FLAG_GAPPED_START)
+	{
+		m4qext(m4) = m4qoff(m4) + get_zigzag();
+		m4sext(m4) = m4soff(m4) + get_zigzag();
+	}
+	return true;
+}
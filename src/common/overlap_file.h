@@ -0,0 +1,82 @@
+#ifndef OVERLAP_FILE_H
+#define OVERLAP_FILE_H
+
+#include <cstdio>
+#include <fstream>
+
+#include "alignment.h"
+
+// binary candidate (can) and overlap (m4) files.
+// a file starts with an OverlapFileHeader which is followed by the records.
+// a record is a run of LEB128 varints: ids and offsets as they are, the sid 
+// as its zigzag coded distance to the qid, ends and sizes as distances to 
+// the offsets and ends before them, and the m4 identity in units of 
+// 1 / OVLP_IDENT_SCALE percent. records do not depend on each other, so 
+// files of bare records can be concatenated.
+
+#define OVLP_FILE_MAGIC		0x5043454d // "MECP"
+#define OVLP_FILE_VERSION	2
+
+#define OVLP_FORMAT_TEXT	0
+#define OVLP_FORMAT_BINARY	1
+
+#define OVLP_RECORD_CAN		0
+#define OVLP_RECORD_M4		1
+
+// m4 records carry the gapped extension start points
+#define OVLP_FLAG_GAPPED_START	1
+
+// no record is longer than this
+#define OVLP_MAX_RECORD_SIZE	128
+
+// the text form prints the identity with 6 significant digits
+#define OVLP_IDENT_SCALE	10000
+
+struct OverlapFileHeader
+{
+	int magic, version;
+	int record_type, record_size;
+	int flags, pad[3];
+};
+
+void
+write_overlap_file_header(std::ostream& out, const int record_type, const int flags);
+
+void
+write_binary_record(std::ostream& out, const ExtensionCandidate& ec);
+
+// the extension start points are written if gapped_start is set
+void
+write_binary_record(std::ostream& out, const M4Record& m4, const bool gapped_start);
+
+// reads both the text and the binary forms, the form is told by the header
+class OverlapFileReader
+{
+public:
+	OverlapFileReader(const char* path, const int record_type);
+	~OverlapFileReader();
+
+	bool read(ExtensionCandidate& ec);
+	bool read(M4Record& m4);
+
+	bool is_binary() const { return binary; }
+	int flags() const { return header.flags; }
+
+private:
+	bool fill_buffer();
+	bool next_record();
+	u8_t get_varint();
+	i8_t get_zigzag() { const u8_t u = get_varint(); return (i8_t)(u >> 1) ^ -(i8_t)(u & 1); }
+
+private:
+	static const size_t kBufferSize = 8 * 1024 * 1024;
+	const char* path;
+	bool binary;
+	OverlapFileHeader header;
+	std::ifstream text_in;
+	FILE* bin_in;
+	char* buffer;
+	size_t buf_size, buf_pos;
+};
+
+#endif // OVERLAP_FILE_H
@@ -81,8 +81,8 @@ PackedDB::load_packed_db(const char* path)
 void
 PackedDB::pack_fasta_db(const char* path, const char* output_prefix, const idx_t min_size)
 {
-	u1_t* buffer;
-	safe_malloc(buffer, u1_t, MAX_SEQ_SIZE);
+	u1_t* buffer = NULL;
+	size_t buffer_size = 0;
 	Sequence read;
 	FastaReader fr(path);
 	string n;
@@ -103,7 +103,8 @@ PackedDB::pack_fasta_db(const char* path, const char* output_prefix, const idx_t
 		if (rsize == -1) break;
 		if (rsize < min_size) continue;
 		Sequence::str_t& s = read.sequence();
-		memset(buffer, 0, MAX_SEQ_SIZE);
+		safe_reserve(buffer, u1_t, buffer_size, (rsize + 3) / 4);
+		memset(buffer, 0, (rsize + 3) / 4);
 		for(idx_t i = 0; i < rsize; ++i)
 		{
 			u1_t c = s[i];
@@ -1,15 +1,18 @@
 #include "split_database.h"
 
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "packed_db.h"
 #include "fasta_reader.h"
 
-#define MSS MAX_SEQ_SIZE
-
 using namespace std;
 
 int
@@ -73,11 +76,14 @@ new_volume_t(int num_reads, int num_bases)
     volume_t* volume = (volume_t*)malloc(sizeof(volume_t));
     volume->num_reads = 0;
     volume->curr = 0;
-	if (num_bases == 0) num_bases = (MCS + MSS);
+	// a volume is dumped before it grows past MCS bases
+	if (num_bases == 0) num_bases = MCS;
     volume->max_size = num_bases;
     idx_t vol_bytes = (num_bases + 3) / 4;
     safe_calloc(volume->data, uint8_t, vol_bytes);
     volume->offset_list = new_offset_list_t(num_reads);
+	volume->map_addr = NULL;
+	volume->map_size = 0;
     return volume;
 }
 
@@ -85,6 +91,7 @@ void
 clear_volume_t(volume_t* v)
 {
     assert(v);
+	assert(!v->map_addr);
     v->num_reads = 0;
     v->curr = 0;
     v->offset_list->curr = 0;
@@ -94,6 +101,14 @@ clear_volume_t(volume_t* v)
 volume_t*
 delete_volume_t(volume_t* v)
 {
+	if (v->map_addr)
+	{
+		// data and offset list live in the mapping
+		munmap(v->map_addr, v->map_size);
+		free(v->offset_list);
+		free(v);
+		return NULL;
+	}
     v->offset_list = delete_offset_list_t(v->offset_list);
     free(v->data);
     free(v);
@@ -132,28 +147,50 @@ extract_one_seq(volume_t* v, const int id, char* s)
 	}
 }
 
+static inline int64_t
+vol_align(int64_t n)
+{
+	return (n + VOL_ALIGN - 1) / VOL_ALIGN * VOL_ALIGN;
+}
+
+static void
+pad_volume_file(FILE* out, int64_t from, int64_t to)
+{
+	static const char zeros[VOL_ALIGN] = { 0 };
+	assert(to - from < VOL_ALIGN);
+	if (to > from) SAFE_WRITE(zeros, char, to - from, out);
+}
+
 void 
 dump_volume(const char* vol_name, volume_t* v)
 {
 	FILE* out = fopen(vol_name, "wb");
 	assert(out);
-	// 1) number of reads
-	SAFE_WRITE(&v->num_reads, int, 1, out);
-	// 2) number of bases
-	SAFE_WRITE(&v->curr, int, 1, out);
-	// 3) start read id
-	SAFE_WRITE(&v->start_read_id, int, 1, out);
-	// 4) offset list
 	assert(v->offset_list->curr == v->num_reads);
+	volume_header_t h;
+	memset(&h, 0, sizeof(volume_header_t));
+	h.magic = VOL_MAGIC;
+	h.version = VOL_VERSION;
+	h.num_reads = v->num_reads;
+	h.num_bases = v->curr;
+	h.start_read_id = v->start_read_id;
+	h.offset_list_start = vol_align(sizeof(volume_header_t));
+	h.pac_start = vol_align(h.offset_list_start + (int64_t)sizeof(offset_t) * v->num_reads);
+	// 1) header
+	SAFE_WRITE(&h, volume_header_t, 1, out);
+	pad_volume_file(out, sizeof(volume_header_t), h.offset_list_start);
+	// 2) offset list
 	SAFE_WRITE(v->offset_list->offset_list, offset_t, v->num_reads, out);
-	// 5) pac
-	int vol_bytes = (v->curr + 3) / 4;
+	pad_volume_file(out, h.offset_list_start + (int64_t)sizeof(offset_t) * v->num_reads, h.pac_start);
+	// 3) pac
+	int64_t vol_bytes = ((int64_t)v->curr + 3) / 4;
 	SAFE_WRITE(v->data, uint8_t, vol_bytes, out);
 	fclose(out);
 }
 
-volume_t*
-load_volume(const char* vol_name)
+// volumes written before the page-aligned layout was introduced
+static volume_t*
+load_volume_stream(const char* vol_name)
 {
 	int num_reads, num_bases;
 	FILE* in = fopen(vol_name, "rb");
@@ -180,6 +217,51 @@ load_volume(const char* vol_name)
 	return v;
 }
 
+volume_t*
+load_volume(const char* vol_name)
+{
+	int fd = open(vol_name, O_RDONLY);
+	if (fd == -1) { LOG(stderr, "failed to open file \'%s\'.", vol_name); exit(1); }
+	struct stat sb;
+	if (fstat(fd, &sb) == -1) ERROR("failed to stat file \'%s\'.", vol_name);
+	
+	volume_header_t h;
+	if ((size_t)sb.st_size < sizeof(volume_header_t)
+		|| read(fd, &h, sizeof(volume_header_t)) != (ssize_t)sizeof(volume_header_t)
+		|| h.magic != VOL_MAGIC)
+	{
+		close(fd);
+		return load_volume_stream(vol_name);
+	}
+	if (h.version != VOL_VERSION) ERROR("volume \'%s\' has version %d, expected %d.", vol_name, h.version, VOL_VERSION);
+	int64_t vol_bytes = ((int64_t)h.num_bases + 3) / 4;
+	if (h.pac_start + vol_bytes > sb.st_size) ERROR("volume \'%s\' is truncated.", vol_name);
+	
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	// fault in the whole file now, the pac is scanned in full anyway
+	flags |= MAP_POPULATE;
+#endif
+	void* addr = mmap(NULL, sb.st_size, PROT_READ, flags, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) ERROR("failed to mmap file \'%s\'.", vol_name);
+	madvise(addr, sb.st_size, MADV_WILLNEED);
+	
+	volume_t* v = (volume_t*)malloc(sizeof(volume_t));
+	v->num_reads = h.num_reads;
+	v->curr = h.num_bases;
+	v->max_size = h.num_bases;
+	v->start_read_id = h.start_read_id;
+	v->data = (uint8_t*)addr + h.pac_start;
+	v->offset_list = (offset_list_t*)malloc(sizeof(offset_list_t));
+	v->offset_list->curr = h.num_reads;
+	v->offset_list->max_size = h.num_reads;
+	v->offset_list->offset_list = (offset_t*)((uint8_t*)addr + h.offset_list_start);
+	v->map_addr = addr;
+	v->map_size = sb.st_size;
+	return v;
+}
+
 void
 generate_vol_file_name(const char* wrk_dir, int vol, char* vol_file_name)
 {
@@ -200,13 +282,16 @@ generate_idx_file_name(const char* wrk_dir, char* idx_file_name)
 }
 
 void
-extract_one_seq(ifstream& pac_file, PackedDB::SeqIndex& si, u1_t* buffer, char* seq)
+extract_one_seq(ifstream& pac_file, PackedDB::SeqIndex& si, vector<u1_t>& pac, vector<char>& seq_buffer)
 {
 	idx_t offset = si.offset / 4;
 	idx_t bytes = (si.size + 3) / 4;
 	pac_file.seekg(offset, ios::beg);
-	memset(buffer, 0, MAX_SEQ_SIZE);
-	pac_file.read((char*)buffer, bytes);
+	pac.assign(bytes, 0);
+	pac_file.read((char*)pac.data(), bytes);
+	seq_buffer.resize(si.size + 1);
+	const u1_t* buffer = pac.data();
+	char* seq = seq_buffer.data();
 	const char* dt = get_dna_decode_table();
 	idx_t i = 0;
 	for(i = 0; i < si.size; ++i)
@@ -275,10 +360,8 @@ split_dataset(const char* reads, const char* wrk_dir, int* num_vols)
 	ifstream pac_file;
 	PackedDB::generate_pac_name(reads, name);
 	open_fstream(pac_file, name.c_str(), ios::in | ios::binary);
-	u1_t* buffer;
-	char* seq;
-	safe_malloc(buffer, u1_t, MAX_SEQ_SIZE);
-	safe_malloc(seq, char, MAX_SEQ_SIZE);
+	vector<u1_t> buffer;
+	vector<char> seq;
 	volume_t* v = new_volume_t(0, 0);
 	int vol = 0;
 	int rid = 0;
@@ -298,7 +381,7 @@ split_dataset(const char* reads, const char* wrk_dir, int* num_vols)
 			clear_volume_t(v);
 		}
 		extract_one_seq(pac_file, si, buffer, seq);
-		add_one_seq(v, seq, si.size);
+		add_one_seq(v, seq.data(), si.size);
 		++v->curr;
 	}
 	
@@ -313,8 +396,6 @@ split_dataset(const char* reads, const char* wrk_dir, int* num_vols)
 	}
 	
 	fclose(idx_file);
-	safe_free(buffer);
-	safe_free(seq);
 	delete_volume_t(v);
 	*num_vols = vol;
 	close_fstream(pac_file);
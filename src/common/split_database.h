@@ -21,8 +21,26 @@ typedef struct {
 	int start_read_id;
     uint8_t* data;
     offset_list_t* offset_list;
+	// non-NULL if the volume is memory-mapped from its file (see load_volume)
+	void* map_addr;
+	size_t map_size;
 } volume_t;
 
+// on-disk layout of a volume:
+// [header | pad] [offset list | pad] [pac]
+// every section starts at a multiple of VOL_ALIGN so that the offset list
+// and the pac can be used in place after mmap.
+#define VOL_MAGIC 0x4c4f564d // "MVOL"
+#define VOL_VERSION 1
+#define VOL_ALIGN 4096
+
+typedef struct {
+	int magic, version;
+	int num_reads, num_bases;
+	int start_read_id, pad;
+	int64_t offset_list_start, pac_start;
+} volume_header_t;
+
 volume_t*
 new_volume_t(int num_reads, int num_bases);
 
@@ -395,6 +395,15 @@ XdropAligner::go(const char* query, const int query_start, const int query_size,
 			 right_taln,
 			 true);
 	
+	const int aln_capacity_needed = left_qaln.size() + right_qaln.size() + 1;
+	if (aln_capacity_needed > aln_capacity) {
+		aln_capacity = std::max(aln_capacity_needed, 2 * aln_capacity);
+		sfree(qaln);
+		sfree(taln);
+		snew(qaln, char, aln_capacity);
+		snew(taln, char, aln_capacity);
+	}
+	
 	int aln_idx = 0;
 	int i, j, k, n;
 	const char* dt = "ACGT-";
@@ -5,6 +5,7 @@
 #include "gapalign.h"
 //#include "smart_assert.h"
 
+#include <algorithm>
 #include <string>
 
 typedef uint8_t u8;
@@ -53,7 +54,7 @@ struct GapPrelimEditBlock
     EGapAlignOpType last_op;
 
     GapPrelimEditBlock() {
-        num_ops_allocated = MAX_SEQ_SIZE;
+        num_ops_allocated = 4096;
         snew(edit_ops, GapPrelimEditScript, num_ops_allocated);
         num_ops = 0;
         last_op = eGapAlignInvalid;
@@ -74,12 +75,22 @@ struct GapPrelimEditBlock
             edit_ops[num_ops - 1].num += n;
         }
         else {
+            if (num_ops == num_ops_allocated) grow();
             last_op = op_type;
             edit_ops[num_ops].op_type = op_type;
             edit_ops[num_ops].num = n;
             ++num_ops;
         }
     }
+
+    void grow() {
+        GapPrelimEditScript* ops;
+        snew(ops, GapPrelimEditScript, 2 * num_ops_allocated);
+        std::copy(edit_ops, edit_ops + num_ops, ops);
+        sfree(edit_ops);
+        edit_ops = ops;
+        num_ops_allocated *= 2;
+    }
 };
 
 struct XdropAlignParameters
@@ -126,8 +137,9 @@ public:
 			build_score_matrix();
 			snew(qbuf, char, param.block_size * 2);
 			snew(tbuf, char, param.block_size * 2);
-			snew(qaln, char, MAX_SEQ_SIZE);
-			snew(taln, char, MAX_SEQ_SIZE);
+			aln_capacity = 100000;
+			snew(qaln, char, aln_capacity);
+			snew(taln, char, aln_capacity);
 		}
 		
 	virtual ~XdropAligner() {
@@ -202,6 +214,7 @@ public:
 	std::string				right_taln;
 	char*					qaln;
 	char*					taln;
+	int						aln_capacity;
 	int						aln_size;
 	int						qoff;
 	int						qend;
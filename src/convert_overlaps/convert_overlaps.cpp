@@ -0,0 +1,96 @@
+#include "../common/overlap_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+void print_usage(const char* prog)
+{
+	const char sep = ' ';
+	cerr << "USAGE:\n"
+		 << prog << sep
+		 << "can/m4" << sep
+		 << "input" << sep
+		 << "output" << "\n\n"
+		 << "a text input is converted to the binary form, a binary input to the text form.\n";
+}
+
+void
+output_text_m4record(ostream& out, const M4Record& m4, const bool gapped_start)
+{
+	const char sep = '\t';
+	out << m4qid(m4)    << sep
+	    << m4sid(m4)    << sep
+	    << m4ident(m4)  << sep
+	    << m4vscore(m4) << sep
+	    << m4qdir(m4)   << sep
+	    << m4qoff(m4)   << sep
+	    << m4qend(m4)   << sep
+	    << m4qsize(m4)  << sep
+	    << m4sdir(m4)   << sep
+	    << m4soff(m4)   << sep
+	    << m4send(m4)   << sep
+	    << m4ssize(m4);
+	if (gapped_start) out << sep << m4qext(m4) << sep << m4sext(m4);
+	out << "\n";
+}
+
+idx_t
+convert_candidates(const char* input, ofstream& out)
+{
+	OverlapFileReader in(input, OVLP_RECORD_CAN);
+	const bool to_binary = !in.is_binary();
+	if (to_binary) write_overlap_file_header(out, OVLP_RECORD_CAN, 0);
+	ExtensionCandidate ec;
+	idx_t n = 0;
+	while (in.read(ec))
+	{
+		if (to_binary) write_binary_record(out, ec);
+		else out << ec;
+		++n;
+	}
+	return n;
+}
+
+idx_t
+convert_m4records(const char* input, ofstream& out)
+{
+	OverlapFileReader in(input, OVLP_RECORD_M4);
+	const bool to_binary = !in.is_binary();
+	bool gapped_start = in.flags() & OVLP_FLAG_GAPPED_START;
+	M4Record m4;
+	idx_t n = 0;
+	while (in.read(m4))
+	{
+		if (to_binary && n == 0)
+		{
+			// the text form tells whether there are extension start points by its number of columns
+			gapped_start = (m4qext(m4) != INVALID_IDX);
+			write_overlap_file_header(out, OVLP_RECORD_M4, gapped_start ? OVLP_FLAG_GAPPED_START : 0);
+		}
+		if (to_binary) write_binary_record(out, m4, gapped_start);
+		else output_text_m4record(out, m4, gapped_start);
+		++n;
+	}
+	if (to_binary && n == 0) write_overlap_file_header(out, OVLP_RECORD_M4, 0);
+	return n;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 4 || (strcmp(argv[1], "can") && strcmp(argv[1], "m4"))) {
+		print_usage(argv[0]);
+		exit(1);
+	}
+	const bool is_can = (strcmp(argv[1], "can") == 0);
+	const char* input = argv[2];
+	const char* output = argv[3];
+	
+	ofstream out;
+	open_fstream(out, output, ios::out | ios::binary);
+	idx_t n = is_can ? convert_candidates(input, out) : convert_m4records(input, out);
+	close_fstream(out);
+	LOG(stderr, "%lld records are converted.", (long long)n);
+}
@@ -0,0 +1,17 @@
+ifeq "$(strip ${BUILD_DIR})" ""
+  BUILD_DIR    := ../$(OSTYPE)-$(MACHINETYPE)/obj
+endif
+ifeq "$(strip ${TARGET_DIR})" ""
+  TARGET_DIR   := ../$(OSTYPE)-$(MACHINETYPE)/bin
+endif
+
+TARGET   := convert_overlaps
+SOURCES  := convert_overlaps.cpp 
+
+SRC_INCDIRS  := ../common .
+
+TGT_LDFLAGS := -L${TARGET_DIR}
+TGT_LDLIBS  := -lmecat -lz
+TGT_PREREQS := libmecat.a
+
+SUBMAKEFILES :=
@@ -11,9 +11,13 @@ SOURCES      := common/alignment.cpp \
 		common/buffer_line_iterator.cpp \
 		common/defs.cpp \
 		common/diff_gapalign.cpp \
+		common/diff_simd.cpp \
+		common/diff_trace.cpp \
 		common/fasta_reader.cpp \
 		common/gapalign.cpp \
+		common/kmer_extractor.cpp \
 		common/lookup_table.cpp \
+		common/overlap_file.cpp \
 		common/packed_db.cpp \
 		common/sequence.cpp \
 		common/split_database.cpp \
@@ -24,4 +28,5 @@ SRC_INCDIRS  := common \
 SUBMAKEFILES := mecat2pw/pw.mk \
 		mecat2ref/mecat2ref.mk \
 		mecat2cns/mecat2cns.mk \
-		filter_reads/filter_reads.mk
+		filter_reads/filter_reads.mk \
+		convert_overlaps/convert_overlaps.mk
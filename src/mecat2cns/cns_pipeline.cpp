@@ -0,0 +1,241 @@
+#include "cns_pipeline.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <pthread.h>
+
+#include "cns_writer.h"
+#include "overlaps_store.h"
+
+using namespace std;
+
+struct CmpExtensionCandidateBySid
+{
+	bool operator()(const ExtensionCandidate& a, const ExtensionCandidate& b)
+	{
+		return a.sid < b.sid;
+	}
+};
+
+struct QueryLongerThan
+{
+	QueryLongerThan(const index_t max_size) : max_size(max_size) {}
+	bool operator()(const ExtensionCandidate& ec) const
+	{
+		return ec.qsize > max_size;
+	}
+	const index_t max_size;
+};
+
+// the consensus threads take the reads of a partition kCnsChunkReads at a time
+#define kCnsChunkReads 16
+
+struct CnsPartition
+{
+	std::string process_info;
+	DynamicTimer* timer;
+	ExtensionCandidate* candidates;
+	idx_t num_candidates;
+	// the candidates of chunk i are [chunk_starts[i], chunk_starts[i + 1])
+	std::vector<idx_t> chunk_starts;
+	// sequence number of the first chunk, counted over all partitions
+	idx_t first_chunk;
+	idx_t next_chunk;
+	int num_finished_threads;
+};
+
+struct CnsPipeline
+{
+	ReadsCorrectionOptions* prco;
+	PackedDB* reads;
+	std::vector<PartitionFileInfo>* partitions;
+	consensus_one_read_func cns_func;
+	CnsOutputWriter* writer;
+
+	pthread_mutex_t lock;
+
+	// loaded[i] is partition i when it is in memory, NULL otherwise
+	std::vector<CnsPartition*> loaded;
+	int num_loaded;
+	pthread_cond_t partition_loaded;
+	pthread_cond_t partition_released;
+};
+
+struct CnsWorkerData
+{
+	CnsPipeline* pipeline;
+	ConsensusThreadData* ctd;
+};
+
+static CnsPartition*
+load_cns_partition(const PartitionFileInfo& pfi, const idx_t first_chunk)
+{
+	CnsPartition* part = new CnsPartition;
+	part->process_info = "processing " + pfi.file_name;
+	part->timer = new DynamicTimer(part->process_info.c_str());
+	part->candidates = load_partition_data<ExtensionCandidate>(pfi.file_name.c_str(), part->num_candidates);
+	part->first_chunk = first_chunk;
+	part->next_chunk = 0;
+	part->num_finished_threads = 0;
+
+	ExtensionCandidate* ec_list = part->candidates;
+	const idx_t nec = part->num_candidates;
+	std::sort(ec_list, ec_list + nec, CmpExtensionCandidateBySid());
+
+	idx_t i = 0;
+	int num_reads = 0;
+	while (i < nec)
+	{
+		if (num_reads % kCnsChunkReads == 0) part->chunk_starts.push_back(i);
+		const index_t sid = ec_list[i].sid;
+		while (i < nec && ec_list[i].sid == sid) ++i;
+		++num_reads;
+	}
+	part->chunk_starts.push_back(nec);
+	return part;
+}
+
+static void
+release_cns_partition(CnsPartition* part)
+{
+	delete[] part->candidates;
+	delete part->timer;
+	delete part;
+}
+
+static void*
+cns_loader_func(void* arg)
+{
+	CnsPipeline& pl = *static_cast<CnsPipeline*>(arg);
+	const int window = pl.prco->num_partitions_in_memory;
+	idx_t num_chunks = 0;
+	for (size_t i = 0; i < pl.partitions->size(); ++i)
+	{
+		pthread_mutex_lock(&pl.lock);
+		while (pl.num_loaded >= window) pthread_cond_wait(&pl.partition_released, &pl.lock);
+		pthread_mutex_unlock(&pl.lock);
+
+		CnsPartition* part = load_cns_partition((*pl.partitions)[i], num_chunks);
+		num_chunks += part->chunk_starts.size() - 1;
+
+		pthread_mutex_lock(&pl.lock);
+		pl.loaded[i] = part;
+		++pl.num_loaded;
+		pthread_cond_broadcast(&pl.partition_loaded);
+		pthread_mutex_unlock(&pl.lock);
+	}
+	return NULL;
+}
+
+static void
+queue_cns_results(CnsPipeline& pl, const idx_t chunk, std::vector<CnsResult>& cns_results)
+{
+	std::string* buf = new std::string;
+	format_cns_results(cns_results, *buf);
+	cns_results.clear();
+	pl.writer->push(chunk, buf);
+}
+
+static void*
+cns_worker_func(void* arg)
+{
+	CnsWorkerData& wd = *static_cast<CnsWorkerData*>(arg);
+	CnsPipeline& pl = *wd.pipeline;
+	ConsensusThreadData* ctd = wd.ctd;
+	const bool ordered = pl.prco->ordered_output;
+	for (size_t p = 0; p < pl.partitions->size(); ++p)
+	{
+		pthread_mutex_lock(&pl.lock);
+		while (!pl.loaded[p]) pthread_cond_wait(&pl.partition_loaded, &pl.lock);
+		CnsPartition* part = pl.loaded[p];
+		pthread_mutex_unlock(&pl.lock);
+
+		ExtensionCandidate* candidates = part->candidates;
+		ctd->candidates = candidates;
+		ctd->num_candidates = part->num_candidates;
+		const idx_t num_chunks = part->chunk_starts.size() - 1;
+		idx_t chunk;
+		while ((chunk = __sync_fetch_and_add(&part->next_chunk, 1)) < num_chunks)
+		{
+			const index_t to = part->chunk_starts[chunk + 1];
+			index_t i = part->chunk_starts[chunk], j;
+			while (i < to)
+			{
+				const index_t sid = candidates[i].sid;
+				j = i + 1;
+				while (j < to && candidates[j].sid == sid) ++j;
+				if (j - i < ctd->rco.min_cov) { i = j; continue; }
+				if (candidates[i].ssize < ctd->rco.min_size * 0.95) { i = j; continue; }
+				if (candidates[i].ssize > ctd->rco.max_read_size) { ++ctd->num_skipped_reads; i = j; continue; }
+				// reads longer than max_read_size are not used to correct the template either
+				const index_t e = std::remove_if(candidates + i, candidates + j, QueryLongerThan(ctd->rco.max_read_size)) - candidates;
+				if (e - i < ctd->rco.min_cov) { i = j; continue; }
+				ctd->reserve(candidates[i].ssize);
+				pl.cns_func(ctd, sid, i, e);
+				i = j;
+			}
+			// in ordered mode every chunk is handed over, even an empty one, so that the writer knows it is done
+			if (ordered || ctd->cns_results.size() >= MAX_CNS_RESULTS)
+				queue_cns_results(pl, part->first_chunk + chunk, ctd->cns_results);
+		}
+		if (!ctd->cns_results.empty()) queue_cns_results(pl, -1, ctd->cns_results);
+
+		pthread_mutex_lock(&pl.lock);
+		if (++part->num_finished_threads == pl.prco->num_threads)
+		{
+			pl.loaded[p] = NULL;
+			--pl.num_loaded;
+			release_cns_partition(part);
+			pthread_cond_signal(&pl.partition_released);
+		}
+		pthread_mutex_unlock(&pl.lock);
+	}
+	return NULL;
+}
+
+void
+consensus_partitions(ReadsCorrectionOptions& rco,
+					 PackedDB& reads,
+					 std::vector<PartitionFileInfo>& partitions,
+					 consensus_one_read_func cns_func,
+					 const char* output)
+{
+	const int num_threads = rco.num_threads;
+	CnsOutputWriter writer(output, rco.ordered_output, 4 * num_threads);
+	CnsPipeline pl;
+	pl.prco = &rco;
+	pl.reads = &reads;
+	pl.partitions = &partitions;
+	pl.cns_func = cns_func;
+	pl.writer = &writer;
+	pl.loaded.assign(partitions.size(), NULL);
+	pl.num_loaded = 0;
+	pthread_mutex_init(&pl.lock, NULL);
+	pthread_cond_init(&pl.partition_loaded, NULL);
+	pthread_cond_init(&pl.partition_released, NULL);
+
+	pthread_t loader;
+	pthread_create(&loader, NULL, cns_loader_func, static_cast<void*>(&pl));
+
+	CnsWorkerData wds[num_threads];
+	pthread_t thread_ids[num_threads];
+	for (int i = 0; i < num_threads; ++i)
+	{
+		wds[i].pipeline = &pl;
+		wds[i].ctd = new ConsensusThreadData(&rco, i, &reads);
+		pthread_create(&thread_ids[i], NULL, cns_worker_func, static_cast<void*>(&wds[i]));
+	}
+	for (int i = 0; i < num_threads; ++i) pthread_join(thread_ids[i], NULL);
+	pthread_join(loader, NULL);
+	writer.finish();
+
+	idx_t num_skipped_reads = 0;
+	for (int i = 0; i < num_threads; ++i) num_skipped_reads += wds[i].ctd->num_skipped_reads;
+	if (num_skipped_reads)
+		LOG(stderr, "%lld reads longer than %lld are not corrected, nor used to correct other reads", (long long)num_skipped_reads, (long long)rco.max_read_size);
+	for (int i = 0; i < num_threads; ++i) delete wds[i].ctd;
+	pthread_mutex_destroy(&pl.lock);
+	pthread_cond_destroy(&pl.partition_loaded);
+	pthread_cond_destroy(&pl.partition_released);
+}
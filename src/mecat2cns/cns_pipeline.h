@@ -0,0 +1,22 @@
+#ifndef _CNS_PIPELINE_H
+#define _CNS_PIPELINE_H
+
+#include <vector>
+
+#include "overlaps_partition.h"
+#include "reads_correction_aux.h"
+
+typedef void (*consensus_one_read_func)(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid);
+
+// corrects the reads of all the partition files.
+// a loader thread reads and sorts the partitions ahead of the consensus threads and a writer
+// thread outputs the corrected reads to output, so that loading, consensus and output overlap.
+// at most rco.num_partitions_in_memory partitions are held in memory at the same time.
+void
+consensus_partitions(ReadsCorrectionOptions& rco,
+					 PackedDB& reads,
+					 std::vector<PartitionFileInfo>& partitions,
+					 consensus_one_read_func cns_func,
+					 const char* output);
+
+#endif // _CNS_PIPELINE_H
@@ -0,0 +1,204 @@
+#include "cns_writer.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+void
+format_cns_results(const std::vector<CnsResult>& cns_results, std::string& out)
+{
+	char header[128];
+	for (std::vector<CnsResult>::const_iterator iter = cns_results.begin(); iter != cns_results.end(); ++iter)
+	{
+		int n = snprintf(header, sizeof(header), ">%lld_%lld_%lld_%lld\n",
+						 (long long)iter->id, (long long)iter->range[0], (long long)iter->range[1], (long long)iter->seq.size());
+		out.append(header, n);
+		out += iter->seq;
+		out += '\n';
+	}
+}
+
+static bool
+is_gz_file_name(const char* path)
+{
+	const size_t n = strlen(path);
+	return n > 3 && strcmp(path + n - 3, ".gz") == 0;
+}
+
+CnsOutputWriter::CnsOutputWriter(const char* p, const bool o, const int max_queued_buffers)
+	: path(p), ordered(o), head(NULL), done(false), fd(-1), gz(NULL), next_seq(0),
+	  window(max_queued_buffers > 0 ? max_queued_buffers : 1)
+{
+	if (is_gz_file_name(path))
+	{
+		gz = gzopen(path, "wb");
+		if (!gz) ERROR("failed to open file '%s'", path);
+		gzbuffer(gz, 1 << 20);
+	}
+	else
+	{
+		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd == -1) ERROR("failed to open file '%s': %s", path, strerror(errno));
+	}
+	out_buf.reserve(kBufferSize);
+	sem_init(&queued_buffers, 0, 0);
+	sem_init(&free_slots, 0, window);
+	pthread_mutex_init(&window_lock, NULL);
+	pthread_cond_init(&window_moved, NULL);
+	pthread_create(&writer, NULL, writer_func, static_cast<void*>(this));
+}
+
+CnsOutputWriter::~CnsOutputWriter()
+{
+	sem_destroy(&queued_buffers);
+	sem_destroy(&free_slots);
+	pthread_mutex_destroy(&window_lock);
+	pthread_cond_destroy(&window_moved);
+}
+
+void
+CnsOutputWriter::push(const idx_t seq, std::string* buf)
+{
+	if (ordered)
+	{
+		pthread_mutex_lock(&window_lock);
+		while (seq >= next_seq + window) pthread_cond_wait(&window_moved, &window_lock);
+		pthread_mutex_unlock(&window_lock);
+	}
+	sem_wait(&free_slots);
+	Node* node = new Node;
+	node->seq = seq;
+	node->buf = buf;
+	node->next = __atomic_load_n(&head, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&head, &node->next, node, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	sem_post(&queued_buffers);
+}
+
+void
+CnsOutputWriter::finish()
+{
+	__atomic_store_n(&done, true, __ATOMIC_RELEASE);
+	sem_post(&queued_buffers);
+	pthread_join(writer, NULL);
+	r_assert(pending.empty());
+	flush();
+	if (gz)
+	{
+		if (gzclose(gz) != Z_OK) ERROR("failed to close file '%s'", path);
+		gz = NULL;
+	}
+	else
+	{
+		if (close(fd)) ERROR("failed to close file '%s': %s", path, strerror(errno));
+		fd = -1;
+	}
+}
+
+void
+CnsOutputWriter::flush()
+{
+	const char* p = out_buf.data();
+	size_t left = out_buf.size();
+	if (gz)
+	{
+		if (left && gzwrite(gz, p, left) != (int)left) ERROR("failed to write to '%s'", path);
+	}
+	else
+	{
+		while (left)
+		{
+			ssize_t n = write(fd, p, left);
+			if (n == -1)
+			{
+				if (errno == EINTR) continue;
+				ERROR("failed to write to '%s': %s", path, strerror(errno));
+			}
+			p += n;
+			left -= n;
+		}
+	}
+	out_buf.clear();
+}
+
+void
+CnsOutputWriter::write_buffer(std::string* buf)
+{
+	if (out_buf.size() + buf->size() > kBufferSize) flush();
+	if (buf->size() >= kBufferSize)
+	{
+		out_buf.swap(*buf);
+		flush();
+		out_buf.swap(*buf);
+	}
+	else
+	{
+		out_buf += *buf;
+	}
+	delete buf;
+}
+
+void*
+CnsOutputWriter::writer_func(void* arg)
+{
+	CnsOutputWriter& w = *static_cast<CnsOutputWriter*>(arg);
+	while (1)
+	{
+		sem_wait(&w.queued_buffers);
+		Node* list = __atomic_exchange_n(&w.head, (Node*)NULL, __ATOMIC_ACQUIRE);
+		if (!list)
+		{
+			if (__atomic_load_n(&w.done, __ATOMIC_ACQUIRE)) break;
+			continue;
+		}
+
+		// the queue is a stack, restore the push order
+		Node* fifo = NULL;
+		while (list)
+		{
+			Node* next = list->next;
+			list->next = fifo;
+			fifo = list;
+			list = next;
+		}
+
+		while (fifo)
+		{
+			Node* node = fifo;
+			fifo = fifo->next;
+			if (!w.ordered)
+			{
+				w.write_buffer(node->buf);
+			}
+			else
+			{
+				w.pending[node->seq] = node->buf;
+				std::map<idx_t, std::string*>::iterator iter;
+				idx_t seq = w.next_seq;
+				while ((iter = w.pending.begin()) != w.pending.end() && iter->first == seq)
+				{
+					w.write_buffer(iter->second);
+					w.pending.erase(iter);
+					++seq;
+				}
+				if (seq != w.next_seq)
+				{
+					pthread_mutex_lock(&w.window_lock);
+					w.next_seq = seq;
+					pthread_cond_broadcast(&w.window_moved);
+					pthread_mutex_unlock(&w.window_lock);
+				}
+			}
+			delete node;
+			sem_post(&w.free_slots);
+		}
+
+		// done is only set once every buffer is pushed
+		if (__atomic_load_n(&w.done, __ATOMIC_ACQUIRE) && !__atomic_load_n(&w.head, __ATOMIC_ACQUIRE)) break;
+	}
+	return NULL;
+}
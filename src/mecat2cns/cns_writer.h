@@ -0,0 +1,71 @@
+#ifndef _CNS_WRITER_H
+#define _CNS_WRITER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <zlib.h>
+
+#include "../common/alignment.h"
+
+// appends the corrected reads to out as fasta records
+void
+format_cns_results(const std::vector<CnsResult>& cns_results, std::string& out);
+
+// writes the corrected reads prepared by the consensus threads.
+// the threads push preformatted buffers to a lock-free queue and a single writer thread
+// outputs them with large writes. the output is gzip compressed if its name ends with ".gz".
+// in ordered mode the buffers are written in the order of their sequence numbers,
+// which must then be 0, 1, 2, ... without gaps.
+class CnsOutputWriter
+{
+public:
+	CnsOutputWriter(const char* path, const bool ordered, const int max_queued_buffers);
+	~CnsOutputWriter();
+
+	// hands buf over to the writer, which deletes it once it is written.
+	// blocks while max_queued_buffers buffers are waiting. in ordered mode it also blocks
+	// while seq is max_queued_buffers or more ahead of the next buffer to be written, so that
+	// the out-of-order buffers held back stay within the same bound. this cannot deadlock as 
+	// long as the sequence numbers are handed out in increasing order, as the buffer that is 
+	// written next never waits.
+	void push(const idx_t seq, std::string* buf);
+
+	// writes what is left and closes the output. no buffers may be pushed after that.
+	void finish();
+
+private:
+	struct Node
+	{
+		Node* next;
+		idx_t seq;
+		std::string* buf;
+	};
+
+	static void* writer_func(void* arg);
+	void write_buffer(std::string* buf);
+	void flush();
+
+private:
+	static const size_t kBufferSize = 8 * 1024 * 1024;
+	const char* path;
+	bool ordered;
+	Node* head;
+	bool done;
+	sem_t queued_buffers;
+	sem_t free_slots;
+	pthread_t writer;
+	int fd;
+	gzFile gz;
+	std::string out_buf;
+	std::map<idx_t, std::string*> pending;
+	idx_t next_seq;
+	idx_t window;
+	pthread_mutex_t window_lock;
+	pthread_cond_t window_moved;
+};
+
+#endif // _CNS_WRITER_H
@@ -12,10 +12,7 @@ get_sw_parameters_small()
     swp.row_size = 4096;
     swp.column_size = 4096;
     swp.segment_aln_size = 4096;
-    swp.max_seq_size = 100000;
     swp.max_aln_size = 100000;
-    swp.d_path_size = 5000000;
-    swp.aln_path_size = 5000000;
 
     return swp;
 }
@@ -28,37 +25,30 @@ get_sw_parameters_large()
     swp.row_size = 4096;
     swp.column_size = 4096;
     swp.segment_aln_size = 4096;
-    swp.max_seq_size = 100000;
     swp.max_aln_size = 100000;
-    swp.d_path_size = 5000000;
-    swp.aln_path_size = 5000000;
 
     return swp;
 }
 
-DiffRunningData::DiffRunningData(const SW_Parameters& swp_in)
+DiffRunningData::DiffRunningData(const SW_Parameters& swp_in, const int ext_kernel)
 {
 	swp = swp_in;
-	safe_malloc(query, char, swp.max_seq_size);
-	safe_malloc(target, char, swp.max_seq_size);
 	safe_malloc(DynQ, int, swp.row_size);
 	safe_malloc(DynT, int, swp.column_size);
 	align = new Alignment(swp.segment_aln_size);
 	result = new OutputStore(swp.max_aln_size);
-	safe_malloc(d_path, DPathData2, swp.d_path_size);
-	safe_malloc(aln_path, PathPoint, swp.aln_path_size);
+	trace = new DiffTrace;
+	sd = (ext_kernel == EXT_KERNEL_SIMD) ? new DiffSimdData : NULL;
 }
 
 DiffRunningData::~DiffRunningData()
 {
-	safe_free(query);
-	safe_free(target);
 	safe_free(DynQ);
 	safe_free(DynT);
 	delete align;
 	delete result;
-	safe_free(d_path);
-	safe_free(aln_path);
+	delete trace;
+	if (sd) delete sd;
 }
 
 void fill_m4record_from_output_store(const OutputStore& result, 
@@ -121,44 +111,19 @@ void print_candidate(const CandidateStartPosition& csp)
 			  << "\n";
 }
 
-int CompareDPathData2(const void* a, const void* b)
-{
-    const DPathData2* d1 = (const DPathData2*)a;
-    const DPathData2* d2 = (const DPathData2*)b;
-    return (d1->d == d2->d) ? (d1->k - d2->k) : (d1->d - d2->d);
-}
-
-struct SCompareDPathData2
-{
-    bool operator()(const DPathData2& a, const DPathData2& b)
-    { return (a.d == b.d) ? (a.k < b.k) : (a.d < b.d); }
-};
-
-DPathData2* GetDPathIdx(const int d, const int k, const unsigned int max_idx, DPathData2* base)
-{
-    DPathData2 target;
-    target.d = d;
-    target.k = k;
-    DPathData2* ret = (DPathData2*)bsearch(&target, base, max_idx, sizeof(DPathData2), CompareDPathData2);
-    return ret;
-}
-
 int Align(const char* query, const int q_len, const char* target, const int t_len, 
           const int band_tolerance, const int get_aln_str, Alignment* align, 
-		  int* V, int* U, DPathData2* d_path, PathPoint* aln_path, 
+		  int* V, int* U, DiffTrace* trace, 
 		  const int right_extend, double error_rate)
 {
     int k_offset;
     int  d;
     int  k, k2;
     int best_m;
-    int min_k, new_min_k, max_k, new_max_k, pre_k;
+    int min_k, new_min_k, max_k, new_max_k;
     int x, y;
-    int ck, cd, cx, cy, nx, ny; 
     int max_d, band_size;
-    unsigned long d_path_idx = 0, max_idx = 0;
-    int aln_path_idx, aln_pos, i, aligned = 0;
-    DPathData2* d_path_aux;
+    int aligned = 0;
     
     max_d = (int)(2.0 * error_rate * (q_len + t_len));
     k_offset = max_d;
@@ -167,40 +132,33 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
     best_m = -1;
     min_k = 0;
     max_k = 0;
-    d_path_idx = 0;
-    max_idx = 0;
+    trace->clear();
     
     for (d = 0; d < max_d; ++d)
     {
         if (max_k - min_k > band_size) break;
 
+        trace->start_d(min_k, max_k);
         for (k = min_k; k <= max_k; k += 2)
         {
             if( k == min_k || (k != max_k && V[k - 1 + k_offset] < V[k + 1 + k_offset]) )
-            { pre_k = k + 1; x = V[k + 1 + k_offset]; }
+            { x = V[k + 1 + k_offset]; }
             else 
-            { pre_k = k - 1; x = V[k - 1 + k_offset] + 1; }
+            { x = V[k - 1 + k_offset] + 1; }
             y = x - k;
-            d_path[d_path_idx].d = d;
-            d_path[d_path_idx].k = k;
-            d_path[d_path_idx].x1 = x;
-            d_path[d_path_idx].y1 = y;
 			
 			if (right_extend)
 				while( x < q_len && y < t_len && query[x] == target[y]) { ++x; ++y; }
 			else
 				while( x < q_len && y < t_len && query[-x] == target[-y]) { ++x; ++y; }
 
-            d_path[d_path_idx].x2 = x;
-            d_path[d_path_idx].y2 = y;
-            d_path[d_path_idx].pre_k = pre_k;
-            ++d_path_idx;
+            trace->add(x);
 
             V[k + k_offset] = x;
             U[k + k_offset] = x + y;
             best_m = std::max(best_m, x + y);
             if (x >= q_len || y >= t_len)
-            { aligned = 1; max_idx = d_path_idx; break; }
+            { aligned = 1; break; }
         }
 
         // for banding
@@ -222,81 +180,7 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
             align->aln_t_s = 0;
 
             if (get_aln_str)
-            {
-                cd = d;
-                ck = k;
-                aln_path_idx = 0;
-                while (cd >= 0 && aln_path_idx < q_len + t_len + 1)
-                {
-                    d_path_aux = GetDPathIdx(cd, ck, max_idx, d_path);
-                    aln_path[aln_path_idx].x = d_path_aux->x2;
-                    aln_path[aln_path_idx].y = d_path_aux->y2;
-                    ++aln_path_idx;
-                    aln_path[aln_path_idx].x = d_path_aux->x1;
-                    aln_path[aln_path_idx].y = d_path_aux->y1;
-                    ++aln_path_idx;
-                    ck = d_path_aux->pre_k;
-                    cd -= 1;
-                }
-                --aln_path_idx;
-                cx = aln_path[aln_path_idx].x;
-                cy = aln_path[aln_path_idx].y;
-                align->aln_q_s = cx;
-                align->aln_t_s = cy;
-                aln_pos = 0;
-                while (aln_path_idx > 0)
-                {
-                    --aln_path_idx;
-                    nx = aln_path[aln_path_idx].x;
-                    ny = aln_path[aln_path_idx].y;
-                    if (cx == nx && cy == ny) continue;
-                    if (cx == nx && cy != ny)
-                    {
-						if (right_extend)
-						{
-							for (i = 0; i < ny - cy; ++i) align->q_aln_str[aln_pos + i] = GAP_ALN;
-							for (i = 0; i < ny - cy; ++i) align->t_aln_str[aln_pos + i] = target[cy + i];
-						}
-						else
-						{
-							for (i = 0; i < ny - cy; ++i) align->q_aln_str[aln_pos + i] = GAP_ALN;
-							for (i = 0; i < ny - cy; ++i) align->t_aln_str[aln_pos + i] = target[-(cy + i)];
-						}
-                        aln_pos += ny - cy;
-                    }
-                    else if (cx != nx && cy == ny)
-                    {
-						if (right_extend)
-						{
-							for (i = 0; i < nx - cx; ++i) align->q_aln_str[aln_pos + i] = query[cx + i];
-							for (i = 0; i < nx - cx; ++i) align->t_aln_str[aln_pos + i] = GAP_ALN;
-						}
-						else
-						{
-							for (i = 0; i < nx - cx; ++i) align->q_aln_str[aln_pos + i] = query[-(cx + i)];
-							for (i = 0; i < nx - cx; ++i) align->t_aln_str[aln_pos + i] = GAP_ALN;
-						}
-                        aln_pos += nx - cx;
-                    }
-                    else
-                    {
-						if (right_extend)
-						{
-							for (i = 0; i < nx - cx; ++i) align->q_aln_str[aln_pos + i] = query[cx + i];
-							for (i = 0; i < ny - cy; ++i) align->t_aln_str[aln_pos + i] = target[cy + i];
-						}
-						else
-						{
-							for (i = 0; i < nx - cx; ++i) align->q_aln_str[aln_pos + i] = query[-(cx + i)];
-							for (i = 0; i < ny - cy; ++i) align->t_aln_str[aln_pos + i] = target[-(cy + i)];
-						}
-                        aln_pos += ny - cy;
-                    }
-                    cx = nx;
-                    cy = ny;
-                }
-                align->aln_str_size = aln_pos;
-            }
+                align->aln_str_size = trace->traceback(query, target, d, k, right_extend, GAP_ALN, align->q_aln_str, align->t_aln_str);
             break;
         }
     }
@@ -304,98 +188,177 @@ int Align(const char* query, const int q_len, const char* target, const int t_le
     else return 0;
 }
 
+// the block by block extension of dw_in_one_direction
+struct BlockExtension
+{
+	const char* query;
+	const char* target;
+	int query_size;
+	int target_size;
+	int right_extend;
+	int extend1, extend2;
+	int extend_size;
+	int flag_end;
+
+	BlockExtension(const char* q, const int qsize, const char* t, const int tsize, const int r)
+		: query(q), target(t), query_size(qsize), target_size(tsize), right_extend(r),
+		  extend1(0), extend2(0), extend_size(std::min(qsize, tsize)), flag_end(1) {}
+
+	// sets up the next block, false once the last block is done
+	bool next_block(const int ALN_SIZE, const char*& seq1, const char*& seq2, int& seg_size)
+	{
+		if (!flag_end) return false;
+		if (extend_size > (ALN_SIZE + 100))
+		{ seg_size = ALN_SIZE; }
+		else
+		{ seg_size = extend_size; flag_end = 0; }
+		if (right_extend) { seq1 = query + extend1; seq2 = target + extend2; }
+		else { seq1 = query - extend1; seq2 = target - extend2; }
+		return true;
+	}
+
+	// appends the alignment of the block to result, false if the extension stops here
+	bool add_block(const int ALN_SIZE, int align_flag, Alignment* align, OutputStore* result)
+	{
+		int i, j, k, num_matches;
+		if (align_flag)
+		{
+			for (k = align->aln_str_size - 1, i = 0, j = 0, num_matches = 0; k > -1 && num_matches < 4; --k)
+			{
+				if (align->q_aln_str[k] != GAP_ALN) ++i;
+				if (align->t_aln_str[k] != GAP_ALN) ++j;
+				if (align->q_aln_str[k] == align->t_aln_str[k]) ++num_matches;
+				else num_matches = 0;
+			}
+			if (flag_end)
+			{
+				i = ALN_SIZE - align->aln_q_e + i;
+				j = ALN_SIZE - align->aln_t_e + j;
+				if (i == ALN_SIZE) align_flag = 0;
+				extend1 = extend1 + ALN_SIZE - i; extend2 = extend2 + ALN_SIZE - j;
+			}
+			else
+			{
+				i = extend_size - align->aln_q_e;
+				j = extend_size - align->aln_t_e;
+				if (i == extend_size) align_flag = 0;
+				extend1 += (extend_size - i); extend2 += (extend_size - j);
+				k = align->aln_str_size - 1;
+			}
+			if (align_flag)
+			{
+				if (right_extend)
+				{
+					memcpy(result->right_store1 + result->right_store_size, align->q_aln_str, k + 1);
+					memcpy(result->right_store2 + result->right_store_size, align->t_aln_str, k + 1);
+					result->right_store_size += (k + 1);
+				}
+				else
+				{
+					memcpy(result->left_store1 + result->left_store_size, align->q_aln_str, k + 1);
+					memcpy(result->left_store2 + result->left_store_size, align->t_aln_str, k + 1);
+					result->left_store_size += (k + 1);
+				}
+				extend_size = std::min(query_size - extend1, target_size - extend2);
+			}
+		}
+		return align_flag;
+	}
+};
+
+// the band and distance bound of Align for a block of seg_size bases
+static inline int
+block_band_tolerance(const int seg_size)
+{
+	return 0.3 * seg_size;
+}
+
+static inline int
+block_max_d(const int seg_size, const double error_rate)
+{
+	return (int)(2.0 * error_rate * (seg_size + seg_size));
+}
+
+// turns the result of the vectorized kernel into the alignment Align gives,
+// which only keeps the alignments reaching an end
+static int
+get_block_alignment(const char* seq1, const char* seq2, const int seg_size, const int right_extend,
+					const bool aligned, const DiffPoint& end, DiffTrace* trace, Alignment* align)
+{
+	align->init();
+	if (aligned)
+	{
+		align->aln_q_e = end.x;
+		align->aln_t_e = end.y;
+		align->dist = end.d;
+		align->aln_str_size = trace->traceback(seq1, seq2, end.d, end.k, right_extend, GAP_ALN, align->q_aln_str, align->t_aln_str);
+	}
+	return align->aln_q_e == seg_size || align->aln_t_e == seg_size;
+}
+
 void dw_in_one_direction(const char* query, const int query_size, const char* target, const int target_size,
-						 int* U, int* V, Alignment* align, DPathData2* d_path, PathPoint* aln_path, 
-						 SW_Parameters* swp, OutputStore* result, const int right_extend, double error_rate)
+						 int* U, int* V, Alignment* align, DiffTrace* trace, 
+						 SW_Parameters* swp, OutputStore* result, const int right_extend, double error_rate,
+						 DiffSimdData* sd)
 {
 	const idx_t ALN_SIZE = swp->segment_size;
 	const idx_t U_SIZE = swp->row_size;
 	const idx_t V_SIZE = swp->column_size;
-    int extend1 = 0, extend2 = 0;
-    const char* seq1 = query;
-    const char* seq2 = target;
-    int extend_size = std::min(query_size, target_size);
-    int seg_size;
-    int flag_end = 1;
-    int align_flag;
-    int i, j, k, num_matches;
-    while (flag_end)
-    {
-        if (extend_size > (ALN_SIZE + 100))
-        { seg_size = ALN_SIZE; }
-        else
-        { seg_size = extend_size; flag_end = 0; }
-        memset(U, 0, sizeof(int) * U_SIZE);
-        memset(V, 0, sizeof(int) * V_SIZE);
-        if (right_extend) { seq1 = query + extend1; seq2 = target + extend2; }
-        else { seq1 = query - extend1; seq2 = target - extend2; }
-        align_flag = Align(seq1, seg_size, seq2, seg_size, 0.3 * seg_size, 400, align, U, V, d_path, aln_path, right_extend, error_rate);
-        if (align_flag)
-        {
-            for (k = align->aln_str_size - 1, i = 0, j = 0, num_matches = 0; k > -1 && num_matches < 4; --k)
-            {
-                if (align->q_aln_str[k] != GAP_ALN) ++i;
-                if (align->t_aln_str[k] != GAP_ALN) ++j;
-                if (align->q_aln_str[k] == align->t_aln_str[k]) ++num_matches;
-                else num_matches = 0;
-            }
-            if (flag_end)
-            {
-                i = ALN_SIZE - align->aln_q_e + i;
-                j = ALN_SIZE - align->aln_t_e + j;
-                if (i == ALN_SIZE) align_flag = 0;
-				extend1 = extend1 + ALN_SIZE - i; extend2 = extend2 + ALN_SIZE - j;
-            }
-            else
-            {
-                i = extend_size - align->aln_q_e;
-                j = extend_size - align->aln_t_e;
-                if (i == extend_size) align_flag = 0;
-				extend1 += (extend_size - i); extend2 += (extend_size - j);
-                k = align->aln_str_size - 1;
-            }
-            if (align_flag)
-            {
-                if (right_extend)
-                {
-                    memcpy(result->right_store1 + result->right_store_size, align->q_aln_str, k + 1);
-                    memcpy(result->right_store2 + result->right_store_size, align->t_aln_str, k + 1);
-                    result->right_store_size += (k + 1);
-                }
-                else
-                {
-                    memcpy(result->left_store1 + result->left_store_size, align->q_aln_str, k + 1);
-                    memcpy(result->left_store2 + result->left_store_size, align->t_aln_str, k + 1);
-                    result->left_store_size += (k + 1);
-                }
-                extend_size = std::min(query_size - extend1, target_size - extend2);
-            }
-        }
-        if (!align_flag) break;
-    }
+	BlockExtension ext(query, query_size, target, target_size, right_extend);
+	const char* seq1;
+	const char* seq2;
+	int seg_size;
+	int align_flag;
+	while (ext.next_block(ALN_SIZE, seq1, seq2, seg_size))
+	{
+		if (sd)
+		{
+			DiffPoint end;
+			bool aligned = diff_simd_align(seq1, seg_size, seq2, seg_size, block_band_tolerance(seg_size), block_max_d(seg_size, error_rate),
+										   right_extend, sd, trace, end);
+			align_flag = get_block_alignment(seq1, seq2, seg_size, right_extend, aligned, end, trace, align);
+		}
+		else
+		{
+			memset(U, 0, sizeof(int) * U_SIZE);
+			memset(V, 0, sizeof(int) * V_SIZE);
+			align_flag = Align(seq1, seg_size, seq2, seg_size, 0.3 * seg_size, 400, align, U, V, trace, right_extend, error_rate);
+		}
+		if (!ext.add_block(ALN_SIZE, align_flag, align, result)) break;
+	}
 }
 
+static int
+merge_extensions(const int query_start, const int target_start, OutputStore* result, const int min_aln_size);
+
 int  dw(const char* query, const int query_size, const int query_start,
         const char* target, const int target_size, const int target_start,
-        int* U, int* V, Alignment* align, DPathData2* d_path, 
-        PathPoint* aln_path, OutputStore* result, SW_Parameters* swp,
-	    double error_rate, const int min_aln_size)
+        int* U, int* V, Alignment* align, DiffTrace* trace, 
+        OutputStore* result, SW_Parameters* swp,
+	    double error_rate, const int min_aln_size, DiffSimdData* sd)
 {
+    result->reserve(query_size + target_size + 1);
     result->init();
     align->init();
     // left extend
     dw_in_one_direction(query + query_start - 1, query_start,
 						target + target_start - 1, target_start,
-						U, V, align, d_path, aln_path, swp, result, 
-						0, error_rate);
+						U, V, align, trace, swp, result, 
+						0, error_rate, sd);
     align->init();
     // right extend
     dw_in_one_direction(query + query_start, query_size - query_start,
 						target + target_start, target_size - target_start,
-						U, V, align, d_path, aln_path, swp, result, 
-						1, error_rate);
+						U, V, align, trace, swp, result, 
+						1, error_rate, sd);
+
+    return merge_extensions(query_start, target_start, result, min_aln_size);
+}
 
-    // merge the results
+// joins the left and right extensions in result into its output strings
+static int
+merge_extensions(const int query_start, const int target_start, OutputStore* result, const int min_aln_size)
+{
     int i, j, k, idx = 0;
     const char* encode2char = "ACGT-";
     for (k = result->left_store_size - 1, i = 0, j = 0; k > - 1; --k, ++idx)
@@ -487,19 +450,104 @@ bool GetAlignment(const char* query, const int query_start, const int query_size
 	int flag = dw(query, query_size, query_start,
 				  target, target_size, target_start,
 				  drd->DynQ, drd->DynT, 
-				  drd->align, drd->d_path,
-				  drd->aln_path, drd->result,
-				  &drd->swp, error_rate, min_aln_size);
+				  drd->align, drd->trace,
+				  drd->result,
+				  &drd->swp, error_rate, min_aln_size, drd->sd);
 	if (!flag) return false;
-	
+	return fill_m5record_from_output_store(*drd->result, query_size, target_size, m5);
+}
+
+BatchRunningData::BatchRunningData(const SW_Parameters& swp_in, const int n)
+{
+	swp = swp_in;
+	max_slots = n;
+	safe_malloc(results, OutputStore*, max_slots);
+	safe_malloc(aligns, Alignment*, 2 * max_slots);
+	for (int i = 0; i < max_slots; ++i) results[i] = new OutputStore(swp.max_aln_size);
+	for (int i = 0; i < 2 * max_slots; ++i) aligns[i] = new Alignment(swp.segment_aln_size);
+	traces = new DiffTrace[2 * max_slots];
+	safe_malloc(blocks, DiffSimdBlock, 2 * max_slots);
+}
+
+BatchRunningData::~BatchRunningData()
+{
+	for (int i = 0; i < max_slots; ++i) delete results[i];
+	for (int i = 0; i < 2 * max_slots; ++i) delete aligns[i];
+	safe_free(results);
+	safe_free(aligns);
+	delete[] traces;
+	safe_free(blocks);
+}
+
+void GetAlignmentBatch(BatchAlignmentSlot* slots, const int num_slots,
+					   BatchRunningData* brd, double error_rate,
+					   const int min_aln_size)
+{
+	r_assert(num_slots <= brd->max_slots);
+	const int ALN_SIZE = brd->swp.segment_size;
+
+	// extension 2 * i is the left extension of slot i, 2 * i + 1 its right extension
+	std::vector<BlockExtension> exts;
+	exts.reserve(2 * num_slots);
+	for (int i = 0; i < num_slots; ++i)
+	{
+		BatchAlignmentSlot& slot = slots[i];
+		slot.result = brd->results[i];
+		slot.result->reserve(slot.query_size + slot.target_size + 1);
+		slot.result->init();
+		exts.push_back(BlockExtension(slot.query + slot.query_start - 1, slot.query_start,
+									  slot.target + slot.target_start - 1, slot.target_start, 0));
+		exts.push_back(BlockExtension(slot.query + slot.query_start, slot.query_size - slot.query_start,
+									  slot.target + slot.target_start, slot.target_size - slot.target_start, 1));
+	}
+
+	// every round aligns the next block of all the running extensions together
+	std::vector<int> running;
+	for (int e = 0; e < 2 * num_slots; ++e) running.push_back(e);
+	while (!running.empty())
+	{
+		int num_blocks = 0;
+		for (size_t r = 0; r < running.size(); ++r)
+		{
+			const int e = running[r];
+			DiffSimdBlock& b = brd->blocks[num_blocks];
+			int seg_size;
+			if (!exts[e].next_block(ALN_SIZE, b.query, b.target, seg_size)) continue;
+			b.q_len = b.t_len = seg_size;
+			b.band_tolerance = block_band_tolerance(seg_size);
+			b.max_d = block_max_d(seg_size, error_rate);
+			b.right_extend = exts[e].right_extend;
+			b.trace = brd->traces + e;
+			running[num_blocks++] = e;
+		}
+		diff_simd_align_batch(brd->blocks, num_blocks, &brd->sd);
+
+		int r = 0;
+		for (int i = 0; i < num_blocks; ++i)
+		{
+			const int e = running[i];
+			const DiffSimdBlock& b = brd->blocks[i];
+			Alignment* align = brd->aligns[e];
+			int align_flag = get_block_alignment(b.query, b.target, b.q_len, b.right_extend, b.aligned, b.end, b.trace, align);
+			if (exts[e].add_block(ALN_SIZE, align_flag, align, slots[e / 2].result)) running[r++] = e;
+		}
+		running.resize(r);
+	}
+
+	for (int i = 0; i < num_slots; ++i)
+		slots[i].aligned = merge_extensions(slots[i].query_start, slots[i].target_start, slots[i].result, min_aln_size);
+}
+
+bool fill_m5record_from_output_store(const OutputStore& result, const int query_size, const int target_size, M5Record& m5)
+{
 	int qrb = 0, qre = 0;
 	int trb = 0, tre = 0;
 	int eit = 0, k = 0;
 	const int consecutive_match_region_size = 4;
-	for (k = 0; k < drd->result->out_store_size && eit < consecutive_match_region_size; ++k)
+	for (k = 0; k < result.out_store_size && eit < consecutive_match_region_size; ++k)
 	{
-		const char qc = drd->result->out_store1[k];
-		const char tc = drd->result->out_store2[k];
+		const char qc = result.out_store1[k];
+		const char tc = result.out_store2[k];
 		if (qc != '-') ++qrb;
 		if (tc != '-') ++trb;
 		if (qc == tc) ++eit;
@@ -515,10 +563,10 @@ bool GetAlignment(const char* query, const int query_start, const int query_size
 		std::cout << qrb << "\t" << trb << "\t" << eit << "\t" << k << "\n";
 	}
 	
-	for (k = drd->result->out_store_size - 1, eit = 0; k >= 0 && eit < consecutive_match_region_size; --k)
+	for (k = result.out_store_size - 1, eit = 0; k >= 0 && eit < consecutive_match_region_size; --k)
 	{
-		const char qc = drd->result->out_store1[k];
-		const char tc = drd->result->out_store2[k];
+		const char qc = result.out_store1[k];
+		const char tc = result.out_store2[k];
 		if (qc != '-') ++qre;
 		if (tc != '-') ++tre;
 		if (qc == tc) ++eit;
@@ -531,20 +579,21 @@ bool GetAlignment(const char* query, const int query_start, const int query_size
 	const int end_aln_id = k + 1;
 	
 	m5qsize(m5) = query_size;
-	m5qoff(m5) = drd->result->query_start + qrb;
-	m5qend(m5) = drd->result->query_end - qre;
+	m5qoff(m5) = result.query_start + qrb;
+	m5qend(m5) = result.query_end - qre;
 	m5qdir(m5) = FWD;
 
 	m5ssize(m5) = target_size;
-	m5soff(m5) = drd->result->target_start + trb;
-	m5send(m5) = drd->result->target_end - tre;
+	m5soff(m5) = result.target_start + trb;
+	m5send(m5) = result.target_end - tre;
 	m5sdir(m5) = FWD;
 
 	const int aln_size = end_aln_id - start_aln_id;
+	ReserveM5Record(m5, aln_size);
 
-	memcpy(m5qaln(m5), drd->result->out_store1 + start_aln_id, aln_size);
-	memcpy(m5saln(m5), drd->result->out_store2 + start_aln_id, aln_size);
-	memcpy(m5pat(m5), drd->result->out_match_pattern + start_aln_id, aln_size);
+	memcpy(m5qaln(m5), result.out_store1 + start_aln_id, aln_size);
+	memcpy(m5saln(m5), result.out_store2 + start_aln_id, aln_size);
+	memcpy(m5pat(m5), result.out_match_pattern + start_aln_id, aln_size);
 	m5qaln(m5)[aln_size] = '\0';
 	m5saln(m5)[aln_size] = '\0';
 	m5pat(m5)[aln_size] = '\0';
@@ -2,8 +2,11 @@
 #define DW_H
 
 #include <algorithm>
+#include <vector>
 
 #include "../common/alignment.h"
+#include "../common/diff_simd.h"
+#include "../common/diff_trace.h"
 #include "../common/defs.h"
 #include "../common/packed_db.h"
 
@@ -15,10 +18,7 @@ struct SW_Parameters
     idx_t row_size;
     idx_t column_size;
     idx_t segment_aln_size;
-    idx_t max_seq_size;
-    idx_t max_aln_size;
-    idx_t d_path_size;
-    idx_t aln_path_size;
+    idx_t max_aln_size;	// initial size of the output, grown for longer sequences
 };
 
 SW_Parameters
@@ -74,19 +74,39 @@ struct OutputStore
     int target_start, target_end;
     int mat, mis, ins, del;
 	double ident;
+    idx_t capacity;
     
     OutputStore(const idx_t max_aln_size)
     {
-        safe_malloc(left_store1, char, max_aln_size);
-        safe_malloc(left_store2, char, max_aln_size);
-        safe_malloc(right_store1, char, max_aln_size);
-        safe_malloc(right_store2, char, max_aln_size);
-        safe_malloc(out_store1, char, max_aln_size);
-        safe_malloc(out_store2, char, max_aln_size);
-        safe_malloc(out_match_pattern, char, max_aln_size);
+        alloc(max_aln_size);
     }
 
     ~OutputStore()
+    {
+        release();
+    }
+
+    // makes room for an alignment of aln_size columns, the stored one is lost
+    void reserve(const idx_t aln_size)
+    {
+        if (aln_size <= capacity) return;
+        release();
+        alloc(std::max(aln_size, 2 * capacity));
+    }
+
+    void alloc(const idx_t size)
+    {
+        capacity = size;
+        safe_malloc(left_store1, char, size);
+        safe_malloc(left_store2, char, size);
+        safe_malloc(right_store1, char, size);
+        safe_malloc(right_store2, char, size);
+        safe_malloc(out_store1, char, size);
+        safe_malloc(out_store2, char, size);
+        safe_malloc(out_match_pattern, char, size);
+    }
+
+    void release()
     {
         safe_free(left_store1);
         safe_free(left_store2);
@@ -103,34 +123,17 @@ struct OutputStore
     }
 };
 
-struct DPathData
-{
-    int pre_k, x1, y1, x2, y2;
-};
-
-struct DPathData2
-{
-    int d, k, pre_k, x1, y1, x2, y2;
-};
-
-struct PathPoint
-{
-    int x, y;
-};
-
 struct DiffRunningData
 {
     SW_Parameters   swp;
-    char*           query;
-    char*           target;
     int*            DynQ;
     int*            DynT;
     Alignment*      align;
     OutputStore*    result;
-    DPathData2*     d_path;
-    PathPoint*      aln_path;
+    DiffTrace*      trace;
+	DiffSimdData*   sd; // NULL unless the vectorized kernel is used
 	
-	DiffRunningData(const SW_Parameters& swp_in);
+	DiffRunningData(const SW_Parameters& swp_in, const int ext_kernel);
 	~DiffRunningData();
 };
 
@@ -166,23 +169,66 @@ void print_candidate(const CandidateStartPosition& csp);
 
 int Align(const char* query, const int q_len, const char* target, const int t_len, 
           const int band_tolerance, const int get_aln_str, Alignment* align, 
-		  int* V, int* U, DPathData2* d_path, PathPoint* aln_path, const int right_extend);
+		  int* V, int* U, DiffTrace* trace, const int right_extend, double error_rate);
 
 void dw_in_one_direction(const char* query, const int query_size, const char* target, const int target_size,
-						 int* U, int* V, Alignment* align, DPathData2* d_path, PathPoint* aln_path, 
-						 SW_Parameters* swp, OutputStore* result, const int right_extend);
+						 int* U, int* V, Alignment* align, DiffTrace* trace, 
+						 SW_Parameters* swp, OutputStore* result, const int right_extend, double error_rate,
+						 DiffSimdData* sd);
 
 int  dw(const char* query, const int query_size, const int query_start,
         const char* target, const int target_size, const int target_start,
-        int* U, int* V, Alignment* align, DPathData2* d_path, 
-        PathPoint* aln_path, OutputStore* result, SW_Parameters* swp,
-	    double error_rate, const int min_aln_size);
+        int* U, int* V, Alignment* align, DiffTrace* trace, 
+        OutputStore* result, SW_Parameters* swp,
+	    double error_rate, const int min_aln_size, DiffSimdData* sd);
 
 bool GetAlignment(const char* query, const int query_start, const int query_size,
 				  const char* target, const int target_start, const int target_size,
 				  DiffRunningData* drd, M5Record& m5, double error_rate, 
 				  const int min_aln_size);
 
+// trims the ends of the alignment in result to matches and copies it to m5,
+// false if no such alignment is left
+bool fill_m5record_from_output_store(const OutputStore& result, const int query_size, const int target_size, M5Record& m5);
+
+// one candidate of GetAlignmentBatch: the arguments of GetAlignment and
+// the alignment computed for them
+struct BatchAlignmentSlot
+{
+	const char* query;
+	int query_start;
+	int query_size;
+	const char* target;
+	int target_start;
+	int target_size;
+
+	OutputStore* result;
+	bool aligned;
+};
+
+struct BatchRunningData
+{
+	SW_Parameters   swp;
+	int             max_slots;
+	OutputStore**   results;	// one per slot
+	Alignment**     aligns;		// two per slot, the left and the right extension
+	DiffTrace*      traces;
+	DiffSimdBlock*  blocks;
+	DiffSimdData    sd;
+
+	BatchRunningData(const SW_Parameters& swp_in, const int max_slots);
+	~BatchRunningData();
+};
+
+// aligns the slots as GetAlignment does with the vectorized kernel.
+// the left and right extensions of all the slots advance one block at a time,
+// the blocks of a round being aligned together by diff_simd_align_batch.
+// the alignment of a slot is left in its result, which belongs to brd,
+// and fill_m5record_from_output_store turns it into the m5 GetAlignment would give.
+void GetAlignmentBatch(BatchAlignmentSlot* slots, const int num_slots,
+					   BatchRunningData* brd, double error_rate,
+					   const int min_aln_size);
+
 } // end of namespace ns_banded_sw
 
 #endif  // DW_H
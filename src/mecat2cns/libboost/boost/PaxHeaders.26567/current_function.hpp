@@ -1,3 +0,0 @@
-30 mtime=1491398784.937713457
-30 atime=1491398911.703127955
-30 ctime=1491398784.937713457
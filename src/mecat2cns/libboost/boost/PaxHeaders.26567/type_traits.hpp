@@ -1,3 +0,0 @@
-30 mtime=1491398777.045625114
-30 atime=1491398911.643127287
-30 ctime=1491398777.045625114
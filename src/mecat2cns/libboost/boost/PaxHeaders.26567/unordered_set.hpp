@@ -1,3 +0,0 @@
-30 mtime=1491398782.745688924
-30 atime=1491398911.683127732
-30 ctime=1491398782.745688924
@@ -1,3 +0,0 @@
-30 mtime=1491398778.345639668
-30 atime=1491398911.683127732
-30 ctime=1491398778.345639668
@@ -1,3 +0,0 @@
-29 mtime=1491398784.98171395
-30 atime=1491398911.683127732
-29 ctime=1491398784.98171395
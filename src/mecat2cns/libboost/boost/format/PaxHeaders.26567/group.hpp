@@ -1,3 +0,0 @@
-30 mtime=1491398777.193626771
-30 atime=1491398911.719128132
-30 ctime=1491398777.193626771
@@ -1,3 +0,0 @@
-29 mtime=1491398780.68166582
-30 atime=1491398911.635127198
-29 ctime=1491398780.68166582
@@ -1,3 +0,0 @@
-30 mtime=1491398780.713666177
-30 atime=1491398911.635127198
-30 ctime=1491398780.713666177
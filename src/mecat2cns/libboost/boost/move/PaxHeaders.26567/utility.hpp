@@ -1,3 +0,0 @@
-30 mtime=1491398784.849712472
-30 atime=1491398911.659127465
-30 ctime=1491398784.849712472
@@ -1,3 +0,0 @@
-30 mtime=1491398784.905713099
-29 atime=1491398911.65512742
-30 ctime=1491398784.905713099
@@ -1,3 +0,0 @@
-30 mtime=1491398778.629642848
-30 atime=1491398911.751128488
-30 ctime=1491398778.629642848
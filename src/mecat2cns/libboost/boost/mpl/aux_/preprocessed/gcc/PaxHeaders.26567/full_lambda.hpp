@@ -1,3 +0,0 @@
-29 mtime=1491398780.21366058
-30 atime=1491398911.747128444
-29 ctime=1491398780.21366058
@@ -1,3 +0,0 @@
-28 mtime=1491398778.8576454
-30 atime=1491398911.747128444
-28 ctime=1491398778.8576454
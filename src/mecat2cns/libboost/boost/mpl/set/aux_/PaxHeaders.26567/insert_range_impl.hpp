@@ -1,3 +0,0 @@
-30 mtime=1491398778.981646789
-30 atime=1491398911.747128444
-30 ctime=1491398778.981646789
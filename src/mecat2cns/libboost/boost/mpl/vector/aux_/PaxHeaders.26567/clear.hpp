@@ -1,3 +0,0 @@
-30 mtime=1491398779.069647774
-29 atime=1491398911.73512831
-30 ctime=1491398779.069647774
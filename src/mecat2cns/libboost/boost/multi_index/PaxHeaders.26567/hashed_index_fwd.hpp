@@ -1,3 +0,0 @@
-30 mtime=1491398780.837667566
-30 atime=1491398911.719128132
-30 ctime=1491398780.837667566
@@ -1,3 +0,0 @@
-29 mtime=1491398780.94166873
-30 atime=1491398911.723128177
-29 ctime=1491398780.94166873
@@ -1,3 +0,0 @@
-30 mtime=1491398781.057670029
-30 atime=1491398911.723128177
-30 ctime=1491398781.057670029
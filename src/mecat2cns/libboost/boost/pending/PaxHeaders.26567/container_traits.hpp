@@ -1,3 +0,0 @@
-30 mtime=1491398782.837689953
-30 atime=1491398911.659127465
-30 ctime=1491398782.837689953
@@ -1,3 +0,0 @@
-29 mtime=1491398784.55370916
-30 atime=1491398911.711128044
-29 ctime=1491398784.55370916
@@ -1,3 +0,0 @@
-28 mtime=1491398784.6377101
-30 atime=1491398911.711128044
-28 ctime=1491398784.6377101
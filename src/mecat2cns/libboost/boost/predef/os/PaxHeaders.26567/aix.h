@@ -1,3 +0,0 @@
-29 mtime=1491398784.45370804
-30 atime=1491398911.707127998
-29 ctime=1491398784.45370804
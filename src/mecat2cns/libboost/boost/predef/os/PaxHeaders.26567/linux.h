@@ -1,3 +0,0 @@
-30 mtime=1491398784.493708488
-30 atime=1491398911.711128044
-30 ctime=1491398784.493708488
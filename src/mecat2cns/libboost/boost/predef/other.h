@@ -1,14 +0,0 @@
-/*
-Copyright Rene Rivera 2013
-Distributed under the Boost Software License, Version 1.0.
-(See accompanying file LICENSE_1_0.txt or copy at
-http://www.boost.org/LICENSE_1_0.txt)
-*/
-
-#ifndef BOOST_PREDEF_OTHER_H
-#define BOOST_PREDEF_OTHER_H
-
-#include <boost/predef/other/endian.h>
-/*#include <boost/predef/other/.h>*/
-
-#endif
@@ -1,3 +0,0 @@
-30 mtime=1491398781.917679655
-30 atime=1491398911.683127732
-30 ctime=1491398781.917679655
@@ -1,3 +0,0 @@
-30 mtime=1491398781.889679341
-30 atime=1491398911.675127643
-30 ctime=1491398781.889679341
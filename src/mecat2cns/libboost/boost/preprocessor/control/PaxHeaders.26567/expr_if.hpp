@@ -1,3 +0,0 @@
-30 mtime=1491398781.733677595
-30 atime=1491398911.671127598
-30 ctime=1491398781.733677595
@@ -1,3 +0,0 @@
-30 mtime=1491398782.081681491
-30 atime=1491398911.679127688
-30 ctime=1491398782.081681491
@@ -1,3 +0,0 @@
-29 mtime=1491398782.08968158
-30 atime=1491398911.679127688
-29 ctime=1491398782.08968158
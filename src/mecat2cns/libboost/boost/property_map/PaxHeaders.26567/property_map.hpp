@@ -1,3 +0,0 @@
-30 mtime=1491398778.317639355
-30 atime=1491398911.707127998
-30 ctime=1491398778.317639355
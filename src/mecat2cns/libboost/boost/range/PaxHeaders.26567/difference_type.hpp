@@ -1,3 +0,0 @@
-29 mtime=1491398782.54168664
-30 atime=1491398911.651127376
-29 ctime=1491398782.54168664
@@ -1,3 +0,0 @@
-30 mtime=1491398782.513686326
-30 atime=1491398911.651127376
-30 ctime=1491398782.513686326
@@ -1,3 +0,0 @@
-30 mtime=1491398782.621687535
-30 atime=1491398911.651127376
-30 ctime=1491398782.621687535
@@ -1,3 +0,0 @@
-30 mtime=1491398782.553686774
-30 atime=1491398911.647127331
-30 ctime=1491398782.553686774
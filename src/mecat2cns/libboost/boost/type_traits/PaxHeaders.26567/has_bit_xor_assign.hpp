@@ -1,3 +0,0 @@
-30 mtime=1491398783.437696669
-30 atime=1491398911.695127866
-30 ctime=1491398783.437696669
@@ -1,3 +0,0 @@
-29 mtime=1491398783.15369349
-29 atime=1491398911.69112782
-29 ctime=1491398783.15369349
@@ -1,3 +0,0 @@
-30 mtime=1491398783.561698057
-30 atime=1491398911.699127909
-30 ctime=1491398783.561698057
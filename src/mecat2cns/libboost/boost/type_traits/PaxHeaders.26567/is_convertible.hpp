@@ -1,3 +0,0 @@
-30 mtime=1491398783.197693982
-29 atime=1491398911.69112782
-30 ctime=1491398783.197693982
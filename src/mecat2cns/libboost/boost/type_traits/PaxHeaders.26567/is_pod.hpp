@@ -1,3 +0,0 @@
-28 mtime=1491398783.6816994
-30 atime=1491398911.695127866
-28 ctime=1491398783.6816994
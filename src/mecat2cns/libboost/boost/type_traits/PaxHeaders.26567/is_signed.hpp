@@ -1,3 +0,0 @@
-29 mtime=1491398783.16969367
-30 atime=1491398911.699127909
-29 ctime=1491398783.16969367
@@ -1,3 +0,0 @@
-29 mtime=1491398782.90169067
-30 atime=1491398911.695127866
-29 ctime=1491398782.90169067
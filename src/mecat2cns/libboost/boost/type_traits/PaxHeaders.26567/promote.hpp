@@ -1,3 +0,0 @@
-29 mtime=1491398783.67369931
-29 atime=1491398911.69112782
-29 ctime=1491398783.67369931
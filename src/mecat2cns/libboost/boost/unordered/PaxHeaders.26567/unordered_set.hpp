@@ -1,3 +0,0 @@
-29 mtime=1491398777.49363013
-30 atime=1491398911.667127554
-29 ctime=1491398777.49363013
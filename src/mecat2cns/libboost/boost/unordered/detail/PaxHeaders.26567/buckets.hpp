@@ -1,3 +0,0 @@
-30 mtime=1491398777.649631876
-30 atime=1491398911.663127509
-30 ctime=1491398777.649631876
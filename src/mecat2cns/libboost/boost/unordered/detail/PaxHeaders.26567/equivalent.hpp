@@ -1,3 +0,0 @@
-30 mtime=1491398777.601631339
-30 atime=1491398911.667127554
-30 ctime=1491398777.601631339
@@ -1,3 +0,0 @@
-30 mtime=1491398780.793667073
-30 atime=1491398911.687127777
-30 ctime=1491398780.793667073
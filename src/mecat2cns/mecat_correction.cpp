@@ -1,6 +1,6 @@
 #include "mecat_correction.h"
 
-#include "MECAT_AlnGraphBoost.H"
+#include <set>
 
 using namespace ns_banded_sw;
 
@@ -12,14 +12,14 @@ namespace ns_meap_cns {
 #define UNDS 8
 
 inline uint1
-identify_one_consensus_item(CnsTableItem& cns_item, const int min_cov)
+identify_one_consensus_item(const CnsVoteTable& votes, const index_t i, const int min_cov)
 {
 	uint1 ident = 0;
-	int cov = cns_item.mat_cnt + cns_item.ins_cnt;
-	if (cns_item.mat_cnt >= cov * 0.8) ident |= FMAT;
-	if (cns_item.ins_cnt >= cov * 0.8) ident |= FINS;
+	int cov = votes.cov(i);
+	if (votes.mat_cnt(i) >= cov * 0.8) ident |= FMAT;
+	if (votes.ins_cnt(i) >= cov * 0.8) ident |= FINS;
 	if (!ident) ident |= UNDS;
-	if (cns_item.del_cnt >= cov * 0.4) ident |= FDEL;
+	if (votes.del_cnt(i) >= cov * 0.4) ident |= FDEL;
 	return ident;
 }
 
@@ -33,38 +33,12 @@ struct CompareOverlapByOverlapSize
 	}
 };
 
-void
-meap_add_one_aln(const std::string& qaln, const std::string& saln, index_t start_soff, CnsTableItem* cns_table, const char* org_seq)
-{
-	r_assert(qaln.size() == saln.size());
-	const index_t aln_size = qaln.size();
-	index_t i = 0;
-	const char kGap = '-';
-	while (i < aln_size)
-	{
-		const char q = qaln[i];
-		const char s = saln[i];
-		if (q == kGap && s == kGap) { ++i; continue; }
-		
-		if (q == s) { ++cns_table[start_soff].mat_cnt; cns_table[start_soff].base = s; ++start_soff; ++i; }
-		else if (q == kGap) { ++cns_table[start_soff].ins_cnt; ++start_soff; ++i; }
-		else
-		{
-			r_assert(s == kGap);
-			index_t j = i + 1;
-			while (j < aln_size && saln[j] == kGap) ++j;
-			++cns_table[start_soff - 1].del_cnt;
-			i = j;
-		}
-	}
-}
-
 void
 meap_cns_one_indel(const int sb, const int se, CnsAlns& cns_vec, 
 				   const int min_cov, std::string& aux_qstr,
-				   std::string& aux_tstr, std::string& cns)
+				   std::string& aux_tstr, PoaGraph& ag, std::string& cns)
 {
-	AlnGraphBoost ag(se - sb + 1);
+	ag.reset(se - sb + 1);
 	int sb_out;
 	for (CnsAln* iter = cns_vec.begin(); iter != cns_vec.end(); ++iter)
 	{
@@ -78,20 +52,20 @@ meap_cns_one_indel(const int sb, const int se, CnsAlns& cns_vec,
 }
 
 void
-meap_consensus_one_segment(CnsTableItem* cns_list, const int cns_list_size, 
+meap_consensus_one_segment(const CnsVoteTable& votes, const int cns_list_size, 
 						   uint1* cns_id_vec,
 						   int start_soff, CnsAlns& cns_vec, 
 						   std::string& aux_qstr, std::string& aux_tstr,
-						   std::string& target, const int min_cov)
+						   PoaGraph& poa, std::string& target, const int min_cov)
 {
-	for (int i = 0; i < cns_list_size; ++i) cns_id_vec[i] = identify_one_consensus_item(cns_list[i], min_cov);
+	for (int i = 0; i < cns_list_size; ++i) cns_id_vec[i] = identify_one_consensus_item(votes, i + start_soff, min_cov);
 	int i = 0, j; 
 	std::string cns;
 	target.clear();
 	while (i < cns_list_size && !(cns_id_vec[i] & FMAT)) ++i;
 	while (i < cns_list_size)
 	{
-		target.push_back(cns_list[i].base);
+		target.push_back(votes.base(i + start_soff));
 		j = i + 1;
 		while (j < cns_list_size && !(cns_id_vec[j] & FMAT)) ++j;
 		
@@ -100,7 +74,7 @@ meap_consensus_one_segment(CnsTableItem* cns_list, const int cns_list_size,
 			if ((cns_id_vec[k] & UNDS) || (cns_id_vec[k] & FDEL)) { need_refinement = true; break; }
 		if (need_refinement)
 		{
-			meap_cns_one_indel(i + start_soff, j + start_soff, cns_vec, cns_list[i].mat_cnt + cns_list[i].ins_cnt, aux_qstr, aux_tstr, cns);
+			meap_cns_one_indel(i + start_soff, j + start_soff, cns_vec, votes.cov(i + start_soff), aux_qstr, aux_tstr, poa, cns);
 			if (cns.size() > 2) target.append(cns.data() + 1, cns.size() - 2);
 		}
 		i = j;
@@ -200,11 +174,12 @@ check_ovlp_mapping_range(const int qb, const int qe, const int qs,
 }
 
 void
-consensus_worker(CnsTableItem* cns_table,
+consensus_worker(const CnsVoteTable& votes,
 				 uint1* id_list,
 				 CnsAlns& cns_vec,
 				 std::string& aux_qstr,
 				 std::string& aux_tstr,
+				 PoaGraph& poa,
 				 std::vector<MappingRange>& eranges,
 				 const int min_cov,
 				 const int min_size,
@@ -222,13 +197,12 @@ consensus_worker(CnsTableItem* cns_table,
 		beg = L;
 		while (beg < R)
 		{
-			while (beg < R && cns_table[beg].mat_cnt + cns_table[beg].ins_cnt < min_cov) ++beg;
-			end = beg + 1;
-			while (end < R && cns_table[end].mat_cnt + cns_table[end].ins_cnt >= min_cov) ++end;
+			beg = votes.next_covered(beg, R, min_cov);
+			end = (beg < R) ? votes.next_uncovered(beg + 1, R, min_cov) : beg + 1;
 			if (end - beg >= 0.95 * min_size)
 			{
-				meap_consensus_one_segment(cns_table + beg, end - beg, id_list,
-										   beg, cns_vec, aux_qstr, aux_tstr, cns_seq, min_cov);
+				meap_consensus_one_segment(votes, end - beg, id_list,
+										   beg, cns_vec, aux_qstr, aux_tstr, poa, cns_seq, min_cov);
 				
 				if (cns_seq.size() >= min_size) output_cns_result(cns_results, cns_result, beg, end, cns_seq);
 			}
@@ -238,125 +212,90 @@ consensus_worker(CnsTableItem* cns_table,
 	}
 }
 
-void
-consensus_one_read_m4_pacbio(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid)
+// loads the query of candidate ec in the orientation it maps to the template
+inline void
+get_candidate_query(ConsensusThreadData* ctd, const ExtensionCandidate& ec, std::vector<char>& qstr, index_t& qext)
 {
-	PackedDB& reads = *ctd->reads;
-	ExtensionCandidate* overlaps = ctd->candidates;
-	DiffRunningData* drd_s = ctd->drd_s;
-	DiffRunningData* drd = NULL;
-	M5Record* m5 = ctd->m5;
-	CnsAlns& cns_vec = ctd->cns_alns;
-	std::vector<CnsResult>& cns_results = ctd->cns_results;
-	const index_t read_size = overlaps[sid].ssize;
-	std::vector<char>& qstr = ctd->query;
-	std::vector<char>& tstr = ctd->target;
-	tstr.resize(read_size);
-	reads.GetSequence(read_id, true, tstr.data(), read_size);
-	std::string& nqstr = ctd->qaln;
-	std::string& ntstr = ctd->saln;
-	const int min_align_size = ctd->rco.min_align_size;
-	const int max_added = 60;
-
-	index_t L, R;
-	if (eid - sid <= max_added)
-	{
-		L = sid;
-		R = eid;
-	}
-	else
-	{
-		L = sid;
-		R = L + max_added;    
-		std::sort(overlaps + sid, overlaps + eid, CompareOverlapByOverlapSize());
-	}
+	qstr.resize(ec.qsize);
+	ctd->reads->GetSequence(ec.qid, ec.qdir == FWD, qstr.data(), ec.qsize);
+	qext = ec.qext;
+	if (ec.qdir == REV) qext = ec.qsize - 1 - qext;
+}
 
-	CnsTableItem* cns_table = ctd->cns_table;
-	std::for_each(cns_table, cns_table + read_size, CnsTableItemCleaner());
-	cns_vec.clear();
-	for (index_t i = L; i < R; ++i)
+// aligns the candidates of a read against the template in tstr, in the order
+// the consensus loops ask for them. with the vectorized kernel, the candidates
+// from the asked one on are aligned CNS_BATCH_SIZE at a time by GetAlignmentBatch.
+// candidates whose read is already in used_ids are left out of a batch, as the
+// loops skip them.
+class CandidateAligner
+{
+public:
+	CandidateAligner(ConsensusThreadData* ctd, std::vector<char>& tstr, const double error_rate, const std::set<int>* used_ids)
+		: ctd_(ctd), tstr_(tstr), error_rate_(error_rate), used_ids_(used_ids), batch_begin_(0), batch_end_(0) {}
+
+	// aligns candidate i of the candidates [i, e) left, with the result GetAlignment gives
+	bool align(const ExtensionCandidate* candidates, const index_t i, const index_t e, M5Record& m5)
 	{
-		Overlap& ovlp = overlaps[i];
-		qstr.resize(ovlp.qsize);
-		reads.GetSequence(ovlp.qid, ovlp.qdir == FWD, qstr.data(), ovlp.qsize);
-		index_t qext = ovlp.qext;
-		index_t sext = ovlp.sext;
-		if (ovlp.qdir == REV) qext = ovlp.qsize - 1 - qext;
-		drd = drd_s;
-		bool r = GetAlignment(qstr.data(), qext, qstr.size(), tstr.data(), sext, tstr.size(), drd, *m5, 0.15, min_align_size);
-		if (r)
+		if (!ctd_->brd)
 		{
-			normalize_gaps(m5qaln(*m5), m5saln(*m5), strlen(m5qaln(*m5)), nqstr, ntstr, true);
-			meap_add_one_aln(nqstr, ntstr, m5soff(*m5), cns_table, tstr.data());
-			cns_vec.add_aln(m5soff(*m5), m5send(*m5), nqstr, ntstr);
+			const ExtensionCandidate& ec = candidates[i];
+			std::vector<char>& qstr = ctd_->query;
+			index_t qext;
+			get_candidate_query(ctd_, ec, qstr, qext);
+			return GetAlignment(qstr.data(), qext, qstr.size(), tstr_.data(), ec.sext, tstr_.size(), ctd_->drd_s, m5, error_rate_, ctd_->rco.min_align_size);
 		}
-	}
-	
-	std::vector<MappingRange> mranges, eranges;
-	cns_vec.get_mapping_ranges(mranges);
-	get_effective_ranges(mranges, eranges, read_size, ctd->rco.min_size);
-
-	consensus_worker(cns_table, ctd->id_list, cns_vec, nqstr, ntstr, eranges, ctd->rco.min_cov, ctd->rco.min_size, read_id,  cns_results);
-}
 
-void
-consensus_one_read_m4_nanopore(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid)
-{
-	PackedDB& reads = *ctd->reads;
-	ExtensionCandidate* overlaps = ctd->candidates;
-	DiffRunningData* drd_s = ctd->drd_s;
-	DiffRunningData* drd = NULL;
-	M5Record* m5 = ctd->m5;
-	CnsAlns& cns_vec = ctd->cns_alns;
-	std::vector<CnsResult>& cns_results = ctd->cns_results;
-	const index_t read_size = overlaps[sid].ssize;
-	std::vector<char>& qstr = ctd->query;
-	std::vector<char>& tstr = ctd->target;
-	tstr.resize(read_size);
-	reads.GetSequence(read_id, true, tstr.data(), read_size);
-	std::string& nqstr = ctd->qaln;
-	std::string& ntstr = ctd->saln;
-	const int min_align_size = ctd->rco.min_align_size;
-	const double min_mapping_ratio = ctd->rco.min_mapping_ratio - 0.02;
-
-	index_t L, R;
-	if (eid - sid <= MAX_CNS_OVLPS)
-	{
-		L = sid;
-		R = eid;
-	}
-	else
-	{
-		L = sid;
-		R = L + MAX_CNS_OVLPS;    
-		std::sort(overlaps + sid, overlaps + eid, CompareOverlapByOverlapSize());
+		if (i < batch_begin_ || i >= batch_end_ || slot_ids_[i - batch_begin_] < 0) align_batch(candidates, i, e);
+		const BatchAlignmentSlot& slot = slots_[slot_ids_[i - batch_begin_]];
+		return slot.aligned && fill_m5record_from_output_store(*slot.result, slot.query_size, slot.target_size, m5);
 	}
 
-	CnsTableItem* cns_table = ctd->cns_table;
-	std::for_each(cns_table, cns_table + read_size, CnsTableItemCleaner());
-	cns_vec.clear();
-	for (index_t i = L; i < R; ++i)
+private:
+	void align_batch(const ExtensionCandidate* candidates, const index_t i, const index_t e)
 	{
-		Overlap& ovlp = overlaps[i];
-		qstr.resize(ovlp.qsize);
-		reads.GetSequence(ovlp.qid, ovlp.qdir == FWD, qstr.data(), ovlp.qsize);
-		index_t qext = ovlp.qext;
-		index_t sext = ovlp.sext;
-		if (ovlp.qdir == REV) qext = ovlp.qsize - 1 - qext;
-		drd = drd_s;
-		bool r = GetAlignment(qstr.data(), qext, qstr.size(), tstr.data(), sext, tstr.size(), drd, *m5, 0.20, min_align_size);
-		if (r && check_ovlp_mapping_range(m5qoff(*m5), m5qend(*m5), ovlp.qsize, m5soff(*m5), m5send(*m5), ovlp.ssize, min_mapping_ratio))
+		int num_slots = 0;
+		index_t j;
+		slot_ids_.clear();
+		for (j = i; j < e && num_slots < CNS_BATCH_SIZE; ++j)
 		{
-			normalize_gaps(m5qaln(*m5), m5saln(*m5), strlen(m5qaln(*m5)), nqstr, ntstr, true);
-			meap_add_one_aln(nqstr, ntstr, m5soff(*m5), cns_table, tstr.data());
-			cns_vec.add_aln(m5soff(*m5), m5send(*m5), nqstr, ntstr);
+			const ExtensionCandidate& ec = candidates[j];
+			if (used_ids_ && used_ids_->find(ec.qid) != used_ids_->end())
+			{
+				slot_ids_.push_back(-1);
+				continue;
+			}
+			std::vector<char>& qstr = ctd_->batch_queries[num_slots];
+			index_t qext;
+			get_candidate_query(ctd_, ec, qstr, qext);
+			BatchAlignmentSlot& slot = slots_[num_slots];
+			slot.query = qstr.data();
+			slot.query_start = qext;
+			slot.query_size = qstr.size();
+			slot.target = tstr_.data();
+			slot.target_start = ec.sext;
+			slot.target_size = tstr_.size();
+			slot_ids_.push_back(num_slots++);
 		}
+		batch_begin_ = i;
+		batch_end_ = j;
+		GetAlignmentBatch(slots_, num_slots, ctd_->brd, error_rate_, ctd_->rco.min_align_size);
 	}
-	
-	std::vector<MappingRange> mranges, eranges;
-	eranges.push_back(MappingRange(0, read_size));
 
-	consensus_worker(cns_table, ctd->id_list, cns_vec, nqstr, ntstr, eranges, ctd->rco.min_cov, ctd->rco.min_size, read_id,  cns_results);
+private:
+	ConsensusThreadData* ctd_;
+	std::vector<char>& tstr_;
+	const double error_rate_;
+	const std::set<int>* used_ids_;
+	BatchAlignmentSlot slots_[CNS_BATCH_SIZE];
+	std::vector<int> slot_ids_;
+	index_t batch_begin_, batch_end_;
+};
+
+inline void
+add_cns_aln(ConsensusThreadData* ctd, M5Record& m5)
+{
+	CnsAln& aln = ctd->cns_alns.add_aln(m5soff(m5), m5send(m5), m5qaln(m5), m5saln(m5), strlen(m5qaln(m5)));
+	ctd->votes.add_aln(aln.qaln, aln.saln, aln.aln_size, m5soff(m5));
 }
 
 struct CmpExtensionCandidateByScore
@@ -385,130 +324,132 @@ check_cov_stats(u1_t* cov_stats, int soff, int send)
 	return false;
 }
 
-void
-consensus_one_read_can_pacbio(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid)
+// technology traits: how many alignments a read takes, the error rate of the
+// pairwise alignments and whether the consensus is restricted to the
+// effective ranges of the alignments or runs over the whole read.
+struct PacbioCnsTraits
 {
-	PackedDB& reads = *ctd->reads;
-	ExtensionCandidate* candidates = ctd->candidates;
-	DiffRunningData* drd_s = ctd->drd_s;
-	DiffRunningData* drd = NULL;
-	M5Record* m5 = ctd->m5;
-	CnsAlns& cns_vec = ctd->cns_alns;
-	std::vector<CnsResult>& cns_results = ctd->cns_results;
-	const index_t read_size = candidates[sid].ssize;
-	std::vector<char>& qstr = ctd->query;
-	std::vector<char>& tstr = ctd->target;
-	tstr.resize(read_size);
-	reads.GetSequence(read_id, true, tstr.data(), read_size);
-	std::string& nqstr = ctd->qaln;
-	std::string& ntstr = ctd->saln;
-	const int min_align_size = ctd->rco.min_align_size;
-	const double min_mapping_ratio = ctd->rco.min_mapping_ratio - 0.02;
-	const int max_added = 60;
-	
-	std::sort(candidates + sid, candidates + eid, CmpExtensionCandidateByScore());
-	int num_added = 0;
-    int num_ext = 0;
-    const int max_ext = 200;
-	CnsTableItem* cns_table = ctd->cns_table;
-	std::for_each(cns_table, cns_table + read_size, CnsTableItemCleaner());
-	cns_vec.clear();
-	std::set<int> used_ids;
-	u1_t* cov_stats = ctd->id_list;
-	std::fill(cov_stats, cov_stats + MAX_SEQ_SIZE, 0);
-	for (idx_t i = sid; i < eid && num_added < max_added && num_ext < max_ext; ++i)
+	static int max_added() { return 60; }
+	static double error_rate() { return 0.15; }
+	static bool check_m4_mapping_range() { return false; }
+	static bool use_effective_ranges() { return true; }
+};
+
+struct NanoporeCnsTraits
+{
+	static int max_added() { return MAX_CNS_OVLPS; }
+	static double error_rate() { return 0.20; }
+	static bool check_m4_mapping_range() { return true; }
+	static bool use_effective_ranges() { return false; }
+};
+
+// input traits: which overlaps of a read are aligned and voted into the table.
+// m4 overlaps are taken as they are, the largest ones first when there are
+// too many of them.
+struct M4CnsInput
+{
+	template <class Tech>
+	static void add_alignments(ConsensusThreadData* ctd, std::vector<char>& tstr, const index_t sid, const index_t eid)
 	{
-        ++num_ext;
-		ExtensionCandidate& ec = candidates[i];
-		r_assert(ec.sdir == FWD);
-		if (used_ids.find(ec.qid) != used_ids.end()) continue;
-		qstr.resize(ec.qsize);
-		reads.GetSequence(ec.qid, ec.qdir == FWD, qstr.data(), ec.qsize);
-		index_t qext = ec.qext;
-		index_t sext = ec.sext;
-		if (ec.qdir == REV) qext = ec.qsize - 1 - qext;
-		drd = drd_s;
-		bool r = GetAlignment(qstr.data(), qext, qstr.size(), tstr.data(), sext, tstr.size(), drd, *m5, 0.15, min_align_size);
-		if (r && check_ovlp_mapping_range(m5qoff(*m5), m5qend(*m5), ec.qsize, m5soff(*m5), m5send(*m5), ec.ssize, min_mapping_ratio))
+		ExtensionCandidate* overlaps = ctd->candidates;
+		M5Record* m5 = ctd->m5;
+		const double min_mapping_ratio = ctd->rco.min_mapping_ratio - 0.02;
+		const int max_added = Tech::max_added();
+
+		index_t L = sid, R = eid;
+		if (eid - sid > max_added)
 		{
-			if (check_cov_stats(cov_stats, m5soff(*m5), m5send(*m5)))
-			{
-				++num_added;
-				used_ids.insert(ec.qid);
-				normalize_gaps(m5qaln(*m5), m5saln(*m5), strlen(m5qaln(*m5)), nqstr, ntstr, true);
-				meap_add_one_aln(nqstr, ntstr, m5soff(*m5), cns_table, tstr.data());
-				cns_vec.add_aln(m5soff(*m5), m5send(*m5), nqstr, ntstr);
-			}
+			R = L + max_added;
+			std::sort(overlaps + sid, overlaps + eid, CompareOverlapByOverlapSize());
 		}
-	}
-	
-	std::vector<MappingRange> mranges, eranges;
-	cns_vec.get_mapping_ranges(mranges);
-	get_effective_ranges(mranges, eranges, read_size, ctd->rco.min_size);
 
-	consensus_worker(cns_table, ctd->id_list, cns_vec, nqstr, ntstr, eranges, ctd->rco.min_cov, ctd->rco.min_size, read_id,  cns_results);
-}
+		CandidateAligner aligner(ctd, tstr, Tech::error_rate(), NULL);
+		for (index_t i = L; i < R; ++i)
+		{
+			Overlap& ovlp = overlaps[i];
+			bool r = aligner.align(overlaps, i, R, *m5);
+			if (r && (!Tech::check_m4_mapping_range() 
+					  || check_ovlp_mapping_range(m5qoff(*m5), m5qend(*m5), ovlp.qsize, m5soff(*m5), m5send(*m5), ovlp.ssize, min_mapping_ratio)))
+				add_cns_aln(ctd, *m5);
+		}
+	}
+};
 
-void
-consensus_one_read_can_nanopore(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid)
+// candidates are tried best score first, at most once per read, and only
+// while they add coverage to the template.
+struct CanCnsInput
 {
-	PackedDB& reads = *ctd->reads;
-	ExtensionCandidate* candidates = ctd->candidates;
-	DiffRunningData* drd_s = ctd->drd_s;
-	DiffRunningData* drd = NULL;
-	M5Record* m5 = ctd->m5;
-	CnsAlns& cns_vec = ctd->cns_alns;
-	std::vector<CnsResult>& cns_results = ctd->cns_results;
-	const index_t read_size = candidates[sid].ssize;
-	std::vector<char>& qstr = ctd->query;
-	std::vector<char>& tstr = ctd->target;
-	tstr.resize(read_size);
-	reads.GetSequence(read_id, true, tstr.data(), read_size);
-	std::string& nqstr = ctd->qaln;
-	std::string& ntstr = ctd->saln;
-	const int min_align_size = ctd->rco.min_align_size;
-	const double min_mapping_ratio = ctd->rco.min_mapping_ratio - 0.02;
-	
-	std::sort(candidates + sid, candidates + eid, CmpExtensionCandidateByScore());
-	int num_added = 0;
-    int num_ext = 0;
-    const int max_ext = 200;
-	CnsTableItem* cns_table = ctd->cns_table;
-	std::for_each(cns_table, cns_table + read_size, CnsTableItemCleaner());
-	cns_vec.clear();
-	std::set<int> used_ids;
-	u1_t* cov_stats = ctd->id_list;
-	std::fill(cov_stats, cov_stats + MAX_SEQ_SIZE, 0);
-	for (idx_t i = sid; i < eid && num_added < MAX_CNS_OVLPS && num_ext < max_ext; ++i)
+	template <class Tech>
+	static void add_alignments(ConsensusThreadData* ctd, std::vector<char>& tstr, const index_t sid, const index_t eid)
 	{
-        ++num_ext;
-		ExtensionCandidate& ec = candidates[i];
-		r_assert(ec.sdir == FWD);
-		if (used_ids.find(ec.qid) != used_ids.end()) continue;
-		qstr.resize(ec.qsize);
-		reads.GetSequence(ec.qid, ec.qdir == FWD, qstr.data(), ec.qsize);
-		index_t qext = ec.qext;
-		index_t sext = ec.sext;
-		if (ec.qdir == REV) qext = ec.qsize - 1 - qext;
-		drd = drd_s;
-		bool r = GetAlignment(qstr.data(), qext, qstr.size(), tstr.data(), sext, tstr.size(), drd, *m5, 0.20, min_align_size);
-		if (r && check_ovlp_mapping_range(m5qoff(*m5), m5qend(*m5), ec.qsize, m5soff(*m5), m5send(*m5), ec.ssize, min_mapping_ratio))
+		ExtensionCandidate* candidates = ctd->candidates;
+		M5Record* m5 = ctd->m5;
+		const index_t read_size = candidates[sid].ssize;
+		const double min_mapping_ratio = ctd->rco.min_mapping_ratio - 0.02;
+		const int max_added = Tech::max_added();
+		const int max_ext = 200;
+
+		std::sort(candidates + sid, candidates + eid, CmpExtensionCandidateByScore());
+		int num_added = 0;
+		int num_ext = 0;
+		std::set<int> used_ids;
+		u1_t* cov_stats = ctd->id_list;
+		std::fill(cov_stats, cov_stats + read_size, 0);
+		CandidateAligner aligner(ctd, tstr, Tech::error_rate(), &used_ids);
+		for (idx_t i = sid; i < eid && num_added < max_added && num_ext < max_ext; ++i)
 		{
-			if (check_cov_stats(cov_stats, m5soff(*m5), m5send(*m5)))
+			++num_ext;
+			ExtensionCandidate& ec = candidates[i];
+			r_assert(ec.sdir == FWD);
+			if (used_ids.find(ec.qid) != used_ids.end()) continue;
+			bool r = aligner.align(candidates, i, eid, *m5);
+			if (r && check_ovlp_mapping_range(m5qoff(*m5), m5qend(*m5), ec.qsize, m5soff(*m5), m5send(*m5), ec.ssize, min_mapping_ratio)
+				&& check_cov_stats(cov_stats, m5soff(*m5), m5send(*m5)))
 			{
 				++num_added;
 				used_ids.insert(ec.qid);
-				normalize_gaps(m5qaln(*m5), m5saln(*m5), strlen(m5qaln(*m5)), nqstr, ntstr, true);
-				meap_add_one_aln(nqstr, ntstr, m5soff(*m5), cns_table, tstr.data());
-				cns_vec.add_aln(m5soff(*m5), m5send(*m5), nqstr, ntstr);
+				add_cns_aln(ctd, *m5);
 			}
 		}
 	}
+};
+
+template <class Input, class Tech>
+void
+consensus_one_read(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid)
+{
+	const index_t read_size = ctd->candidates[sid].ssize;
+	std::vector<char>& tstr = ctd->target;
+	tstr.resize(read_size);
+	ctd->reads->GetSequence(read_id, true, tstr.data(), read_size);
+
+	ctd->votes.reset(read_size);
+	ctd->cns_alns.clear();
+	Input::template add_alignments<Tech>(ctd, tstr, sid, eid);
 	
 	std::vector<MappingRange> mranges, eranges;
-	eranges.push_back(MappingRange(0, read_size));
+	if (Tech::use_effective_ranges())
+	{
+		ctd->cns_alns.get_mapping_ranges(mranges);
+		get_effective_ranges(mranges, eranges, read_size, ctd->rco.min_size);
+	}
+	else
+	{
+		eranges.push_back(MappingRange(0, read_size));
+	}
 
-	consensus_worker(cns_table, ctd->id_list, cns_vec, nqstr, ntstr, eranges, ctd->rco.min_cov, ctd->rco.min_size, read_id,  cns_results);
+	consensus_worker(ctd->votes, ctd->id_list, ctd->cns_alns, ctd->qaln, ctd->saln, ctd->poa, eranges, 
+					 ctd->rco.min_cov, ctd->rco.min_size, read_id, ctd->cns_results);
+}
+
+consensus_one_read_func
+select_consensus_one_read(const int input_type, const int tech)
+{
+	if (input_type == INPUT_TYPE_CAN)
+		return (tech == TECH_PACBIO) ? consensus_one_read<CanCnsInput, PacbioCnsTraits>
+									 : consensus_one_read<CanCnsInput, NanoporeCnsTraits>;
+	return (tech == TECH_PACBIO) ? consensus_one_read<M4CnsInput, PacbioCnsTraits>
+								 : consensus_one_read<M4CnsInput, NanoporeCnsTraits>;
 }
 
 } // namespace ns_meap_cns {
@@ -1,21 +1,16 @@
 #ifndef MEAP_CORRECTION_H
 #define MEAP_CORRECTION_H
 
+#include "cns_pipeline.h"
+#include "options.h"
 #include "reads_correction_aux.h"
 
 namespace ns_meap_cns {
 
-void
-consensus_one_read_m4_pacbio(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid);
-
-void
-consensus_one_read_m4_nanopore(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid);
-
-void
-consensus_one_read_can_pacbio(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid);
-
-void
-consensus_one_read_can_nanopore(ConsensusThreadData* ctd, const index_t read_id, const index_t sid, const index_t eid);
+// returns the consensus routine specialised for the input type (INPUT_TYPE_CAN/INPUT_TYPE_M4) 
+// and the sequencing technology (TECH_PACBIO/TECH_NANOPORE)
+consensus_one_read_func
+select_consensus_one_read(const int input_type, const int tech);
 
 } // namespace ns_meap_cns
 
@@ -16,7 +16,11 @@ static int cov_pacbio				= 6;
 static int min_size_pacbio			= 5000;
 static bool print_usage_pacbio		= false;
 static int tech_pacbio				= TECH_PACBIO;
-static int num_partition_files   	= 10;
+static int num_partition_buffers   	= 10;
+static int num_partitions_in_memory	= 2;
+static int ordered_output			= 0;
+static int ext_kernel				= EXT_KERNEL_DIFF;
+static index_t max_read_size		= DEFAULT_MAX_READ_SIZE;
 
 static int input_type_nanopore 		    = 1;
 static int num_threads_nanopore		    = 1;
@@ -39,7 +43,11 @@ static const char cov_n           = 'c';
 static const char min_size_n      = 'l';
 static const char usage_n         = 'h';
 static const char tech_n          = 'x';
-static const char num_partition_files_n = 'k';
+static const char num_partition_buffers_n = 'k';
+static const char num_partitions_in_memory_n = 'w';
+static const char ordered_output_n = 'd';
+static const char ext_kernel_n = 'e';
+static const char max_read_size_n = 'L';
 
 void
 print_pacbio_default_options()
@@ -58,7 +66,15 @@ print_pacbio_default_options()
 		 << ' '
 		 << '-' << min_size_n << ' ' << min_size_pacbio
 		 << ' '
-		 << '-' << num_partition_files_n << ' ' << num_partition_files
+		 << '-' << num_partition_buffers_n << ' ' << num_partition_buffers
+		 << ' '
+		 << '-' << num_partitions_in_memory_n << ' ' << num_partitions_in_memory
+		 << ' '
+		 << '-' << ordered_output_n << ' ' << ordered_output
+		 << ' '
+		 << '-' << ext_kernel_n << ' ' << ext_kernel
+		 << ' '
+		 << '-' << max_read_size_n << ' ' << max_read_size
 		 << "\n";
 }
 
@@ -78,7 +94,15 @@ void print_nanopore_default_options()
 		 << ' '
 		 << '-' << min_size_n << ' ' << min_size_nanopore
 		 << ' '
-		 << '-' << num_partition_files_n << ' ' << num_partition_files
+		 << '-' << num_partition_buffers_n << ' ' << num_partition_buffers
+		 << ' '
+		 << '-' << num_partitions_in_memory_n << ' ' << num_partitions_in_memory
+		 << ' '
+		 << '-' << ordered_output_n << ' ' << ordered_output
+		 << ' '
+		 << '-' << ext_kernel_n << ' ' << ext_kernel
+		 << ' '
+		 << '-' << max_read_size_n << ' ' << max_read_size
 		 << "\n";
 }
 
@@ -106,9 +130,24 @@ print_usage(const char* prog)
 	
 	cerr << "-" << min_size_n << " <Integer>\t" << "minimum length of corrected sequence" << "\n";
 	
-	cerr << "-" << num_partition_files_n << " <Integer>\t" 
-		 << "number of partition files when partitioning overlap results" 
-		 << " (if < 0, then it will be set to system limit value)"
+	cerr << "-" << num_partition_buffers_n << " <Integer>\t" 
+		 << "number of buffers of 500000 overlaps each kept in memory when partitioning overlap results" 
+		 << "\n";
+	
+	cerr << "-" << num_partitions_in_memory_n << " <Integer>\t" 
+		 << "number of partitions kept in memory, partitions are loaded ahead of the consensus threads" 
+		 << "\n";
+	
+	cerr << "-" << ordered_output_n << " <0/1>\t" 
+		 << "output the corrected reads in read order, the output is then the same for any number of threads" 
+		 << "\n";
+	
+	cerr << "-" << ext_kernel_n << " <0/1>\t" 
+		 << "kernel of the diff aligning the reads to the template: 0 = scalar, 1 = vectorized, with the same alignments" 
+		 << "\n";
+	
+	cerr << "-" << max_read_size_n << " <Integer>\t" 
+		 << "reads longer than this are neither corrected nor used to correct other reads, their number is reported" 
 		 << "\n";
 	
 	cerr << "-" << usage_n << "\t\t" << "print usage info." << "\n";
@@ -138,7 +177,11 @@ init_consensus_options(int tech)
 		t.min_cov               = cov_pacbio;
 		t.min_size              = min_size_pacbio;
 		t.print_usage_info      = print_usage_pacbio;
-		t.num_partition_files 	= num_partition_files;
+		t.num_partition_buffers	= num_partition_buffers;
+		t.num_partitions_in_memory = num_partitions_in_memory;
+		t.ordered_output		= ordered_output;
+		t.ext_kernel			= ext_kernel;
+		t.max_read_size			= max_read_size;
 		t.tech                  = tech_pacbio;
 	} else {
 		t.input_type            = input_type_nanopore;
@@ -152,37 +195,45 @@ init_consensus_options(int tech)
 		t.min_cov               = cov_nanopore;
 		t.min_size              = min_size_nanopore;
 		t.print_usage_info      = print_usage_nanopore;
-		t.num_partition_files	= num_partition_files;
+		t.num_partition_buffers	= num_partition_buffers;
+		t.num_partitions_in_memory = num_partitions_in_memory;
+		t.ordered_output		= ordered_output;
+		t.ext_kernel			= ext_kernel;
+		t.max_read_size			= max_read_size;
 		t.tech                  = tech_nanopore;
 	}
     return t;
 }
 
-int detect_tech(int argc, char* argv[])
-{
-    int t = default_tech;
-    char tech_nstr[64]; tech_nstr[0] = '-'; tech_nstr[1] = tech_n; tech_nstr[2] = '\0';
+static const char* cns_optstring = "i:t:p:r:a:c:l:x:k:w:d:e:L:h";
 
-    for (int i = 0; i < argc; ++i) {
-        if (strcmp(tech_nstr, argv[i]) == 0) {
-            if (i + 1 == argc) {
-                fprintf(stderr, "argument to option '%c' is missing.\n", tech_n);
-                t = -1;
-            }
-			cout << tech_nstr << "\n";
-            if (argv[i + 1][0] == '0') {
-                t = TECH_PACBIO;
-            } else if (argv[i + 1][0] == '1') {
-                t = TECH_NANOPORE;
-            } else {
-                fprintf(stderr, "invalid argument to option '%c': %s\n", tech_n, argv[i + 1]);
-                t = -1;
-            }
-            break;
-        }
-    }
+static int
+parse_tech(const char* arg)
+{
+	if (arg[0] == '0') return TECH_PACBIO;
+	if (arg[0] == '1') return TECH_NANOPORE;
+	fprintf(stderr, "invalid argument to option '%c': %s\n", tech_n, arg);
+	return -1;
+}
 
-    return t;
+// the defaults of the other options depend on the platform, so '-x' is picked
+// up by a first getopt pass before the options are parsed.
+static int 
+detect_tech(int argc, char* argv[])
+{
+	int t = default_tech;
+	int opt_char;
+	opterr = 0;
+	while ((opt_char = getopt(argc, argv, cns_optstring)) != -1) {
+		if (opt_char == tech_n) {
+			t = parse_tech(optarg);
+		} else if (opt_char == '?' && optopt == tech_n) {
+			fprintf(stderr, "argument to option '%c' is missing.\n", tech_n);
+			t = -1;
+		}
+	}
+	optind = 1;
+	return t;
 }
 
 int
@@ -198,7 +249,7 @@ parse_arguments(int argc, char* argv[], ConsensusOptions& t)
 	int opt_char;
     char err_char;
     opterr = 0;
-	while((opt_char = getopt(argc, argv, "i:t:p:r:a:c:l:x:k:h")) != -1) {
+	while((opt_char = getopt(argc, argv, cns_optstring)) != -1) {
 		switch (opt_char) {
 			case input_type_n:
 				if (optarg[0] == '0')
@@ -232,9 +283,29 @@ parse_arguments(int argc, char* argv[], ConsensusOptions& t)
 				t.print_usage_info = true;
 				break;
 			case tech_n:
+				t.tech = parse_tech(optarg);
+				break;
+			case num_partition_buffers_n:
+				t.num_partition_buffers = atoi(optarg);
+				break;
+			case num_partitions_in_memory_n:
+				t.num_partitions_in_memory = atoi(optarg);
+				break;
+			case ordered_output_n:
+				t.ordered_output = atoi(optarg);
 				break;
-			case num_partition_files_n:
-				t.num_partition_files = atoi(optarg);
+			case ext_kernel_n:
+				if (optarg[0] == '0')
+					t.ext_kernel = EXT_KERNEL_DIFF;
+				else if (optarg[0] == '1')
+					t.ext_kernel = EXT_KERNEL_SIMD;
+				else {
+					fprintf(stderr, "invalid argument to option '%c': %s\n", ext_kernel_n, optarg);
+					return 1;
+				}
+				break;
+			case max_read_size_n:
+				t.max_read_size = atoll(optarg);
 				break;
 			case '?':
                 err_char = (char)optopt;
@@ -254,6 +325,16 @@ parse_arguments(int argc, char* argv[], ConsensusOptions& t)
 		std::cerr << "cpu threads must be greater than 0\n";
 		parse_success = false;
 	}
+	if (t.num_partition_buffers <= 0)
+	{
+		std::cerr << "number of partition buffers must be greater than 0\n";
+		parse_success = false;
+	}
+	if (t.num_partitions_in_memory <= 0)
+	{
+		std::cerr << "number of partitions in memory must be greater than 0\n";
+		parse_success = false;
+	}
 	if (t.batch_size <= 0)
 	{
 		std::cerr << "batch size must be greater than 0\n";
@@ -274,6 +355,11 @@ parse_arguments(int argc, char* argv[], ConsensusOptions& t)
 		std::cerr << "sequence size must be >= 0\n";
 		parse_success = false;
 	}
+	if (t.max_read_size <= 0)
+	{
+		std::cerr << "max read size must be greater than 0\n";
+		parse_success = false;
+	}
 	
 	if (argc < 3) return 1;
 	
@@ -298,6 +384,10 @@ print_options(ConsensusOptions& t)
 	cout << "align size:\t" << t.min_align_size << "\n";
 	cout << "cov:\t" << t.min_cov << "\n";
 	cout << "min size:\t" << t.min_size << "\n";
-	cout << "partition files:\t" << t.num_partition_files << "\n";
+	cout << "partition buffers:\t" << t.num_partition_buffers << "\n";
+	cout << "partitions in memory:\t" << t.num_partitions_in_memory << "\n";
+	cout << "ordered output:\t" << t.ordered_output << "\n";
+	cout << "extension kernel:\t" << t.ext_kernel << "\n";
+	cout << "max read size:\t" << t.max_read_size << "\n";
 	cout << "tech:\t" << t.tech << "\n";
 }
@@ -20,7 +20,11 @@ struct ConsensusOptions
     index_t     min_size;
     bool        print_usage_info;
     int         tech;
-	int			num_partition_files;
+	int			num_partition_buffers;
+	int			num_partitions_in_memory;
+	bool		ordered_output;
+	int			ext_kernel;
+	index_t		max_read_size;
 };
 
 void
@@ -5,9 +5,8 @@
 #include <set>
 #include <vector>
 
-#include <unistd.h>
-
 #include "overlaps_store.h"
+#include "../common/overlap_file.h"
 #include "reads_correction_aux.h"
 
 using namespace std;
@@ -40,33 +39,6 @@ subject_is_contained(const M4Record& m4, const double min_cov_ratio)
 	return sm >= ss;
 }
 
-void
-get_qualified_m4record_counts(const char* m4_file_name, const double min_cov_ratio, index_t& num_qualified_records, index_t& num_reads)
-{
-    std::ifstream in;
-    open_fstream(in, m4_file_name, std::ios::in);
-    num_qualified_records = 0;
-    num_reads = -1;
-    index_t num_records = 0;
-    M4Record m4;
-	m4qext(m4) = m4sext(m4) = INVALID_IDX;
-    while (in >> m4)
-    {
-		if (m4qext(m4) == INVALID_IDX || m4sext(m4) == INVALID_IDX)
-		{
-			ERROR("no gapped start position is provided, please make sure that you have run \'meap_pairwise\' with option \'-g 1\'");
-		}
-        ++num_records;
-        if (check_m4record_mapping_range(m4, min_cov_ratio)) ++num_qualified_records;
-        num_reads = std::max(num_reads, m4qid(m4));
-        num_reads = std::max(num_reads, m4sid(m4));
-    }
-    close_fstream(in);
-
-	LOG(stderr, "there are %d overlaps, %d are qualified.", (int)num_records, (int)num_qualified_records);
-    ++num_reads;
-}
-
 void
 get_repeat_reads(const char* m4_file_name, const double min_cov_ratio, const index_t num_reads, set<index_t>& repeat_reads)
 {
@@ -75,11 +47,9 @@ get_repeat_reads(const char* m4_file_name, const double min_cov_ratio, const ind
 	for (int i = 0; i < MaxContained; ++i) cnt_table[i] = i + 1;
 	cnt_table[MaxContained] = MaxContained;
 	vector<char> cnts(num_reads, 0);
-	std::ifstream in;
-    open_fstream(in, m4_file_name, std::ios::in);
+	OverlapFileReader in(m4_file_name, OVLP_RECORD_M4);
 	M4Record m4;
-	m4qext(m4) = m4sext(m4) = INVALID_IDX;
-    while (in >> m4)
+    while (in.read(m4))
     {
 		if (query_is_contained(m4, min_cov_ratio))
 		{
@@ -92,7 +62,6 @@ get_repeat_reads(const char* m4_file_name, const double min_cov_ratio, const ind
 			cnts[sid] = cnt_table[cnts[sid]];
 		}
     }
-    close_fstream(in);
 	
 	for(index_t i = 0; i < num_reads; ++i)
 		if (cnts[i] >= MaxContained) 
@@ -121,22 +90,6 @@ generate_partition_file_name(const char* m4_file_name, const index_t part, std::
     ret += os.str();
 }
 
-idx_t
-get_num_reads(const char* candidates_file)
-{
-	ifstream in;
-	open_fstream(in, candidates_file, ios::in);
-	ExtensionCandidate ec;
-	int max_id = -1;
-	while (in >> ec)
-	{
-		max_id = std::max(ec.qid, max_id);
-		max_id = std::max(ec.sid, max_id);
-	}
-	close_fstream(in);
-	return max_id + 1;
-}
-
 void
 normalise_candidate(ExtensionCandidate& src, ExtensionCandidate& dst, const bool subject_is_target)
 {
@@ -164,62 +117,27 @@ normalise_candidate(ExtensionCandidate& src, ExtensionCandidate& dst, const bool
 	}
 }
 
-int
-fix_file_counts(int num_files) {
-	if (num_files < 0) {
-		num_files = sysconf(_SC_OPEN_MAX) - 10;
-	}
-	return num_files;
-}
-
 void
-partition_candidates(const char* input, const idx_t batch_size, const int min_read_size, int num_files)
+partition_candidates(const char* input, const idx_t batch_size, const int min_read_size, int num_buffers)
 {
 	DynamicTimer dt(__func__);
 	
-	num_files = fix_file_counts(num_files);
-	const idx_t num_reads = get_num_reads(input);
-	const idx_t num_batches = (num_reads + batch_size - 1) / batch_size;
 	string idx_file_name;
 	generate_partition_index_file_name(input, idx_file_name);
 	ofstream idx_file;
 	open_fstream(idx_file, idx_file_name.c_str(), ios::out);
 	
 	ExtensionCandidate ec, nec;
-	PartitionResultsWriter<ExtensionCandidate> prw(num_files);
-	for (idx_t i = 0; i < num_batches; i += num_files) {
-		const idx_t sfid = i;
-		const idx_t efid = min(sfid + num_files, num_batches);
-		const int nf = efid - sfid;
-		const idx_t Lid = batch_size * sfid;
-		const idx_t Rid = batch_size * efid;
-		cout << "Lid = " << Lid
-			 << ", Rid = " << Rid
-			 << "\n";
-		ifstream in;
-		open_fstream(in, input, ios::in);
-		prw.OpenFiles(sfid, efid, input, generate_partition_file_name);
-		
-		while (in >> ec) {
-			if (ec.qsize < min_read_size || ec.ssize < min_read_size) continue;
-			if (ec.qid >= Lid && ec.qid < Rid) {
-				normalise_candidate(ec, nec, false);
-				prw.WriteOneResult((ec.qid - Lid) / batch_size, ec.qid, nec);
-			}
-			if (ec.sid >= Lid && ec.sid < Rid)
-			{
-				normalise_candidate(ec, nec, true);
-				prw.WriteOneResult((ec.sid - Lid) / batch_size, ec.sid, nec);
-			}
-		}
-		for (int k = 0; k < nf; ++k)
-		{
-			if (prw.max_seq_ids[k] == std::numeric_limits<index_t>::min()) continue;
-			idx_file << prw.file_names[k] << "\t" << prw.min_seq_ids[k] << "\t" << prw.max_seq_ids[k] << "\n";
-			fprintf(stderr, "%s contains reads %d --- %d\n", prw.file_names[k].c_str(), (int)prw.min_seq_ids[k], (int)prw.max_seq_ids[k]);
-		}
-		prw.CloseFiles();
+	PartitionResultsWriter<ExtensionCandidate> prw(input, generate_partition_file_name, batch_size, num_buffers);
+	OverlapFileReader in(input, OVLP_RECORD_CAN);
+	while (in.read(ec)) {
+		if (ec.qsize < min_read_size || ec.ssize < min_read_size) continue;
+		normalise_candidate(ec, nec, false);
+		prw.WriteOneResult(ec.qid, nec);
+		normalise_candidate(ec, nec, true);
+		prw.WriteOneResult(ec.sid, nec);
 	}
+	prw.Finish(idx_file);
 	close_fstream(idx_file);
 }
 
@@ -346,15 +264,10 @@ partition_m4records(const char* m4_file_name,
 					const double min_cov_ratio, 
 					const index_t batch_size, 
 					const int min_read_size,
-				    int num_files)
+				    int num_buffers)
 {
 	DynamicTimer dtimer(__func__);
 	
-	num_files = fix_file_counts(num_files);
-    index_t num_reads, num_qualified_records;
-    get_qualified_m4record_counts(m4_file_name, min_cov_ratio, num_qualified_records, num_reads);
-	set<index_t> repeat_reads;
-    const index_t num_batches = (num_reads + batch_size - 1) / batch_size;
     std::string idx_file_name;
     generate_partition_index_file_name(m4_file_name, idx_file_name);
     std::ofstream idx_file;
@@ -362,49 +275,30 @@ partition_m4records(const char* m4_file_name,
 
     M4Record m4, nm4;
 	ExtensionCandidate ec;
-    PartitionResultsWriter<ExtensionCandidate> prw(num_files);
-    for (index_t i = 0; i < num_batches; i += num_files)
+    index_t num_records = 0, num_qualified_records = 0;
+    PartitionResultsWriter<ExtensionCandidate> prw(m4_file_name, generate_partition_file_name, batch_size, num_buffers);
+    OverlapFileReader in(m4_file_name, OVLP_RECORD_M4);
+    while (in.read(m4))
     {
-        const index_t sfid = i;
-        const index_t efid = std::min(sfid + num_files, num_batches);
-        const int nf = efid - sfid;
-        const index_t L = batch_size * sfid;
-        const index_t R = batch_size * efid;
-        std::ifstream in;
-        open_fstream(in, m4_file_name, std::ios::in);
-		prw.OpenFiles(sfid, efid, m4_file_name, generate_partition_file_name);
-
-        while (in >> m4)
-        {
-			if (m4qsize(m4) < min_read_size || m4ssize(m4) < min_read_size) continue;
-            if (!check_m4record_mapping_range(m4, min_cov_ratio)) continue;
-			if (repeat_reads.find(m4qid(m4)) != repeat_reads.end()
-					||
-					repeat_reads.find(m4sid(m4)) != repeat_reads.end()) continue;
-			
-            if (m4qid(m4) >= L && m4qid(m4) < R)
-            {
-                normalize_m4record(m4, false, nm4);
-				m4_to_candidate(nm4, ec);
-                prw.WriteOneResult((m4qid(m4) - L) / batch_size, m4qid(m4), ec);
-            }
-            if (m4sid(m4) >= L && m4sid(m4) < R)
-            {
-                normalize_m4record(m4, true, nm4);
-				m4_to_candidate(nm4, ec);
-                prw.WriteOneResult((m4sid(m4) - L) / batch_size, m4sid(m4), ec);
-            }
-        }
-
-        for (int k = 0; k < nf; ++k)
-        {
-            if (prw.max_seq_ids[k] == std::numeric_limits<index_t>::min()) continue;
-            idx_file << prw.file_names[k] << "\t" << prw.min_seq_ids[k] << "\t" << prw.max_seq_ids[k] << "\n";
-			fprintf(stderr, "%s contains reads %d --- %d\n", prw.file_names[k].c_str(), (int)prw.min_seq_ids[k], (int)prw.max_seq_ids[k]);
-        }
-
-        prw.CloseFiles();
+		if (m4qext(m4) == INVALID_IDX || m4sext(m4) == INVALID_IDX)
+		{
+			ERROR("no gapped start position is provided, please make sure that you have run \'meap_pairwise\' with option \'-g 1\'");
+		}
+        ++num_records;
+        if (!check_m4record_mapping_range(m4, min_cov_ratio)) continue;
+        ++num_qualified_records;
+		if (m4qsize(m4) < min_read_size || m4ssize(m4) < min_read_size) continue;
+		
+        normalize_m4record(m4, false, nm4);
+		m4_to_candidate(nm4, ec);
+        prw.WriteOneResult(m4qid(m4), ec);
+        normalize_m4record(m4, true, nm4);
+		m4_to_candidate(nm4, ec);
+        prw.WriteOneResult(m4sid(m4), ec);
     }
+	LOG(stderr, "there are %d overlaps, %d are qualified.", (int)num_records, (int)num_qualified_records);
+
+    prw.Finish(idx_file);
     close_fstream(idx_file);
 }
 
@@ -16,13 +16,13 @@ partition_m4records(const char* m4_file_name,
 					const double min_cov_ratio, 
 					const index_t batch_size, 
 					const int min_read_size,
-				    int num_files);
+				    int num_buffers);
 
 void
 partition_candidates(const char* input, 
 					 const idx_t batch_size, 
 					 const int min_read_size,
-					 int num_files);
+					 int num_buffers);
 
 struct PartitionFileInfo
 {
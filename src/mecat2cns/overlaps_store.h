@@ -4,10 +4,15 @@
 #include <fstream>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "../common/defs.h"
 #include "../common/pod_darr.h"
 
+// distributes results into the partition files of batch_size reads each in a single pass over the input.
+// results are kept in one buffer per partition, the buffers together hold at most
+// max_num_buffers * kStoreSize results. when they are full the largest buffer is appended to its file,
+// so no more than one file is open at a time however many partitions there are.
 template <class T>
 class PartitionResultsWriter
 {
@@ -15,94 +20,88 @@ public:
 	typedef void (*file_name_generator)(const char* prefix, const idx_t id, std::string& name);
 	
 public:
-	PartitionResultsWriter(const int max_num_files)
+	PartitionResultsWriter(const char* prefix, file_name_generator fng, const idx_t batch_size, const int max_num_buffers)
+		: prefix(prefix), fng(fng), batch_size(batch_size), num_buffered(0)
 	{
-		file_is_open = 0;
-		num_open_files = 0;
-		MaxNumFiles = max_num_files;
-		results = new PODArray<T>[MaxNumFiles];
-		files = new std::ofstream[MaxNumFiles];
-		file_names = new std::string[MaxNumFiles];
-		min_seq_ids = new idx_t[MaxNumFiles];
-		max_seq_ids = new idx_t[MaxNumFiles];
-		for (int i = 0; i < MaxNumFiles; ++i) results[i].reserve(kStoreSize);
+		r_assert(batch_size > 0);
+		r_assert(max_num_buffers > 0);
+		max_num_buffered = (idx_t)max_num_buffers * kStoreSize;
 	}
 	
 	~PartitionResultsWriter()
 	{
-		delete[] results;
-		delete[] files;
-		delete[] file_names;
-		delete[] min_seq_ids;
-		delete[] max_seq_ids;
+		for (size_t i = 0; i < results.size(); ++i) delete results[i];
 	}
 	
-	void OpenFiles(const idx_t sfid, const idx_t efid, const std::string& prefix, file_name_generator fng)
+	void WriteOneResult(const idx_t seq_id, const T& r)
 	{
-		if (file_is_open) CloseFiles();
-		
-		const int nf = efid - sfid;
-        if (nf == 0) return;
-        for (int i = 0; i < nf; ++i)
-        {
-            fng(prefix.data(), i + sfid, file_names[i]);
-            open_fstream(files[i], file_names[i].c_str(), std::ios::binary);
-            min_seq_ids[i] = std::numeric_limits<index_t>::max();
-            max_seq_ids[i] = std::numeric_limits<index_t>::min();
-			results[i].clear();
-        }
-        num_open_files = nf;
-        file_is_open = true;
+		const size_t fid = seq_id / batch_size;
+		if (fid >= results.size())
+		{
+			while (results.size() <= fid) results.push_back(new PODArray<T>);
+			file_is_created.resize(fid + 1, false);
+			min_seq_ids.resize(fid + 1, std::numeric_limits<index_t>::max());
+			max_seq_ids.resize(fid + 1, std::numeric_limits<index_t>::min());
+		}
+		min_seq_ids[fid] = std::min(min_seq_ids[fid], seq_id);
+		max_seq_ids[fid] = std::max(max_seq_ids[fid], seq_id);
+		results[fid]->push_back(r);
+		if (++num_buffered >= max_num_buffered) FlushLargest();
 	}
 	
-	void CloseFiles()
+	// flushes all the buffers and lists the non-empty partition files in idx_file
+	void Finish(std::ostream& idx_file)
 	{
-		if (!file_is_open) return;
-		for (int i = 0; i < num_open_files; ++i)
+		std::string file_name;
+		for (size_t i = 0; i < results.size(); ++i)
 		{
-			if (results[i].size())
-			{
-				char* buf = (char*)results[i].data();
-				std::streamsize s = sizeof(T) * results[i].size();
-				files[i].write(buf, s);
-			}
+			if (results[i]->size()) Flush(i);
+			if (max_seq_ids[i] == std::numeric_limits<index_t>::min()) continue;
+			fng(prefix, i, file_name);
+			idx_file << file_name << "\t" << min_seq_ids[i] << "\t" << max_seq_ids[i] << "\n";
+			fprintf(stderr, "%s contains reads %d --- %d\n", file_name.c_str(), (int)min_seq_ids[i], (int)max_seq_ids[i]);
 		}
-        for (int i = 0; i < num_open_files; ++i) close_fstream(files[i]);
-        file_is_open = false;
-        num_open_files = 0;
 	}
 	
-	void WriteOneResult(const int fid, const idx_t seq_id, const T& r)
+private:
+	void FlushLargest()
 	{
-		if (fid >= num_open_files) {
-			std::cout << "fid = " << fid
-					  << ", num_open_files = "
-					  << num_open_files
-					  << "\n";
-		}
-		r_assert(fid < num_open_files);
-		min_seq_ids[fid] = std::min(min_seq_ids[fid], seq_id);
-        max_seq_ids[fid] = std::max(max_seq_ids[fid], seq_id);
-		results[fid].push_back(r);
-		if (results[fid].size() == kStoreSize)
-		{
-			char* buf = (char*)results[fid].data();
-			std::streamsize s = sizeof(T) * results[fid].size();
-			files[fid].write(buf, s);
-			results[fid].clear();
-		}
+		size_t fid = 0;
+		for (size_t i = 1; i < results.size(); ++i)
+			if (results[i]->size() > results[fid]->size()) fid = i;
+		Flush(fid);
+	}
+	
+	void Flush(const size_t fid)
+	{
+		std::string file_name;
+		fng(prefix, fid, file_name);
+		std::ofstream out;
+		// the first write of a partition truncates what an earlier run may have left
+		std::ios::openmode mode = std::ios::binary | (file_is_created[fid] ? std::ios::app : std::ios::trunc);
+		open_fstream(out, file_name.c_str(), mode);
+		out.write((const char*)results[fid]->data(), sizeof(T) * results[fid]->size());
+		close_fstream(out);
+		file_is_created[fid] = true;
+		num_buffered -= results[fid]->size();
+		// give the memory back, the partition may not receive much more
+		delete results[fid];
+		results[fid] = new PODArray<T>;
 	}
 	
 public:
-	int MaxNumFiles;
 	static const int kStoreSize = 500000;
-	PODArray<T>* results;
-	bool file_is_open;
-	int num_open_files;
-	std::ofstream* files;
-	std::string* file_names;
-	idx_t* min_seq_ids;
-	idx_t* max_seq_ids;
+	
+private:
+	const char* prefix;
+	file_name_generator fng;
+	idx_t batch_size;
+	idx_t num_buffered;
+	idx_t max_num_buffered;
+	std::vector<PODArray<T>*> results;
+	std::vector<bool> file_is_created;
+	std::vector<idx_t> min_seq_ids;
+	std::vector<idx_t> max_seq_ids;
 };
 
 template <class T>
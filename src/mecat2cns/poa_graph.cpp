@@ -0,0 +1,443 @@
+// Copyright (c) 2011-2015, Pacific Biosciences of California, Inc.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted (subject to the limitations in the
+// disclaimer below) provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following
+// disclaimer in the documentation and/or other materials provided
+// with the distribution.
+//
+// * Neither the name of Pacific Biosciences nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY PACIFIC
+// BIOSCIENCES AND ITS CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL PACIFIC BIOSCIENCES OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+// USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+// OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+
+
+#include "poa_graph.h"
+
+#include <cfloat>
+#include <cstddef>
+
+#include "../common/defs.h"
+
+namespace ns_meap_cns {
+
+void PoaGraph::reset(const int blen) {
+    _nodes.clear();
+    _edges.clear();
+    // enter node, backbone, exit node, chained by edges of count 0
+    _enterNode = addNode('^', true, 0, 0);
+    for (int i = 1; i <= blen; ++i)
+        addNode('N', true, 1, i);
+    _exitNode = addNode('$', true, 0, 0);
+    for (int i = 0; i <= blen; ++i)
+        newEdge(i, i + 1);
+}
+
+int PoaGraph::addNode(const char base, const bool backbone, const int weight, const int bbNode) {
+    const int n = _nodes.size();
+    Node node;
+    node.base = base;
+    node.backbone = backbone;
+    node.coverage = 0;
+    node.weight = weight;
+    node.bbNode = bbNode;
+    _nodes.push_back(node);
+    if (n < (int)_outEdges.size()) {
+        _outEdges[n].clear();
+        _inEdges[n].clear();
+    } else {
+        _outEdges.push_back(std::vector<int>());
+        _inEdges.push_back(std::vector<int>());
+    }
+    return n;
+}
+
+// a new edge from u to v of count 0, put last in the edge lists of u and v
+int PoaGraph::newEdge(const int u, const int v) {
+    const int e = _edges.size();
+    Edge edge;
+    edge.source = u;
+    edge.target = v;
+    edge.count = 0;
+    edge.visited = false;
+    _edges.push_back(edge);
+    _outEdges[u].push_back(e);
+    _inEdges[v].push_back(e);
+    return e;
+}
+
+void PoaGraph::addAln(const std::string& qstr, const std::string& tstr, const int start)
+{
+    const char kGapTag = '-';
+    const size_t alnSize = qstr.size();
+    // track the position on the backbone
+    int bbPos = start;
+    int prevNode = _enterNode;
+    for (size_t i = 0; i < alnSize; ++i)
+    {
+        const char queryBase = qstr[i];
+        const char targetBase = tstr[i];
+        if (queryBase == kGapTag && targetBase == kGapTag) continue;
+
+        d_assert(bbPos <= _exitNode);
+        const int currNode = bbPos;
+        // match
+        if (queryBase == targetBase)
+        {
+            Node& bb = _nodes[_nodes[currNode].bbNode];
+            bb.coverage++;
+            // Note: for empty backbones
+            bb.base = targetBase;
+            _nodes[currNode].weight++;
+            addEdge(prevNode, currNode);
+            bbPos++;
+            prevNode = currNode;
+        }
+        // query deletion
+        else if (queryBase == kGapTag)
+        {
+            Node& bb = _nodes[_nodes[currNode].bbNode];
+            bb.coverage++;
+            // Note: for empty backbones
+            bb.base = targetBase;
+            bbPos++;
+        }
+        // query insertion
+        else if (targetBase == kGapTag)
+        {
+            const int newNode = addNode(queryBase, false, 1, bbPos);
+            addEdge(prevNode, newNode);
+            prevNode = newNode;
+        }
+    }
+    addEdge(prevNode, _exitNode);
+}
+
+// increments the edges from u to v, adds one if there is none
+void PoaGraph::addEdge(const int u, const int v) {
+    bool edgeExists = false;
+    const std::vector<int>& in = _inEdges[v];
+    for (size_t i = 0; i < in.size(); ++i) {
+        Edge& e = _edges[in[i]];
+        if (e.source == u) {
+            e.count++;
+            edgeExists = true;
+        }
+    }
+    if (!edgeExists) {
+        const int e = newEdge(u, v);
+        _edges[e].count++;
+    }
+}
+
+// the first edge from u to v, -1 if there is none
+int PoaGraph::findEdge(const int u, const int v) const {
+    const std::vector<int>& out = _outEdges[u];
+    for (size_t i = 0; i < out.size(); ++i)
+        if (_edges[out[i]].target == v) return out[i];
+    return -1;
+}
+
+// removes the edges of n, keeping the order of the other edges
+void PoaGraph::clearNode(const int n) {
+    std::vector<int>& out = _outEdges[n];
+    for (size_t i = 0; i < out.size(); ++i) {
+        std::vector<int>& in = _inEdges[_edges[out[i]].target];
+        size_t k = 0;
+        for (size_t j = 0; j < in.size(); ++j)
+            if (_edges[in[j]].source != n) in[k++] = in[j];
+        in.resize(k);
+    }
+    std::vector<int>& in = _inEdges[n];
+    for (size_t i = 0; i < in.size(); ++i) {
+        std::vector<int>& sout = _outEdges[_edges[in[i]].source];
+        size_t k = 0;
+        for (size_t j = 0; j < sout.size(); ++j)
+            if (_edges[sout[j]].target != n) sout[k++] = sout[j];
+        sout.resize(k);
+    }
+    out.clear();
+    in.clear();
+}
+
+void PoaGraph::mergeNodes() {
+    _queue.clear();
+    _queue.push_back(_enterNode);
+    for (size_t head = 0; head < _queue.size(); ++head) {
+        const int u = _queue[head];
+        mergeInNodes(u);
+        mergeOutNodes(u);
+
+        const std::vector<int>& out = _outEdges[u];
+        for (size_t i = 0; i < out.size(); ++i) {
+            Edge& e = _edges[out[i]];
+            e.visited = true;
+            const int v = e.target;
+            const std::vector<int>& in = _inEdges[v];
+            int notVisited = 0;
+            for (size_t j = 0; j < in.size(); ++j)
+                if (!_edges[in[j]].visited) notVisited++;
+
+            // move onto the target node after we visit all incoming edges for
+            // the target node
+            if (notVisited == 0)
+                _queue.push_back(v);
+        }
+    }
+}
+
+// the groups of nodes are visited in the order of their bases, as the map of
+// AlnGraphBoost does. _groups is used as a stack by the recursive calls.
+void PoaGraph::mergeInNodes(const int n) {
+    const size_t gb = _groups.size();
+    // neighboring nodes that can be merged
+    for (size_t i = 0; i < _inEdges[n].size(); ++i) {
+        const int inNode = _edges[_inEdges[n][i]].source;
+        if (_outEdges[inNode].size() == 1)
+            _groups.push_back(inNode);
+    }
+    const size_t ge = _groups.size();
+
+    int prevBase = -1;
+    while (true) {
+        int base = 256;
+        for (size_t i = gb; i < ge; ++i) {
+            const int b = (unsigned char)_nodes[_groups[i]].base;
+            if (b > prevBase && b < base) base = b;
+        }
+        if (base == 256) break;
+        prevBase = base;
+
+        int an = -1, groupSize = 0;
+        for (size_t i = gb; i < ge; ++i)
+            if ((unsigned char)_nodes[_groups[i]].base == base) {
+                if (an == -1) an = _groups[i];
+                groupSize++;
+            }
+        if (groupSize <= 1)
+            continue;
+
+        // Accumulate out edge information
+        const int anOut = _outEdges[an][0];
+        for (size_t i = gb; i < ge; ++i) {
+            const int m = _groups[i];
+            if (m == an || (unsigned char)_nodes[m].base != base) continue;
+            _edges[anOut].count += _edges[_outEdges[m][0]].count;
+            _nodes[an].weight += _nodes[m].weight;
+        }
+
+        // Accumulate in edge information, merges nodes
+        for (size_t i = gb; i < ge; ++i) {
+            const int m = _groups[i];
+            if (m == an || (unsigned char)_nodes[m].base != base) continue;
+            for (size_t j = 0; j < _inEdges[m].size(); ++j) {
+                const Edge inEdge = _edges[_inEdges[m][j]];
+                const int e = findEdge(inEdge.source, an);
+                if (e >= 0) {
+                    _edges[e].count += inEdge.count;
+                } else {
+                    const int f = newEdge(inEdge.source, an);
+                    _edges[f].count = inEdge.count;
+                    _edges[f].visited = inEdge.visited;
+                }
+            }
+            clearNode(m);
+        }
+        mergeInNodes(an);
+    }
+    _groups.resize(gb);
+}
+
+void PoaGraph::mergeOutNodes(const int n) {
+    const size_t gb = _groups.size();
+    for (size_t i = 0; i < _outEdges[n].size(); ++i) {
+        const int outNode = _edges[_outEdges[n][i]].target;
+        if (_inEdges[outNode].size() == 1)
+            _groups.push_back(outNode);
+    }
+    const size_t ge = _groups.size();
+
+    int prevBase = -1;
+    while (true) {
+        int base = 256;
+        for (size_t i = gb; i < ge; ++i) {
+            const int b = (unsigned char)_nodes[_groups[i]].base;
+            if (b > prevBase && b < base) base = b;
+        }
+        if (base == 256) break;
+        prevBase = base;
+
+        int an = -1, groupSize = 0;
+        for (size_t i = gb; i < ge; ++i)
+            if ((unsigned char)_nodes[_groups[i]].base == base) {
+                if (an == -1) an = _groups[i];
+                groupSize++;
+            }
+        if (groupSize <= 1)
+            continue;
+
+        // Accumulate inner edge information
+        const int anIn = _inEdges[an][0];
+        for (size_t i = gb; i < ge; ++i) {
+            const int m = _groups[i];
+            if (m == an || (unsigned char)_nodes[m].base != base) continue;
+            _edges[anIn].count += _edges[_inEdges[m][0]].count;
+            _nodes[an].weight += _nodes[m].weight;
+        }
+
+        // Accumulate and merge outer edge information
+        for (size_t i = gb; i < ge; ++i) {
+            const int m = _groups[i];
+            if (m == an || (unsigned char)_nodes[m].base != base) continue;
+            for (size_t j = 0; j < _outEdges[m].size(); ++j) {
+                const Edge outEdge = _edges[_outEdges[m][j]];
+                const int e = findEdge(an, outEdge.target);
+                if (e >= 0) {
+                    _edges[e].count += outEdge.count;
+                } else {
+                    const int f = newEdge(an, outEdge.target);
+                    _edges[f].count = outEdge.count;
+                    _edges[f].visited = outEdge.visited;
+                }
+            }
+            clearNode(m);
+        }
+    }
+    _groups.resize(gb);
+}
+
+// the best path from the enter node to the exit node into _path
+void PoaGraph::bestPath() {
+    for (size_t i = 0; i < _edges.size(); ++i)
+        _edges[i].visited = false;
+    _nodeScore.assign(_nodes.size(), 0.0f);
+    _bestOutEdge.assign(_nodes.size(), -1);
+
+    // start at the end and make our way backwards
+    _queue.clear();
+    _queue.push_back(_exitNode);
+    for (size_t head = 0; head < _queue.size(); ++head) {
+        const int n = _queue[head];
+
+        bool bestEdgeFound = false;
+        float bestScore = -FLT_MAX;
+        int bestEdge = -1;
+        const std::vector<int>& out = _outEdges[n];
+        for (size_t i = 0; i < out.size(); ++i) {
+            const Edge& e = _edges[out[i]];
+            const Node& outNode = _nodes[e.target];
+            float newScore, score = _nodeScore[e.target];
+            if (outNode.backbone && outNode.weight == 1) {
+                newScore = score - 10.0f;
+            } else {
+                const Node& bbNode = _nodes[outNode.bbNode];
+                newScore = e.count - bbNode.coverage*0.5f + score;
+            }
+
+            if (newScore > bestScore) {
+                bestScore = newScore;
+                bestEdge = out[i];
+                bestEdgeFound = true;
+            }
+        }
+
+        if (bestEdgeFound) {
+            _nodeScore[n] = bestScore;
+            _bestOutEdge[n] = bestEdge;
+        }
+
+        const std::vector<int>& in = _inEdges[n];
+        for (size_t i = 0; i < in.size(); ++i) {
+            Edge& inEdge = _edges[in[i]];
+            inEdge.visited = true;
+            const int inNode = inEdge.source;
+            const std::vector<int>& inOut = _outEdges[inNode];
+            int notVisited = 0;
+            for (size_t j = 0; j < inOut.size(); ++j)
+                if (!_edges[inOut[j]].visited) notVisited++;
+
+            // move onto the target node after we visit all incoming edges for
+            // the target node
+            if (notVisited == 0)
+                _queue.push_back(inNode);
+        }
+    }
+
+    // construct the final best path
+    _path.clear();
+    int prev = _enterNode;
+    while (true) {
+        _path.push_back(prev);
+        if (_bestOutEdge[prev] == -1) break;
+        prev = _edges[_bestOutEdge[prev]].target;
+    }
+}
+
+void PoaGraph::consensus(const int minWeight, std::string& cns_seq) {
+    // get the best scoring path
+    bestPath();
+
+    // track the longest consensus path meeting minimum weight
+    const char enterBase = _nodes[_enterNode].base;
+    const char exitBase = _nodes[_exitNode].base;
+    int offs = 0, bestOffs = 0, length = 0, idx = 0;
+    bool metWeight = false;
+    for (size_t i = 0; i < _path.size(); ++i) {
+        const Node& n = _nodes[_path[i]];
+        if (n.base == enterBase || n.base == exitBase)
+            continue;
+
+        // initial beginning of minimum weight section
+        if (!metWeight && n.weight >= minWeight) {
+            offs = idx;
+            metWeight = true;
+        } else if (metWeight && n.weight < minWeight) {
+            // concluded minimum weight section, update if longest seen so far
+            if ((idx - offs) > length) {
+                bestOffs = offs;
+                length = idx - offs;
+            }
+            metWeight = false;
+        }
+        idx++;
+    }
+
+    // include end of sequence
+    if (metWeight && (idx - offs) > length) {
+        bestOffs = offs;
+        length = idx - offs;
+    }
+
+    cns_seq.clear();
+    for (size_t i = 0, k = 0; i < _path.size() && (int)k < bestOffs + length; ++i) {
+        const Node& n = _nodes[_path[i]];
+        if (n.base == enterBase || n.base == exitBase)
+            continue;
+        if ((int)k >= bestOffs) cns_seq += n.base;
+        ++k;
+    }
+}
+
+} // namespace ns_meap_cns
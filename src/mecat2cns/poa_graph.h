@@ -0,0 +1,112 @@
+// Copyright (c) 2011-2015, Pacific Biosciences of California, Inc.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted (subject to the limitations in the
+// disclaimer below) provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following
+// disclaimer in the documentation and/or other materials provided
+// with the distribution.
+//
+// * Neither the name of Pacific Biosciences nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+// GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY PACIFIC
+// BIOSCIENCES AND ITS CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL PACIFIC BIOSCIENCES OR ITS
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+// USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+// OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+// SUCH DAMAGE.
+
+
+
+#ifndef POA_GRAPH_H
+#define POA_GRAPH_H
+
+#include <string>
+#include <vector>
+
+namespace ns_meap_cns {
+
+/// Alignment graph of the alignments to the backbone of an indel region, and
+/// the consensus along its best path. The algorithm is the one of pbdagcon's
+/// AlnGraphBoost; the nodes, the edges and the edge lists of the nodes are kept
+/// in flat vectors that are reused from one region to the next, so that a
+/// thread builds all its graphs without allocating once the vectors have grown.
+///
+/// The edge lists keep the order in which the edges were added and removed, as
+/// a boost adjacency_list with vecS edge lists does, so that ties are broken the
+/// same way and the consensus is the one AlnGraphBoost gives.
+class PoaGraph {
+public:
+    /// Starts a new graph of a backbone of blen bases. The bases are filled in
+    /// as the alignments are added.
+    void reset(const int blen);
+
+    /// Adds the alignment of qstr to tstr, tstr starting at backbone base start (1-based).
+    void addAln(const std::string& qstr, const std::string& tstr, const int start);
+
+    /// Collapses the degenerate nodes. Must be called before consensus().
+    void mergeNodes();
+
+    /// The longest stretch of the best path whose bases have weight minWeight at least.
+    void consensus(const int minWeight, std::string& cns_seq);
+
+private:
+    struct Node {
+        char base;
+        bool backbone;
+        int coverage;
+        int weight;
+        int bbNode; ///< backbone node of the position, 0 for the enter and exit nodes
+    };
+
+    struct Edge {
+        int source;
+        int target;
+        int count;
+        bool visited;
+    };
+
+    int addNode(const char base, const bool backbone, const int weight, const int bbNode);
+    int newEdge(const int u, const int v);
+    void addEdge(const int u, const int v);
+    int findEdge(const int u, const int v) const;
+    void clearNode(const int n);
+    void mergeInNodes(const int n);
+    void mergeOutNodes(const int n);
+    void bestPath();
+
+private:
+    std::vector<Node> _nodes;
+    std::vector<Edge> _edges;
+    std::vector< std::vector<int> > _outEdges;
+    std::vector< std::vector<int> > _inEdges;
+    int _enterNode;
+    int _exitNode;
+
+    std::vector<int> _queue;
+    std::vector<int> _groups;
+    std::vector<float> _nodeScore;
+    std::vector<int> _bestOutEdge;
+    std::vector<int> _path;
+};
+
+} // namespace ns_meap_cns
+
+#endif // POA_GRAPH_H
@@ -1,9 +1,12 @@
 #include "reads_correction_aux.h"
 
-void normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size, std::string& qnorm, std::string& tnorm, const bool push)
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+index_t normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size, char* qnorm, char* tnorm, const bool push)
 {
-    qnorm.clear();
-    tnorm.clear();
+    index_t n = 0;
     const char kGap = '-';
 
 #ifndef NDEBUG
@@ -23,16 +26,18 @@ void normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size,
         const char qc = qstr[i];
         const char tc = tstr[i];
         if (qc != tc && qc != kGap && tc != kGap)
-        { qnorm += kGap; qnorm += qc; tnorm += tc; tnorm += kGap; }
+        { qnorm[n] = kGap; qnorm[n + 1] = qc; tnorm[n] = tc; tnorm[n + 1] = kGap; n += 2; }
         else
-        { qnorm += qc; tnorm += tc; }
+        { qnorm[n] = qc; tnorm[n] = tc; ++n; }
     }
+    qnorm[n] = '\0';
+    tnorm[n] = '\0';
 
     // push gaps to the right, but not pass the end
     if (push)
     {
-        index_t qlen = qnorm.size();
-        index_t tlen = tnorm.size();
+        index_t qlen = n;
+        index_t tlen = n;
         for (index_t i = 0; i < qlen - 1; ++i)
         {
             // push target gaps
@@ -65,51 +70,238 @@ void normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size,
             }
         }
     }
-    r_assert(qnorm.size() == tnorm.size());
-
 #ifndef NDEBUG
     int qcnt2 = 0, tcnt2 = 0;
-    for (std::string::const_iterator citer = qnorm.begin(); citer != qnorm.end(); ++citer)
-        if ((*citer) != kGap) ++qcnt2;
-    for (std::string::const_iterator citer = tnorm.begin(); citer != tnorm.end(); ++citer)
-        if ((*citer) != kGap) ++tcnt2;
+    for (index_t i = 0; i < n; ++i)
+    {
+        if (qnorm[i] != kGap) ++qcnt2;
+        if (tnorm[i] != kGap) ++tcnt2;
+    }
     d_assert(qcnt == qcnt2);
     d_assert(tcnt == tcnt2);
 #endif
+
+    return n;
+}
+
+CnsArena::CnsArena(const size_t block_size) : block_size_(block_size), used_(0)
+{
+	add_block(block_size_);
+}
+
+CnsArena::~CnsArena()
+{
+	for (size_t i = 0; i < blocks_.size(); ++i) safe_free(blocks_[i].data);
+}
+
+void CnsArena::add_block(const size_t size)
+{
+	Block b;
+	safe_malloc(b.data, char, size);
+	b.size = size;
+	blocks_.push_back(b);
+	used_ = 0;
+}
+
+char* CnsArena::alloc(const size_t size)
+{
+	if (used_ + size > blocks_.back().size) add_block(std::max(block_size_, size));
+	char* p = blocks_.back().data + used_;
+	used_ += size;
+	return p;
+}
+
+void CnsArena::trim(char* p, const size_t size)
+{
+	r_assert(p >= blocks_.back().data && p + size <= blocks_.back().data + used_);
+	used_ = p - blocks_.back().data + size;
+}
+
+void CnsArena::clear()
+{
+	// a read that did not fit in one block gets a block as large as all of them,
+	// so that the next reads of its size are served from a single block
+	if (blocks_.size() > 1)
+	{
+		size_t size = 0;
+		for (size_t i = 0; i < blocks_.size(); ++i)
+		{
+			size += blocks_[i].size;
+			safe_free(blocks_[i].data);
+		}
+		blocks_.clear();
+		block_size_ = size;
+		add_block(block_size_);
+	}
+	used_ = 0;
+}
+
+CnsAln& CnsAlns::add_aln(const int soff, const int send, const char* qstr, const char* tstr, const index_t aln_size)
+{
+	r_assert(num_alns_ < MAX_CNS_OVLPS);
+	// the normalized strings take at most 2 * aln_size + 1 characters each,
+	// the target string is moved next to the query string once its size is known
+	const size_t max_size = 2 * aln_size + 1;
+	char* qnorm = arena_.alloc(2 * max_size);
+	char* tnorm = qnorm + max_size;
+	const index_t n = normalize_gaps(qstr, tstr, aln_size, qnorm, tnorm, true);
+	memmove(qnorm + n + 1, tnorm, n + 1);
+	arena_.trim(qnorm, 2 * (n + 1));
+	
+	CnsAln& a = cns_alns_[num_alns_++];
+	a.soff = soff;
+	a.send = send;
+	a.aln_idx = 0;
+	a.aln_size = n;
+	a.qaln = qnorm;
+	a.saln = qnorm + n + 1;
+	return a;
+}
+
+CnsVoteTable::CnsVoteTable()
+	: base_(NULL), mat_(NULL), ins_(NULL), del_(NULL), capacity_(0)
+{
+}
+
+CnsVoteTable::~CnsVoteTable()
+{
+	safe_free(base_);
+	safe_free(mat_);
+	safe_free(ins_);
+	safe_free(del_);
 }
 
-struct CmpExtensionCandidateBySid
+void CnsVoteTable::reset(const index_t size)
 {
-	bool operator()(const ExtensionCandidate& a, const ExtensionCandidate& b)
+	if (size > capacity_)
 	{
-		return a.sid < b.sid;
+		// the votes are cleared below, so the old ones are not copied
+		capacity_ = std::max(size, 2 * capacity_);
+		safe_free(base_);
+		safe_free(mat_);
+		safe_free(ins_);
+		safe_free(del_);
+		safe_malloc(base_, char, capacity_);
+		safe_malloc(mat_, uint16_t, capacity_);
+		safe_malloc(ins_, uint16_t, capacity_);
+		safe_malloc(del_, uint16_t, capacity_);
 	}
-};
-
-void
-build_cns_thrd_data_can(ExtensionCandidate* ec_list, 
-						const int nec,
-						const idx_t min_rid,
-						const idx_t max_rid,
-						ReadsCorrectionOptions* prco,
-						PackedDB* reads,
-						std::ostream* out,
-					    ConsensusThreadData** ppctd)
-{
-	const index_t num_reads = max_rid - min_rid + 1;
-	const int num_threads = prco->num_threads;
-    const index_t num_reads_per_thread = (num_reads + num_threads - 1) / num_threads;
-	std::sort(ec_list, ec_list + nec, CmpExtensionCandidateBySid());
-	idx_t max_id = min_rid;
-	idx_t i = 0, j;
-	int tid = 0;
-	while (i < nec)
+	memset(base_, 'N', size);
+	memset(mat_, 0, sizeof(uint16_t) * size);
+	memset(ins_, 0, sizeof(uint16_t) * size);
+	memset(del_, 0, sizeof(uint16_t) * size);
+}
+
+static inline void
+add_vote(uint16_t& cnt)
+{
+	cnt += (cnt != CNS_MAX_VOTES);
+}
+
+void CnsVoteTable::add_aln(const char* qaln, const char* saln, const index_t aln_size, index_t soff)
+{
+	const char kGap = '-';
+	index_t i = 0;
+	while (i < aln_size)
 	{
-		max_id += num_reads_per_thread;
-		j = i + 1;
-		while (j < nec && ec_list[j].sid < max_id) ++j;
-		ppctd[tid] = new ConsensusThreadData(prco, tid, reads, ec_list + i, j - i, out);
-		++tid;
-		i = j;
+		// a normalized alignment has no mismatches, so up to the next gap in the
+		// template every column is a match or an insertion of the template base
+#ifdef __SSE2__
+		const __m128i gap = _mm_set1_epi8(kGap);
+		const __m128i one = _mm_set1_epi16(1);
+		while (i + 16 <= aln_size)
+		{
+			const __m128i s = _mm_loadu_si128((const __m128i*)(saln + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, gap))) break;
+			const __m128i q = _mm_loadu_si128((const __m128i*)(qaln + i));
+			const __m128i mat = _mm_cmpeq_epi8(q, s);
+			const __m128i ins = _mm_cmpeq_epi8(q, gap);
+			__m128i* pm = (__m128i*)(mat_ + soff);
+			__m128i* pi = (__m128i*)(ins_ + soff);
+			_mm_storeu_si128(pm, _mm_adds_epu16(_mm_loadu_si128(pm), _mm_and_si128(_mm_unpacklo_epi8(mat, mat), one)));
+			_mm_storeu_si128(pm + 1, _mm_adds_epu16(_mm_loadu_si128(pm + 1), _mm_and_si128(_mm_unpackhi_epi8(mat, mat), one)));
+			_mm_storeu_si128(pi, _mm_adds_epu16(_mm_loadu_si128(pi), _mm_and_si128(_mm_unpacklo_epi8(ins, ins), one)));
+			_mm_storeu_si128(pi + 1, _mm_adds_epu16(_mm_loadu_si128(pi + 1), _mm_and_si128(_mm_unpackhi_epi8(ins, ins), one)));
+			__m128i* pb = (__m128i*)(base_ + soff);
+			const __m128i b = _mm_loadu_si128(pb);
+			_mm_storeu_si128(pb, _mm_or_si128(_mm_and_si128(mat, s), _mm_andnot_si128(mat, b)));
+			i += 16;
+			soff += 16;
+		}
+		if (i + 8 <= aln_size)
+		{
+			const __m128i s = _mm_loadl_epi64((const __m128i*)(saln + i));
+			if (!(_mm_movemask_epi8(_mm_cmpeq_epi8(s, gap)) & 0xff))
+			{
+				const __m128i q = _mm_loadl_epi64((const __m128i*)(qaln + i));
+				const __m128i mat = _mm_cmpeq_epi8(q, s);
+				const __m128i ins = _mm_cmpeq_epi8(q, gap);
+				__m128i* pm = (__m128i*)(mat_ + soff);
+				__m128i* pi = (__m128i*)(ins_ + soff);
+				_mm_storeu_si128(pm, _mm_adds_epu16(_mm_loadu_si128(pm), _mm_and_si128(_mm_unpacklo_epi8(mat, mat), one)));
+				_mm_storeu_si128(pi, _mm_adds_epu16(_mm_loadu_si128(pi), _mm_and_si128(_mm_unpacklo_epi8(ins, ins), one)));
+				__m128i* pb = (__m128i*)(base_ + soff);
+				const __m128i b = _mm_loadl_epi64(pb);
+				_mm_storel_epi64(pb, _mm_or_si128(_mm_and_si128(mat, s), _mm_andnot_si128(mat, b)));
+				i += 8;
+				soff += 8;
+			}
+		}
+#endif
+		for (; i < aln_size && saln[i] != kGap; ++i, ++soff)
+		{
+			if (qaln[i] == saln[i])
+			{
+				add_vote(mat_[soff]);
+				base_[soff] = saln[i];
+			}
+			else if (qaln[i] == kGap)
+			{
+				add_vote(ins_[soff]);
+			}
+		}
+		if (i == aln_size) break;
+		
+		// a run of gaps in the template is one deletion after the previous
+		// base, unless the query has gaps there too
+		bool del = false;
+		for (; i < aln_size && saln[i] == kGap; ++i) 
+			if (qaln[i] != kGap) del = true;
+		if (del) add_vote(del_[soff - 1]);
 	}
 }
+
+template <bool covered>
+index_t CnsVoteTable::find_column(index_t from, const index_t to, const int min_cov) const
+{
+#ifdef __SSE2__
+	if (min_cov >= 0 && min_cov <= CNS_MAX_VOTES)
+	{
+		// cov >= min_cov if min_cov - cov saturates to 0, the saturated sum
+		// of the counts does not change that
+		const __m128i mc = _mm_set1_epi16((short)min_cov);
+		const __m128i zero = _mm_setzero_si128();
+		for (; from + 8 <= to; from += 8)
+		{
+			const __m128i c = _mm_adds_epu16(_mm_loadu_si128((const __m128i*)(mat_ + from)), 
+											 _mm_loadu_si128((const __m128i*)(ins_ + from)));
+			int m = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(mc, c), zero));
+			if (!covered) m = ~m & 0xffff;
+			if (m) return from + __builtin_ctz(m) / 2;
+		}
+	}
+#endif
+	for (; from < to; ++from)
+		if ((cov(from) >= min_cov) == covered) break;
+	return from;
+}
+
+index_t CnsVoteTable::next_covered(index_t from, const index_t to, const int min_cov) const
+{
+	return find_column<true>(from, to, min_cov);
+}
+
+index_t CnsVoteTable::next_uncovered(index_t from, const index_t to, const int min_cov) const
+{
+	return find_column<false>(from, to, min_cov);
+}
@@ -7,29 +7,47 @@
 #include "dw.h"
 #include "../common/packed_db.h"
 #include "options.h"
+#include "poa_graph.h"
 
-struct CnsTableItem
-{
-	char base;
-	uint1 mat_cnt;
-	uint1 ins_cnt;
-	uint1 del_cnt;
-	
-	CnsTableItem() : base('N'), mat_cnt(0), ins_cnt(0), del_cnt(0) {}
-};
+#define CNS_MAX_VOTES 65535
 
-struct CnsTableItemCleaner
+// the votes of the alignments of a template read, one column per template base.
+// the base and the match, insertion and deletion counts of the columns are kept
+// in separate arrays, the counts saturate at CNS_MAX_VOTES.
+class CnsVoteTable
 {
-	void operator()(CnsTableItem& item) 
-	{
-		item.base = 'N';
-		item.mat_cnt = 0;
-		item.ins_cnt = 0;
-		item.del_cnt = 0;
-	}
+public:
+	CnsVoteTable();
+	~CnsVoteTable();
+	// makes the table hold size columns, none of which has a vote
+	void reset(const index_t size);
+	// adds the votes of a normalized alignment whose template part starts at column soff
+	void add_aln(const char* qaln, const char* saln, const index_t aln_size, index_t soff);
+	// the first column of [from, to) covered by min_cov votes or more, to if there is none
+	index_t next_covered(index_t from, const index_t to, const int min_cov) const;
+	// the first column of [from, to) covered by less than min_cov votes, to if there is none
+	index_t next_uncovered(index_t from, const index_t to, const int min_cov) const;
+	
+	char base(const index_t i) const { return base_[i]; }
+	int mat_cnt(const index_t i) const { return mat_[i]; }
+	int ins_cnt(const index_t i) const { return ins_[i]; }
+	int del_cnt(const index_t i) const { return del_[i]; }
+	int cov(const index_t i) const { return mat_[i] + ins_[i]; }
+	
+private:
+	template <bool covered>
+	index_t find_column(index_t from, const index_t to, const int min_cov) const;
+	
+	char*     base_;
+	uint16_t* mat_;
+	uint16_t* ins_;
+	uint16_t* del_;
+	index_t   capacity_;
 };
 
 #define MAX_CNS_OVLPS 100
+// size of the blocks of the aligned strings of a template read
+#define CNS_ARENA_BLOCK_SIZE (4 * 1024 * 1024)
 
 struct MappingRange
 {
@@ -38,11 +56,38 @@ struct MappingRange
 	MappingRange(int s, int e) : start(s), end(e) {}
 };
 
+// bump allocator of the aligned strings of a template read. the memory is
+// taken from blocks that are kept from one read to the next, clear() makes
+// it all available again.
+class CnsArena
+{
+public:
+	CnsArena(const size_t block_size = CNS_ARENA_BLOCK_SIZE);
+	~CnsArena();
+	char* alloc(const size_t size);
+	// keeps the first size bytes of p, the last block allocated
+	void trim(char* p, const size_t size);
+	void clear();
+	
+private:
+	struct Block
+	{
+		char*  data;
+		size_t size;
+	};
+	
+	void add_block(const size_t size);
+	
+	std::vector<Block> blocks_;
+	size_t block_size_;
+	size_t used_;
+};
+
 struct CnsAln
 {
 	int soff, send, aln_idx, aln_size;
-	char qaln[MAX_SEQ_SIZE];
-	char saln[MAX_SEQ_SIZE];
+	char* qaln;
+	char* saln;
 	
 	bool retrieve_aln_subseqs(int sb, int se, std::string& qstr, std::string& tstr, int& sb_out)
 	{
@@ -80,23 +125,12 @@ public:
 	{
 		safe_free(cns_alns_);
 	}
-	void clear() { num_alns_ = 0; }
+	void clear() { num_alns_ = 0; arena_.clear(); }
 	int num_alns() { return num_alns_; }
 	CnsAln* begin() { return cns_alns_; }
 	CnsAln* end() { return cns_alns_ + num_alns_; }
-	void add_aln(const int soff, const int send, const std::string& qstr, const std::string& tstr)
-	{
-		r_assert(qstr.size() == tstr.size());
-		CnsAln& a = cns_alns_[num_alns_++];
-		a.soff = soff;
-		a.send = send;
-		a.aln_idx = 0;
-		a.aln_size = qstr.size();
-		memcpy(a.qaln, qstr.data(), qstr.size());
-		a.qaln[qstr.size()] = '\0';
-		memcpy(a.saln, tstr.data(), tstr.size());
-		a.saln[tstr.size()] = '\0';
-	}
+	// adds the alignment [qstr, tstr) of aln_size columns with its gaps normalized
+	CnsAln& add_aln(const int soff, const int send, const char* qstr, const char* tstr, const index_t aln_size);
 	void get_mapping_ranges(std::vector<MappingRange>& ranges)
 	{
 		ranges.clear();
@@ -104,12 +138,19 @@ public:
 	}
 	
 private:
-	CnsAln* cns_alns_;
-	int     num_alns_;
+	CnsAln*  cns_alns_;
+	int      num_alns_;
+	CnsArena arena_;
 };
 
 #define MAX_CNS_RESULTS 10000
 
+// initial size of the per thread buffers, they grow with the longest template seen
+#define CNS_INIT_READ_SIZE 100000
+
+// number of candidates aligned together with the vectorized kernel
+#define CNS_BATCH_SIZE 8
+
 struct ConsensusThreadData
 {
 	ReadsCorrectionOptions rco;
@@ -118,7 +159,8 @@ struct ConsensusThreadData
 	ExtensionCandidate* candidates;
 	int num_candidates;
 	ns_banded_sw::DiffRunningData* drd_s;
-	ns_banded_sw::DiffRunningData* drd_l;
+	ns_banded_sw::BatchRunningData* brd; // NULL unless the vectorized kernel is used
+	std::vector<char> batch_queries[CNS_BATCH_SIZE];
 	M5Record* m5;
 	CnsAlns cns_alns;
 	std::vector<CnsResult> cns_results;
@@ -126,52 +168,50 @@ struct ConsensusThreadData
 	std::vector<char> target;
 	std::string qaln;
 	std::string saln;
-	CnsTableItem* cns_table;
+	CnsVoteTable votes;
 	uint1* id_list;
-	std::ostream* out;
-	pthread_mutex_t out_lock;
+	index_t id_list_capacity;
+	index_t num_skipped_reads;	// reads longer than rco.max_read_size
+	ns_meap_cns::PoaGraph poa;
 	
-	ConsensusThreadData(ReadsCorrectionOptions* prco, int tid, PackedDB* r, ExtensionCandidate* ec, int nec, std::ostream* output)
+	ConsensusThreadData(ReadsCorrectionOptions* prco, int tid, PackedDB* r)
 	{
 		rco = (*prco);
 		thread_id = tid;
 		reads = r;
-		candidates = ec;
-		num_candidates = nec;
-		drd_s = new ns_banded_sw::DiffRunningData(ns_banded_sw::get_sw_parameters_small());
-		drd_l = new ns_banded_sw::DiffRunningData(ns_banded_sw::get_sw_parameters_large());
-		m5 = NewM5Record(MAX_SEQ_SIZE);
-		out = output;
+		candidates = NULL;
+		num_candidates = 0;
+		drd_s = new ns_banded_sw::DiffRunningData(ns_banded_sw::get_sw_parameters_small(), rco.ext_kernel);
+		brd = NULL;
+		if (rco.ext_kernel == EXT_KERNEL_SIMD) brd = new ns_banded_sw::BatchRunningData(ns_banded_sw::get_sw_parameters_small(), CNS_BATCH_SIZE);
+		m5 = NewM5Record(CNS_INIT_READ_SIZE);
 		
-		query.reserve(MAX_SEQ_SIZE);
-		target.reserve(MAX_SEQ_SIZE);
-		qaln.reserve(MAX_SEQ_SIZE);
-		saln.reserve(MAX_SEQ_SIZE);
-		safe_malloc(cns_table, CnsTableItem, MAX_SEQ_SIZE);
-		safe_malloc(id_list, uint1, MAX_SEQ_SIZE);
-		pthread_mutex_init(&out_lock, NULL);
+		query.reserve(CNS_INIT_READ_SIZE);
+		target.reserve(CNS_INIT_READ_SIZE);
+		qaln.reserve(CNS_INIT_READ_SIZE);
+		saln.reserve(CNS_INIT_READ_SIZE);
+		id_list_capacity = CNS_INIT_READ_SIZE;
+		safe_malloc(id_list, uint1, id_list_capacity);
+		num_skipped_reads = 0;
+	}
+	
+	// makes id_list hold a template of read_size bases
+	void reserve(const index_t read_size)
+	{
+		safe_reserve(id_list, uint1, id_list_capacity, read_size);
 	}
 	
 	~ConsensusThreadData()
 	{
 		delete drd_s;
-		delete drd_l;
+		if (brd) delete brd;
 		m5 = DeleteM5Record(m5);
-		safe_free(cns_table);
 		safe_free(id_list);
 	}
 };
 
-void normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size, std::string& qnorm, std::string& tnorm, const bool push);
-
-void
-build_cns_thrd_data_can(ExtensionCandidate* ec_list, 
-						const int nec,
-						const idx_t min_rid,
-						const idx_t max_rid,
-						ReadsCorrectionOptions* prco,
-						PackedDB* reads,
-						std::ostream* out,
-					    ConsensusThreadData** ppctd);
+// rewrites the mismatches of the alignment as indels and pushes the gaps to the right.
+// qnorm and tnorm hold 2 * aln_size + 1 characters, returns the size of the normalized alignment.
+index_t normalize_gaps(const char* qstr, const char* tstr, const index_t aln_size, char* qnorm, char* tnorm, const bool push);
 
 #endif // _READS_CORRECTION_AUX_H
@@ -1,6 +1,7 @@
 #include "pw_options.h"
 #include "pw_impl.h"
 #include "../common/split_database.h"
+#include "../common/overlap_file.h"
 
 #include <cstdio>
 #include <fstream>
@@ -32,17 +33,33 @@ create_volume_results_name_finished(int vid, const char* wrk_dir, string& name)
 }
 
 void
-merge_results(const char* output, const char* wrk_dir, const int num_volumes)
+merge_results(options_t* options, const int num_volumes)
 {
+	ofstream out;
+	open_fstream(out, options->output, ios::out | ios::binary);
+	if (options->output_format == OVLP_FORMAT_BINARY)
+	{
+		// volume results hold bare records, the header is only written to the final output
+		int record_type = (options->task == TASK_SEED) ? OVLP_RECORD_CAN : OVLP_RECORD_M4;
+		int flags = (record_type == OVLP_RECORD_M4 && options->output_gapped_start_point) ? OVLP_FLAG_GAPPED_START : 0;
+		write_overlap_file_header(out, record_type, flags);
+	}
+	
+	const size_t buf_size = 8 * 1024 * 1024;
+	char* buf;
+	safe_malloc(buf, char, buf_size);
 	string vrn;
 	for (int i = 0; i < num_volumes; ++i)
 	{
-		create_volume_results_name_finished(i, wrk_dir, vrn);
-		ostringstream cmd;
-		if (i == 0) cmd << "cat " << vrn << " >" << output;
-		else cmd << "cat " << vrn << " >> " << output;
-		assert(system(cmd.str().c_str()) == 0);
+		create_volume_results_name_finished(i, options->wrk_dir, vrn);
+		FILE* in = fopen(vrn.c_str(), "rb");
+		if (!in) ERROR("failed to open file \'%s\'", vrn.c_str());
+		size_t n;
+		while ((n = fread(buf, 1, buf_size, in)) > 0) out.write(buf, n);
+		fclose(in);
 	}
+	safe_free(buf);
+	close_fstream(out);
 }
 
 int main(int argc, char* argv[])
@@ -81,5 +98,5 @@ int main(int argc, char* argv[])
 	}
 	vn = delete_volume_names_t(vn);
 	
-	merge_results(options.output, options.wrk_dir, num_vols);
+	merge_results(&options, num_vols);
 }
@@ -11,7 +11,7 @@ SOURCES  := pw.cpp pw_impl.cpp pw_options.cpp
 SRC_INCDIRS  := ../common .
 
 TGT_LDFLAGS := -L${TARGET_DIR}
-TGT_LDLIBS  := -lmecat
+TGT_LDLIBS  := -lmecat -lz
 TGT_PREREQS := libmecat.a
 
 SUBMAKEFILES :=
@@ -4,6 +4,8 @@
 #include "../common/xdrop_gapalign.h"
 #include "../common/packed_db.h"
 #include "../common/lookup_table.h"
+#include "../common/kmer_extractor.h"
+#include "../common/overlap_file.h"
 #include "pw_impl.h"
 
 #include <algorithm>
@@ -13,11 +15,11 @@
 #include <cstdlib>
 #include <cstring>
 
-#define MSS MAX_SEQ_SIZE
-
 static int MAXC = 100;
 static int output_gapped_start_point = 1;
+static int output_format = OVLP_FORMAT_TEXT;
 static int kmer_size = 13;
+static int kmer_stride = 10;
 static const double ddfs_cutoff_pacbio = 0.25;
 static const double ddfs_cutoff_nanopore = 0.25;
 static double ddfs_cutoff = ddfs_cutoff_pacbio;
@@ -28,7 +30,7 @@ static int min_kmer_dist = 0;
 using namespace std;
 
 PWThreadData::PWThreadData(options_t* opt, volume_t* ref, volume_t* rd, ref_index* idx, std::ostream* o)
-	: options(opt), used_thread_id(0), reference(ref), reads(rd), ridx(idx), out(o), m4_results(NULL), ec_results(NULL), next_processed_id(0)
+	: options(opt), used_thread_id(0), reference(ref), reads(rd), ridx(idx), out(o), m4_results(NULL), ec_results(NULL), next_processed_id(0), num_skipped_reads(0)
 {
 	pthread_mutex_init(&id_lock, NULL);
 	if (options->task == TASK_SEED)
@@ -81,28 +83,22 @@ reverse_complement(char* dst, const char* src, const int size)
 }
 
 int
-extract_kmers(const char* s, const int ssize, int* kmer_ids)
+extract_kmers(const char* s, const int ssize, int* kmer_ids, u1_t* packed_read)
 {
-	int max_id = 1 << (2 * kmer_size);
-	int num_kmers = (ssize - kmer_size) / BC + 1;
-	int i, j;
-	for (i = 0; i < num_kmers; ++i)
-	{
-		int eit = 0, start = i * BC;
-		for (j = 0; j < kmer_size; ++j) eit = (eit << 2) | s[start + j];
-		kmer_ids[i] = eit;
-		assert(eit < max_id);
-	}
-	return num_kmers;
+	pack_codes(s, ssize, packed_read);
+	return extract_strided_kmers(packed_read, (ssize + 3) / 4, 0, ssize, kmer_size, kmer_stride, kmer_ids);
 }
 
 SeedingBK::SeedingBK(const int ref_size)
 {
 	const int num_segs = ref_size / ZV + 5;
 	safe_malloc(index_list, int, num_segs);
-	safe_malloc(index_score, short, num_segs);
+	safe_malloc(index_score, int, num_segs);
 	safe_malloc(database, Back_List, num_segs);
-	safe_malloc(kmer_ids, int, MAX_SEQ_SIZE);
+	kmer_ids = NULL;
+	packed_read = NULL;
+	kmer_ids_capacity = 0;
+	packed_read_capacity = 0;
 	for (int i = 0; i < num_segs; ++i) 
 	{
 		database[i].score = 0;
@@ -116,6 +112,14 @@ SeedingBK::~SeedingBK()
 	safe_free(index_score);
 	safe_free(database);
 	safe_free(kmer_ids);
+	safe_free(packed_read);
+}
+
+void
+SeedingBK::reserve(const int read_size)
+{
+	safe_reserve(kmer_ids, int, kmer_ids_capacity, read_size);
+	safe_reserve(packed_read, u1_t, packed_read_capacity, read_size / 4 + 8);
 }
 
 void insert_loc(Back_List *spr,int loc,int seedn,float len)
@@ -241,24 +245,28 @@ int find_location(int *t_loc,int *t_seedn,int *t_score,int *loc,int k,int *rep_l
 int
 seeding(const char* read, const int read_size, ref_index* ridx, SeedingBK* sbk)
 {
+	sbk->reserve(read_size);
 	int* kmer_ids = sbk->kmer_ids;
 	int* index_list = sbk->index_list;
 	int* index_spr = index_list;
-	short* index_score = sbk->index_score;
-	short* index_ss = index_score;
+	int* index_score = sbk->index_score;
+	int* index_ss = index_score;
 	Back_List* database = sbk->database;
 	
-	int num_kmers = extract_kmers(read, read_size, kmer_ids);
+	int num_kmers = extract_kmers(read, read_size, kmer_ids, sbk->packed_read);
 	int km;
 	int used_segs = 0;
 	for (km = 0; km < num_kmers; ++km)
 	{
-		int num_seeds = ridx->kmer_counts[kmer_ids[km]];
-		int* seed_arr = ridx->kmer_starts[kmer_ids[km]];
+		u8_t kmer = (u4_t)kmer_ids[km];
+		uint32_t key = ref_index_key(ridx, kmer);
+		int num_seeds = ridx->kmer_counts[key];
+		int* seed_arr = ridx->kmer_starts[key];
 		int sid;
 		int endnum = 0;
 		for (sid = 0; sid < num_seeds; ++sid)
 		{
+			if (ridx->hashed && pac_kmer(ridx->pac, ridx->pac_bytes, seed_arr[sid], kmer_size) != kmer) continue;
 			int seg_id = seed_arr[sid] / ZV;
 			int seg_off = seed_arr[sid] % ZV;
 			Back_List* spr = database + seg_id;
@@ -266,7 +274,7 @@ seeding(const char* read, const int read_size, ref_index* ridx, SeedingBK* sbk)
 			{
 				int loc = ++spr->score;
 				if (loc <= SM) { spr->loczhi[loc - 1] = seg_off; spr->seedno[loc - 1] = km + 1; }
-				else insert_loc(spr, seg_off, km + 1, BC);
+				else insert_loc(spr, seg_off, km + 1, kmer_stride);
 				int s_k;
 				if (seg_id > 0) s_k = spr->score + (spr - 1)->score;
 				else s_k = spr->score;
@@ -297,8 +305,8 @@ get_candidates(volume_t* ref,
 {
 	int* index_list = sbk->index_list;
 	int* index_spr = index_list;
-	short* index_score = sbk->index_score;
-	short* index_ss = index_score;
+	int* index_score = sbk->index_score;
+	int* index_ss = index_score;
 	Back_List* database = sbk->database;
 	const int temp_arr_size = 2 * SM + 10;
 	int temp_list[temp_arr_size],temp_seedn[temp_arr_size],temp_score[temp_arr_size];
@@ -352,7 +360,7 @@ get_candidates(volume_t* ref,
 			}
 			
 			{
-				int f = find_location(temp_list, temp_seedn, temp_score, location_loc, u_k, &repeat_loc, BC, read_size);
+				int f = find_location(temp_list, temp_seedn, temp_score, location_loc, u_k, &repeat_loc, kmer_stride, read_size);
 				if (!f) continue;
 				if (temp_score[repeat_loc] < 2 * min_kmer_match + 2) continue;
 			}
@@ -385,7 +393,7 @@ get_candidates(volume_t* ref,
 			{
 				candidate_temp.readno = sid;
 				candidate_temp.readstart = sstart;
-				location_loc[1] = (location_loc[1] - 1) * BC;
+				location_loc[1] = (location_loc[1] - 1) * kmer_stride;
 				int left_length1 = location_loc[0] - sstart + kmer_size - 1;
 				int right_length1 = send - location_loc[0];
 				int left_length2 = location_loc[1] + kmer_size - 1;
@@ -409,7 +417,7 @@ get_candidates(volume_t* ref,
 					{
 						start_loc = MUL_ZV(u_k);
 						int scnt = min((int)spr1->score, SM);
-						for(j=0,s_k=0; j < scnt; j++)if(fabs((loc_list-start_loc-spr1->loczhi[j])/((loc_seed-spr1->seedno[j])*BC*1.0)-1.0)<ddfs_cutoff)
+						for(j=0,s_k=0; j < scnt; j++)if(fabs((loc_list-start_loc-spr1->loczhi[j])/((loc_seed-spr1->seedno[j])*kmer_stride*1.0)-1.0)<ddfs_cutoff)
 							{
 								seedcount++;
 								s_k++;
@@ -426,7 +434,7 @@ get_candidates(volume_t* ref,
 					{
 						start_loc = MUL_ZV(u_k);
 						int scnt = min((int)spr1->score, SM);
-						for(j=0,s_k=0; j < scnt; j++)if(fabs((start_loc+spr1->loczhi[j]-loc_list)/((spr1->seedno[j]-loc_seed)*BC*1.0)-1.0)<ddfs_cutoff)
+						for(j=0,s_k=0; j < scnt; j++)if(fabs((start_loc+spr1->loczhi[j]-loc_list)/((spr1->seedno[j]-loc_seed)*kmer_stride*1.0)-1.0)<ddfs_cutoff)
 							{
 								seedcount++;
 								s_k++;
@@ -464,8 +472,10 @@ get_candidates(volume_t* ref,
 	return candidatenum;
 }
 
+// the record of an alignment of query[qbeg, qend) and target[tbeg, tend) of identity ident
 void
-fill_m4record(GapAligner* aligner, const int qid, const int sid,
+fill_m4record(const int qbeg, const int qend, const int tbeg, const int tend, const double ident,
+			  const int qid, const int sid,
 			  const char qchain, int qsize, int ssize,
 			  int qstart, int sstart, int vscore, M4Record* m)
 {
@@ -473,15 +483,15 @@ fill_m4record(GapAligner* aligner, const int qid, const int sid,
 	{
 		m->qid = sid;
 		m->sid = qid;
-		m->ident = aligner->calc_ident();
+		m->ident = ident;
 		m->vscore = vscore;
 		m->qdir = 0;
-		m->qoff = aligner->target_start();
-		m->qend = aligner->target_end();
+		m->qoff = tbeg;
+		m->qend = tend;
 		m->qsize = ssize;
 		m->sdir = 0;
-		m->soff = aligner->query_start();
-		m->send = aligner->query_end();
+		m->soff = qbeg;
+		m->send = qend;
 		m->ssize = qsize;
 		m->qext = sstart;
 		m->sext = qstart;
@@ -490,15 +500,15 @@ fill_m4record(GapAligner* aligner, const int qid, const int sid,
 	{
 		m->qid = sid;
 		m->sid = qid;
-		m->ident = aligner->calc_ident();
+		m->ident = ident;
 		m->vscore = vscore;
 		m->qdir = 0;
-		m->qoff = aligner->target_start();
-		m->qend = aligner->target_end();
+		m->qoff = tbeg;
+		m->qend = tend;
 		m->qsize = ssize;
 		m->sdir = 1;
-		m->soff = qsize - aligner->query_end();
-		m->send = qsize - aligner->query_start();
+		m->soff = qsize - qend;
+		m->send = qsize - qbeg;
 		m->ssize = qsize;
 		m->qext = sstart;
 		m->sext = qsize - 1 - qstart;
@@ -508,6 +518,12 @@ fill_m4record(GapAligner* aligner, const int qid, const int sid,
 
 void output_m4record(ostream& out, const M4Record& m4)
 {
+	if (output_format == OVLP_FORMAT_BINARY)
+	{
+		write_binary_record(out, m4, output_gapped_start_point);
+		return;
+	}
+	
 	const char sep = '\t';
 	
 	out << m4qid(m4)    << sep
@@ -609,6 +625,17 @@ append_m4v(M4Record* glist, int* glist_size,
 	*llist_size = 0;
 }
 
+inline void
+reserve_read_buffers(char*& read1, char*& read2, int& capacity, const int rsize)
+{
+	if (rsize <= capacity) return;
+	capacity = std::max(rsize, 2 * capacity);
+	safe_free(read1);
+	safe_free(read2);
+	safe_malloc(read1, char, capacity);
+	safe_malloc(read2, char, capacity);
+}
+
 inline void
 get_next_chunk_reads(PWThreadData* data, int& Lid, int& Rid)
 {
@@ -620,13 +647,71 @@ get_next_chunk_reads(PWThreadData* data, int& Lid, int& Rid)
 	pthread_mutex_unlock(&data->read_retrieve_lock);
 }
 
+// aligns the candidates of read rid PW_BATCH_SIZE at a time, the results are
+// appended to m4v in the order of the candidates as the one by one alignment does
+static void
+align_candidates_batch(PWThreadData* data, DiffBatchAligner* aligner, const int rid, const int rsize,
+					   const char* read1, const char* read2,
+					   candidate_save* candidates, const int num_candidates,
+					   char** subjects, int* subject_capacities,
+					   M4Record* m4v, int& num_m4)
+{
+	const int max_read_size = data->options->max_read_size;
+	DiffBatchSlot slots[PW_BATCH_SIZE];
+	int slot_candidates[PW_BATCH_SIZE];
+	int s = 0;
+	while (s < num_candidates)
+	{
+		int n = 0;
+		for (; s < num_candidates && n < PW_BATCH_SIZE; ++s)
+		{
+			const int sid = candidates[s].readno - data->reference->start_read_id;
+			int ssize = data->reference->offset_list->offset_list[sid].size;
+			if (ssize > max_read_size) continue;
+			safe_reserve(subjects[n], char, subject_capacities[n], ssize);
+			extract_one_seq(data->reference, sid, subjects[n]);
+			int sstart = candidates[s].loc1;
+			int qstart = candidates[s].loc2;
+			if (qstart && sstart)
+			{
+				qstart += kmer_size / 2;
+				sstart += kmer_size / 2;
+			}
+			
+			DiffBatchSlot& slot = slots[n];
+			slot.query = (candidates[s].chain == 'F') ? read1 : read2;
+			slot.qstart = qstart;
+			slot.qsize = rsize;
+			slot.target = subjects[n];
+			slot.tstart = sstart;
+			slot.tsize = ssize;
+			slot_candidates[n++] = s;
+		}
+		aligner->go(slots, n, min_align_size);
+		
+		for (int i = 0; i < n; ++i)
+		{
+			if (!slots[i].aligned) continue;
+			const OutputStore& result = *slots[i].result;
+			const candidate_save& c = candidates[slot_candidates[i]];
+			fill_m4record(result.query_start, result.query_end,
+						  result.target_start, result.target_end, result.calc_ident(),
+						  rid + data->reads->start_read_id, 
+						  c.readno, c.chain, 
+						  rsize, slots[i].tsize, slots[i].qstart, slots[i].tstart, c.score,
+						  m4v + num_m4);
+			++num_m4;
+		}
+	}
+}
+
 void
 pairwise_mapping(PWThreadData* data, int tid)
 {
-	char *read, *read1, *read2, *subject;
-	safe_malloc(read1, char, MSS);
-	safe_malloc(read2, char, MSS);
-	safe_malloc(subject, char, MSS);
+	char *read, *read1 = NULL, *read2 = NULL, *subject = NULL;
+	int read_capacity = 0, subject_capacity = 0;
+	const int max_read_size = data->options->max_read_size;
+	int num_skipped_reads = 0;
 	SeedingBK* sbk = new SeedingBK(data->reference->curr);
 	candidate_save candidates[MAXC];
 	int num_candidates = 0;
@@ -635,8 +720,15 @@ pairwise_mapping(PWThreadData* data, int tid)
 	M4Record* m4v = new M4Record[MAXC];
 	int num_m4 = 0;
 	GapAligner* aligner = NULL;
+	// with the vectorized kernel the candidates of a read are aligned together
+	DiffBatchAligner* batch_aligner = NULL;
+	char* subjects[PW_BATCH_SIZE];
+	int subject_capacities[PW_BATCH_SIZE];
+	std::fill(subjects, subjects + PW_BATCH_SIZE, (char*)NULL);
+	std::fill(subject_capacities, subject_capacities + PW_BATCH_SIZE, 0);
 	if (data->options->tech == TECH_PACBIO) {
-		aligner = new DiffAligner(0);
+		if (data->options->ext_kernel == EXT_KERNEL_SIMD) batch_aligner = new DiffBatchAligner(0, PW_BATCH_SIZE);
+		else aligner = new DiffAligner(0);
 	} else if (data->options->tech == TECH_NANOPORE) {
 		aligner = new XdropAligner(0);
 	} else {
@@ -651,6 +743,8 @@ pairwise_mapping(PWThreadData* data, int tid)
 		for (rid = Lid; rid < Rid; ++rid)
 		{
 			int rsize = data->reads->offset_list->offset_list[rid].size;
+			if (rsize > max_read_size) { ++num_skipped_reads; continue; }
+			reserve_read_buffers(read1, read2, read_capacity, rsize);
 			extract_one_seq(data->reads, rid, read1);
 			reverse_complement(read2, read1, rsize);
 			int s;
@@ -671,10 +765,19 @@ pairwise_mapping(PWThreadData* data, int tid)
 												num_candidates); 
 			}
 
-			for (s = 0; s < num_candidates; ++s)
+			if (batch_aligner)
+			{
+				align_candidates_batch(data, batch_aligner, rid, rsize, read1, read2,
+									   candidates, num_candidates, subjects, subject_capacities,
+									   m4v, num_m4);
+			}
+			else for (s = 0; s < num_candidates; ++s)
 			{
 				if (candidates[s].chain == 'F') read = read1;
 				else read = read2;
+				int ssize = data->reference->offset_list->offset_list[candidates[s].readno - data->reference->start_read_id].size;
+				if (ssize > max_read_size) continue;
+				safe_reserve(subject, char, subject_capacity, ssize);
 				extract_one_seq(data->reference, candidates[s].readno - data->reference->start_read_id, subject);
 				int sstart = candidates[s].loc1;
 				int qstart = candidates[s].loc2;
@@ -683,13 +786,14 @@ pairwise_mapping(PWThreadData* data, int tid)
 					qstart += kmer_size / 2;
 					sstart += kmer_size / 2;
 				}
-				int ssize = data->reference->offset_list->offset_list[candidates[s].readno - data->reference->start_read_id].size;
 				
 				int flag = aligner->go(read, qstart, rsize, subject, sstart, ssize, min_align_size);
 				
 				if (flag)
 				{
-					fill_m4record(aligner, rid + data->reads->start_read_id, 
+					fill_m4record(aligner->query_start(), aligner->query_end(),
+								  aligner->target_start(), aligner->target_end(), aligner->calc_ident(),
+								  rid + data->reads->start_read_id, 
 								  candidates[s].readno, candidates[s].chain, 
 								  rsize, ssize, qstart, sstart, candidates[s].score,
 								  m4v + num_m4);
@@ -709,21 +813,34 @@ pairwise_mapping(PWThreadData* data, int tid)
 			pthread_mutex_unlock(&data->result_write_lock);
 		}
 		
+		pthread_mutex_lock(&data->read_retrieve_lock);
+		data->num_skipped_reads += num_skipped_reads;
+		pthread_mutex_unlock(&data->read_retrieve_lock);
+		
 		safe_free(read1);
 		safe_free(read2);
 		safe_free(subject);
+		for (int i = 0; i < PW_BATCH_SIZE; ++i) if (subjects[i]) safe_free(subjects[i]);
 		delete sbk;
-		delete aligner;
+		if (aligner) delete aligner;
+		if (batch_aligner) delete batch_aligner;
 		delete[] m4v;
 }
 
+inline void
+output_candidate(ostream& out, const ExtensionCandidate& ec)
+{
+	if (output_format == OVLP_FORMAT_BINARY) write_binary_record(out, ec);
+	else out << ec;
+}
+
 void
 candidate_detect(PWThreadData* data, int tid)
 {
-	char *read, *read1, *read2, *subject;
-	safe_malloc(read1, char, MAX_SEQ_SIZE);
-	safe_malloc(read2, char, MAX_SEQ_SIZE);
-	safe_malloc(subject, char, MAX_SEQ_SIZE);
+	char *read, *read1 = NULL, *read2 = NULL;
+	int read_capacity = 0;
+	const int max_read_size = data->options->max_read_size;
+	int num_skipped_reads = 0;
 	SeedingBK* sbk = new SeedingBK(data->reference->curr);
 	Candidate candidates[MAXC];
 	int num_candidates = 0;
@@ -740,10 +857,8 @@ candidate_detect(PWThreadData* data, int tid)
 	for (rid = Lid; rid < Rid; ++rid)
 	{
 		int rsize = data->reads->offset_list->offset_list[rid].size;
-        if (rsize >= MAX_SEQ_SIZE) {
-            cout << "rsize = " << rsize << "\t" << MAX_SEQ_SIZE << endl;
-            abort();
-        }
+		if (rsize > max_read_size) { ++num_skipped_reads; continue; }
+		reserve_read_buffers(read1, read2, read_capacity, rsize);
 		extract_one_seq(data->reads, rid, read1);
 		reverse_complement(read2, read1, rsize);
 		int s;
@@ -795,7 +910,7 @@ candidate_detect(PWThreadData* data, int tid)
 			if (nec == PWThreadData::kResultListSize)
 			{
 				pthread_mutex_lock(&data->result_write_lock);
-				for (int i = 0; i < nec; ++i) (*data->out) << eclist[i];
+				for (int i = 0; i < nec; ++i) output_candidate(*data->out, eclist[i]);
 				nec = 0;
 				pthread_mutex_unlock(&data->result_write_lock);
 			}
@@ -806,14 +921,17 @@ candidate_detect(PWThreadData* data, int tid)
 	if (nec)
 	{
 		pthread_mutex_lock(&data->result_write_lock);
-		for (int i = 0; i < nec; ++i) (*data->out) << eclist[i];
+		for (int i = 0; i < nec; ++i) output_candidate(*data->out, eclist[i]);
 		nec = 0;
 		pthread_mutex_unlock(&data->result_write_lock);
 	}
 	
+	pthread_mutex_lock(&data->read_retrieve_lock);
+	data->num_skipped_reads += num_skipped_reads;
+	pthread_mutex_unlock(&data->read_retrieve_lock);
+	
 	safe_free(read1);
 	safe_free(read2);
-	safe_free(subject);
 	delete sbk;
 }
 
@@ -837,8 +955,11 @@ process_one_volume(options_t* options, const int svid, const int evid, volume_na
 {
 	MAXC = options->num_candidates;
 	output_gapped_start_point = options->output_gapped_start_point;
+	output_format = options->output_format;
 	min_align_size = options->min_align_size;
 	min_kmer_match = options->min_kmer_match;
+	kmer_size = options->kmer_size;
+	kmer_stride = options->kmer_stride;
 	
 	if (options->tech == TECH_PACBIO) {
 		ddfs_cutoff = ddfs_cutoff_pacbio;
@@ -852,7 +973,14 @@ process_one_volume(options_t* options, const int svid, const int evid, volume_na
 	
 	const char* ref_name = get_vol_name(vn, svid);
 	volume_t* ref = load_volume(ref_name);
-	ref_index* ridx = create_ref_index(ref, kmer_size, options->num_threads);
+	char ridx_name[2048];
+	generate_ref_index_file_name(ref_name, ridx_name);
+	ref_index* ridx = load_ref_index(ridx_name, ref, kmer_size, options->max_kmer_occ);
+	if (!ridx)
+	{
+		ridx = create_ref_index(ref, kmer_size, options->max_kmer_occ, options->num_threads);
+		dump_ref_index(ridx_name, ridx, ref);
+	}
 	pthread_t tids[options->num_threads];
 	char volume_process_info[1024];;
 	int vid, tid;
@@ -874,6 +1002,8 @@ process_one_volume(options_t* options, const int svid, const int evid, volume_na
 			}
 		}
 		for (tid = 0; tid < options->num_threads; ++tid) pthread_join(tids[tid], NULL);
+		if (data->num_skipped_reads)
+			LOG(stderr, "%d reads longer than %d are skipped", data->num_skipped_reads, options->max_read_size);
 		read = delete_volume_t(read);
 		delete data;
 	}
@@ -9,10 +9,11 @@
 
 #define RM 			100000
 #define DN 			500
-#define BC 			10
 #define SM 			40
 #define SI 			41
 #define CHUNK_SIZE 	500
+// candidates of a read aligned together by the vectorized kernel
+#define PW_BATCH_SIZE 	8
 #define ZV 			2000
 #define MUL_ZV(a) 	((a)*ZV)
 #define DIV_ZV(a) 	((a)/ZV)
@@ -28,7 +29,10 @@ typedef candidate_save Candidate;
 
 struct Back_List
 {
-    short score,loczhi[SM],seedno[SM],seednum;
+    // seed numbers and scores grow as the stride shrinks, so they are kept as ints
+    int score;
+    short loczhi[SM];
+    int seedno[SM],seednum;
     int index;
 };
 
@@ -47,6 +51,7 @@ struct PWThreadData
 	pthread_mutex_t			result_write_lock;
 	int						next_processed_id;
 	pthread_mutex_t			read_retrieve_lock;
+	int						num_skipped_reads;
 	
 	PWThreadData(options_t* opt, volume_t* ref, volume_t* rd, ref_index* idx, std::ostream* o);
 	~PWThreadData();
@@ -55,12 +60,16 @@ struct PWThreadData
 struct SeedingBK
 {
 	int* index_list;
-	short* index_score;
+	int* index_score;
 	Back_List* database;
 	int* kmer_ids;
+	u1_t* packed_read;
+	int kmer_ids_capacity;
+	int packed_read_capacity;
 	
 	SeedingBK(const int ref_size);
 	~SeedingBK();
+	void reserve(const int read_size);
 };
 
 void
@@ -1,4 +1,6 @@
 #include "pw_options.h"
+#include "../common/lookup_table.h"
+#include "../common/overlap_file.h"
 
 #include <unistd.h>
 #include <dirent.h>
@@ -11,6 +13,10 @@ static const int kDefaultAlignSizePacbio = 2000;
 static const int kDefaultAlignSizeNanopore = 500;
 static const int kDefaultKmerMatchPacbio = 4;
 static const int kDefaultKmerMatchNanopore = 2;
+static const int kDefaultKmerSize = 13;
+static const int kDefaultKmerStride = 10;
+static const int kDefaultMaxKmerOcc = 128;
+static const int kMinKmerSize = 8;
 
 void
 print_options(options_t* options)
@@ -25,6 +31,12 @@ print_options(options_t* options)
 	LOG(stderr, "min block score\t%d", options->min_kmer_match);
 	LOG(stderr, "output gapped start\t%c", options->output_gapped_start_point ? 'Y' : 'N'); 
 	LOG(stderr, "tech\t%d", options->tech);
+	LOG(stderr, "kmer size\t%d", options->kmer_size);
+	LOG(stderr, "kmer stride\t%d", options->kmer_stride);
+	LOG(stderr, "max kmer occurrences\t%d", options->max_kmer_occ);
+	LOG(stderr, "output format\t%s", options->output_format == OVLP_FORMAT_BINARY ? "binary" : "text");
+	LOG(stderr, "extension kernel\t%s", options->ext_kernel == EXT_KERNEL_SIMD ? "vectorized diff" : "diff");
+	LOG(stderr, "max read size\t%d", options->max_read_size);
 }
 
 void
@@ -39,6 +51,12 @@ init_options(options_t* options, int tech)
     options->num_candidates = 100;
     options->output_gapped_start_point = 0;
 	options->tech = tech;
+	options->kmer_size = kDefaultKmerSize;
+	options->kmer_stride = kDefaultKmerStride;
+	options->max_kmer_occ = kDefaultMaxKmerOcc;
+	options->output_format = OVLP_FORMAT_TEXT;
+	options->ext_kernel = EXT_KERNEL_DIFF;
+	options->max_read_size = DEFAULT_MAX_READ_SIZE;
 	
 	if (tech == TECH_PACBIO) {
 		options->min_align_size = kDefaultAlignSizePacbio;
@@ -53,7 +71,7 @@ void print_usage(const char* prog)
 {
 	fprintf(stderr, "\n\n");
 	fprintf(stderr, "usage:\n");
-	fprintf(stderr, "%s [-j task] [-d dataset] [-o output] [-w working dir] [-t threads] [-n candidates] [-g 0/1]", prog);
+	fprintf(stderr, "%s [-j task] [-d dataset] [-o output] [-w working dir] [-t threads] [-n candidates] [-g 0/1] [-s kmer size] [-b kmer stride] [-r max kmer occurrences] [-f 0/1] [-e 0/1] [-L max read size]", prog);
 	fprintf(stderr, "\n\n");
 	fprintf(stderr, "options:\n");
 	fprintf(stderr, "-j <integer>\tjob: %d = seeding, %d = align\n\t\tdefault: %d\n", TASK_SEED, TASK_ALN, TASK_ALN);
@@ -68,6 +86,12 @@ void print_usage(const char* prog)
 	fprintf(stderr, "Default: %d if x = %d, %d if x = %d\n", kDefaultKmerMatchPacbio, TECH_PACBIO, kDefaultKmerMatchNanopore, TECH_NANOPORE);
 	fprintf(stderr, "-g <0/1>\twhether print gapped extension start point, 0 = no, 1 = yes\n\t\tDefault: 0\n");
 	fprintf(stderr, "-x <0/x>\tsequencing technology: 0 = pacbio, 1 = nanopore\n\t\tDefault: 0\n");
+	fprintf(stderr, "-s <integer>\tkmer size, %d - %d\n\t\tDefault: %d\n", kMinKmerSize, MAX_INDEX_KMER_SIZE, kDefaultKmerSize);
+	fprintf(stderr, "-b <integer>\tdistance between two kmers sampled from a read\n\t\tDefault: %d\n", kDefaultKmerStride);
+	fprintf(stderr, "-r <integer>\tkmers occurring more than r times in a volume are not used as seeds\n\t\tDefault: %d\n", kDefaultMaxKmerOcc);
+	fprintf(stderr, "-f <0/1>\toutput format: 0 = text, 1 = binary\n\t\tDefault: 0\n");
+	fprintf(stderr, "-e <0/1>\textension kernel of the diff: 0 = scalar, 1 = vectorized, with the same alignments\n\t\tx-drop is used instead of the diff if x = %d\n\t\tDefault: 0\n", TECH_NANOPORE);
+	fprintf(stderr, "-L <integer>\treads longer than L are skipped and counted\n\t\tDefault: %ld\n", DEFAULT_MAX_READ_SIZE);
 }
 
 int
@@ -88,8 +112,14 @@ parse_arguments(int argc, char* argv[], options_t* options)
 	int min_kmer_match = -1;
 	int output_gapped_start_point = -1;
 	int tech = TECH_PACBIO;
+	int kmer_size = -1;
+	int kmer_stride = -1;
+	int max_kmer_occ = -1;
+	int output_format = -1;
+	int ext_kernel = -1;
+	int max_read_size = -1;
     
-    while((opt_char = getopt(argc, argv, "j:d:o:w:t:n:g:x:a:k:")) != -1)
+    while((opt_char = getopt(argc, argv, "j:d:o:w:t:n:g:x:a:k:s:b:r:f:e:L:")) != -1)
     {
         switch(opt_char)
         {
@@ -117,6 +147,35 @@ parse_arguments(int argc, char* argv[], options_t* options)
 			case 'k':
 				min_kmer_match = atoi(optarg);
 				break;
+			case 's':
+				kmer_size = atoi(optarg);
+				break;
+			case 'b':
+				kmer_stride = atoi(optarg);
+				break;
+			case 'r':
+				max_kmer_occ = atoi(optarg);
+				break;
+			case 'f':
+				if (optarg[0] == '0') {
+					output_format = OVLP_FORMAT_TEXT;
+				} else if (optarg[0] == '1') {
+					output_format = OVLP_FORMAT_BINARY;
+				} else {
+					LOG(stderr, "argument to option \'-f\' must be either \'0\' or \'1\'");
+					return 1;
+				}
+				break;
+			case 'e':
+				if (optarg[0] == '0') {
+					ext_kernel = EXT_KERNEL_DIFF;
+				} else if (optarg[0] == '1') {
+					ext_kernel = EXT_KERNEL_SIMD;
+				} else {
+					LOG(stderr, "argument to option \'-e\' must be either \'0\' or \'1\'");
+					return 1;
+				}
+				break;
             case 'g':
                 if (optarg[0] == '0') 
                     output_gapped_start_point = 0;
@@ -128,6 +187,9 @@ parse_arguments(int argc, char* argv[], options_t* options)
                     return 1;
                 }
                 break;
+			case 'L':
+				max_read_size = atoi(optarg);
+				break;
 			case 'x':
 				if (optarg[0] == '0') {
 					tech = TECH_PACBIO;
@@ -160,6 +222,12 @@ parse_arguments(int argc, char* argv[], options_t* options)
 	if (min_align_size != -1) options->min_align_size = min_align_size;
 	if (min_kmer_match != -1) options->min_kmer_match = min_kmer_match;
 	if (output_gapped_start_point != -1) options->output_gapped_start_point = output_gapped_start_point;
+	if (kmer_size != -1) options->kmer_size = kmer_size;
+	if (kmer_stride != -1) options->kmer_stride = kmer_stride;
+	if (max_kmer_occ != -1) options->max_kmer_occ = max_kmer_occ;
+	if (output_format != -1) options->output_format = output_format;
+	if (ext_kernel != -1) options->ext_kernel = ext_kernel;
+	if (max_read_size != -1) options->max_read_size = max_read_size;
 	
 	if (options->task != TASK_SEED && options->task != TASK_ALN)
 	{
@@ -192,6 +260,26 @@ parse_arguments(int argc, char* argv[], options_t* options)
         LOG(stderr, "number of candidates must be > 0.");
         ret = 1;
     }
+    else if (options->kmer_size < kMinKmerSize || options->kmer_size > MAX_INDEX_KMER_SIZE)
+    {
+        LOG(stderr, "kmer size must be between %d and %d.", kMinKmerSize, MAX_INDEX_KMER_SIZE);
+        ret = 1;
+    }
+    else if (options->kmer_stride < 1)
+    {
+        LOG(stderr, "kmer stride must be > 0.");
+        ret = 1;
+    }
+    else if (options->max_kmer_occ < 1)
+    {
+        LOG(stderr, "max kmer occurrences must be > 0.");
+        ret = 1;
+    }
+    else if (options->max_read_size < 1)
+    {
+        LOG(stderr, "max read size must be > 0.");
+        ret = 1;
+    }
 
     if (ret) return ret;
 
@@ -18,6 +18,12 @@ typedef struct
 	int			min_kmer_match;
     int         output_gapped_start_point;
 	int 		tech;
+	int			kmer_size;
+	int			kmer_stride;
+	int			max_kmer_occ;
+	int			output_format;
+	int			ext_kernel;
+	int			max_read_size;
 } options_t;
 
 void
@@ -0,0 +1,118 @@
+#include "batch_queue.h"
+#include "../common/defs.h"
+
+ReadBatchQueue::ReadBatchQueue(const int num_batches)
+	: next_chunk_id(0), closed(false)
+{
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&slot_freed, NULL);
+	pthread_cond_init(&batch_queued, NULL);
+	for (int i = 0; i < num_batches; ++i)
+	{
+		Slot* slot = new Slot;
+		slots.push_back(slot);
+		free_slots.push_back(slot);
+	}
+}
+
+ReadBatchQueue::~ReadBatchQueue()
+{
+	r_assert(queued.empty());
+	for (size_t i = 0; i < slots.size(); ++i) delete slots[i];
+	pthread_cond_destroy(&batch_queued);
+	pthread_cond_destroy(&slot_freed);
+	pthread_mutex_destroy(&lock);
+}
+
+ReadBatch*
+ReadBatchQueue::get_free_batch()
+{
+	pthread_mutex_lock(&lock);
+	while (free_slots.empty()) pthread_cond_wait(&slot_freed, &lock);
+	Slot* slot = free_slots.back();
+	free_slots.pop_back();
+	pthread_mutex_unlock(&lock);
+	return &slot->batch;
+}
+
+void
+ReadBatchQueue::push(ReadBatch* batch)
+{
+	Slot* slot = NULL;
+	for (size_t i = 0; i < slots.size(); ++i)
+		if (&slots[i]->batch == batch) slot = slots[i];
+	r_assert(slot != NULL);
+
+	pthread_mutex_lock(&lock);
+	slot->num_chunks = (batch->size() + PLL - 1) / PLL;
+	slot->next_chunk = 0;
+	slot->done_chunks = 0;
+	if (slot->num_chunks == 0)
+	{
+		free_slots.push_back(slot);
+		pthread_cond_signal(&slot_freed);
+	}
+	else
+	{
+		queued.push_back(slot);
+		pthread_cond_broadcast(&batch_queued);
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+void
+ReadBatchQueue::close()
+{
+	pthread_mutex_lock(&lock);
+	closed = true;
+	pthread_cond_broadcast(&batch_queued);
+	pthread_mutex_unlock(&lock);
+}
+
+bool
+ReadBatchQueue::get_chunk(ReadChunk& chunk)
+{
+	pthread_mutex_lock(&lock);
+	Slot* slot = NULL;
+	while (1)
+	{
+		// the batches at the front may have all their chunks handed out but still being mapped
+		for (size_t i = 0; i < queued.size(); ++i)
+			if (queued[i]->next_chunk < queued[i]->num_chunks)
+			{
+				slot = queued[i];
+				break;
+			}
+		if (slot || closed) break;
+		pthread_cond_wait(&batch_queued, &lock);
+	}
+	if (slot)
+	{
+		const int c = slot->next_chunk++;
+		chunk.reads = slot->batch.reads.data() + c * PLL;
+		chunk.num_reads = MIN(PLL, slot->batch.size() - c * PLL);
+		chunk.chunk_id = next_chunk_id++;
+		chunk.owner = slot;
+	}
+	pthread_mutex_unlock(&lock);
+	return slot != NULL;
+}
+
+void
+ReadBatchQueue::finish_chunk(const ReadChunk& chunk)
+{
+	Slot* slot = (Slot*)chunk.owner;
+	pthread_mutex_lock(&lock);
+	if (++slot->done_chunks == slot->num_chunks)
+	{
+		for (std::deque<Slot*>::iterator it = queued.begin(); it != queued.end(); ++it)
+			if (*it == slot)
+			{
+				queued.erase(it);
+				break;
+			}
+		free_slots.push_back(slot);
+		pthread_cond_signal(&slot_freed);
+	}
+	pthread_mutex_unlock(&lock);
+}
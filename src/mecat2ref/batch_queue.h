@@ -0,0 +1,67 @@
+#ifndef BATCH_QUEUE_H
+#define BATCH_QUEUE_H
+
+#include "read_batch.h"
+
+#include <pthread.h>
+
+#include <deque>
+#include <vector>
+
+// a chunk of at most PLL consecutive reads of a batch, the unit of work of a mapping thread.
+// the chunks are numbered consecutively from 0 through all the batches.
+struct ReadChunk
+{
+	ReadFasta*  reads;
+	int         num_reads;
+	long        chunk_id;
+	void*       owner;
+};
+
+// the batches of reads shared by the persistent mapping threads.
+// the loading thread fills the free batches and queues them, and the mapping threads take
+// the chunks of the queued batches in order. a thread that finds every chunk of a batch
+// handed out goes on with the next queued batch instead of waiting for the others to
+// finish, and a batch is given back for loading once all its chunks are mapped.
+class ReadBatchQueue
+{
+public:
+	ReadBatchQueue(const int num_batches);
+	~ReadBatchQueue();
+
+	// waits until a batch can be loaded
+	ReadBatch* get_free_batch();
+
+	// queues a loaded batch for mapping, an empty batch is given back at once
+	void push(ReadBatch* batch);
+
+	// no more batches will be queued
+	void close();
+
+	// waits for the next chunk to map, returns false when every chunk
+	// has been handed out and the queue is closed
+	bool get_chunk(ReadChunk& chunk);
+
+	// the chunk has been mapped
+	void finish_chunk(const ReadChunk& chunk);
+
+private:
+	struct Slot
+	{
+		ReadBatch  batch;
+		int        num_chunks;
+		int        next_chunk;
+		int        done_chunks;
+	};
+
+	pthread_mutex_t     lock;
+	pthread_cond_t      slot_freed;
+	pthread_cond_t      batch_queued;
+	std::vector<Slot*>  slots;
+	std::vector<Slot*>  free_slots;
+	std::deque<Slot*>   queued;
+	long                next_chunk_id;
+	bool                closed;
+};
+
+#endif // BATCH_QUEUE_H
@@ -0,0 +1,64 @@
+#include "bgzf.h"
+#include "../common/defs.h"
+
+#include <zlib.h>
+#include <cstring>
+
+// input of a block, so that a compressed block always fits in 64 KB
+#define BGZF_BLOCK_INPUT 0xff00
+#define BGZF_HEADER_SIZE 18
+#define BGZF_FOOTER_SIZE 8
+#define BGZF_MAX_BLOCK_SIZE 0x10000
+
+const char bgzf_eof_block[28] = {
+	'\x1f', '\x8b', '\x08', '\x04', 0, 0, 0, 0, 0, '\xff', '\x06', 0, 'B', 'C', '\x02', 0,
+	'\x1b', 0, '\x03', 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static void
+put_le(u1_t* p, const u4_t v, const int bytes)
+{
+	for (int i = 0; i < bytes; ++i) p[i] = (v >> (8 * i)) & 0xff;
+}
+
+// compresses size bytes of data into one block at out, returns the block size
+static size_t
+bgzf_compress_block(const char* data, const size_t size, u1_t* out)
+{
+	static const u1_t header[BGZF_HEADER_SIZE - 2] = {
+		0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0
+	};
+	memcpy(out, header, BGZF_HEADER_SIZE - 2);
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(z_stream));
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		ERROR("failed to initialize zlib");
+	zs.next_in = (Bytef*)data;
+	zs.avail_in = size;
+	zs.next_out = out + BGZF_HEADER_SIZE;
+	zs.avail_out = BGZF_MAX_BLOCK_SIZE - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE;
+	if (deflate(&zs, Z_FINISH) != Z_STREAM_END) ERROR("failed to compress a BGZF block");
+	const size_t cdata_size = zs.total_out;
+	deflateEnd(&zs);
+
+	const size_t block_size = BGZF_HEADER_SIZE + cdata_size + BGZF_FOOTER_SIZE;
+	put_le(out + 16, block_size - 1, 2);
+	u1_t* footer = out + BGZF_HEADER_SIZE + cdata_size;
+	put_le(footer, crc32(crc32(0L, Z_NULL, 0), (const Bytef*)data, size), 4);
+	put_le(footer + 4, size, 4);
+	return block_size;
+}
+
+char*
+bgzf_compress(const char* data, const size_t size, size_t* compressed_size)
+{
+	const size_t num_blocks = (size + BGZF_BLOCK_INPUT - 1) / BGZF_BLOCK_INPUT;
+	u1_t* out;
+	safe_malloc(out, u1_t, num_blocks * BGZF_MAX_BLOCK_SIZE + 1);
+	size_t n = 0;
+	for (size_t i = 0; i < size; i += BGZF_BLOCK_INPUT)
+		n += bgzf_compress_block(data + i, MIN((size_t)BGZF_BLOCK_INPUT, size - i), out + n);
+	*compressed_size = n;
+	return (char*)out;
+}
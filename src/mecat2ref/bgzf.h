@@ -0,0 +1,16 @@
+#ifndef BGZF_H
+#define BGZF_H
+
+#include <stddef.h>
+
+// compresses data into BGZF blocks, the gzip members with the block size in their
+// extra field that BAM files are made of. the blocks are independent, so that chunks
+// of a file can be compressed in parallel and concatenated.
+// returns a malloc'ed buffer of *compressed_size bytes.
+char*
+bgzf_compress(const char* data, const size_t size, size_t* compressed_size);
+
+// the empty block that ends a BGZF file
+extern const char bgzf_eof_block[28];
+
+#endif // BGZF_H
@@ -9,9 +9,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <dirent.h>
-#define RM 100000
 
 #include "output.h"
+#include "ref_index.h"
 #include "../common/defs.h"
 
 static const char* prog_name = NULL;
@@ -23,6 +23,12 @@ static int output_format = FMT_REF;
 static const int kDefaultOutputFormat = FMT_REF;
 static int tech;
 static const int kDefaultTech = TECH_PACBIO;
+static int ext_kernel;
+static const int kDefaultExtKernel = EXT_KERNEL_DIFF;
+static int seed_sampling;
+static const int kDefaultSeedSampling = SEED_STRIDED;
+static double seed_freq_fraction;
+static int max_read_size;
 
 typedef struct
 {
@@ -35,6 +41,10 @@ typedef struct
 	int			num_output;
 	int			output_format;
 	int 		tech;
+	int			ext_kernel;
+	int			seed_sampling;
+	double		seed_freq_fraction;
+	int			max_read_size;
 } meap_ref_options;
 
 void init_meap_ref_options(meap_ref_options* options)
@@ -48,24 +58,50 @@ void init_meap_ref_options(meap_ref_options* options)
 	options->num_output = kDefaultNumOutput;
 	options->output_format = kDefaultOutputFormat;
 	options->tech = kDefaultTech;
+	options->ext_kernel = kDefaultExtKernel;
+	options->seed_sampling = kDefaultSeedSampling;
+	options->seed_freq_fraction = DEFAULT_SEED_FREQ_FRACTION;
+	options->max_read_size = DEFAULT_MAX_READ_SIZE;
 }
 
 void print_usage()
 {
 	fprintf(stderr, "\n\n");
 	fprintf(stderr, "usage:\n");
-	fprintf(stderr, "%s [-d reads] [-r reference] [-o output] [-w working dir] [-t threads]", prog_name);
+	fprintf(stderr, "%s [-d reads] [-r reference] [-o output] [-w working dir] [-t threads]\n", prog_name);
+	fprintf(stderr, "%s index [-r reference] [-o index] [-s seeds] [-f fraction]", prog_name);
 	fprintf(stderr, "\n\n");
 	fprintf(stderr, "options:\n");
 	fprintf(stderr, "-d <string>\treads file name\n");
-	fprintf(stderr, "-r <string>\treference file name\n");
+	fprintf(stderr, "-r <string>\treference file name, either a fasta file or an index built by '%s index'\n", prog_name);
 	fprintf(stderr, "-o <string>\toutput file name\n");
 	fprintf(stderr, "-w <string>\tworking folder name, will be created if not exist\n");
 	fprintf(stderr, "-t <integer>\tnumber of cput threads\n\t\tdefault: 1\n");
 	fprintf(stderr, "-n <integer>\tnumber of of candidates for gap extension\n\t\tdefault: %d\n", kDefaultNumCandidates);
 	fprintf(stderr, "-b <integer>\toutput the best b alignments\n\t\tdefault: %d\n", kDefaultNumOutput);
-	fprintf(stderr, "-m <0/1/2>\toutput format: 0 = ref, 1 = m4, 2 = sam\n\t\tdefault: %d\n", kDefaultOutputFormat);
+	fprintf(stderr, "-m <0/1/2/3>\toutput format: 0 = ref, 1 = m4, 2 = sam, 3 = bam\n\t\tdefault: %d\n", kDefaultOutputFormat);
 	fprintf(stderr, "-x <0/1>\tsequencing technology: 0 = pacbio, 1 = nanopore\n\t\tdefault: %d\n", kDefaultTech);
+	fprintf(stderr, "-e <0/1>\textension kernel of the diff: 0 = scalar, 1 = vectorized, with the same alignments\n\t\tnanopore reads are always aligned with x-drop\n\t\tdefault: %d\n", kDefaultExtKernel);
+	fprintf(stderr, "-s <0/1>\tseeds: 0 = all reference k-mers, k-mers sampled every few bases in the reads, 1 = minimizers\n\t\tignored if the reference is an index\n\t\tdefault: %d\n", kDefaultSeedSampling);
+	fprintf(stderr, "-f <real>\tfraction of the most frequent seeds that are ignored\n\t\tignored if the reference is an index\n\t\tdefault: %g\n", DEFAULT_SEED_FREQ_FRACTION);
+	fprintf(stderr, "-L <integer>\treads longer than L are skipped and counted\n\t\tdefault: %ld\n", DEFAULT_MAX_READ_SIZE);
+}
+
+static int
+parse_seed_sampling(const char* arg)
+{
+	if (arg[0] == '0' && arg[1] == '\0') return SEED_STRIDED;
+	if (arg[0] == '1' && arg[1] == '\0') return SEED_MINIMIZER;
+	ERROR("Invalid argument to option 's': %s\n", arg);
+}
+
+static double
+parse_seed_freq_fraction(const char* arg)
+{
+	char* end;
+	double f = strtod(arg, &end);
+	if (*end != '\0' || f < 0 || f >= 1) ERROR("Invalid argument to option 'f': %s\n", arg);
+	return f;
 }
 
 int
@@ -77,7 +113,7 @@ param_read_t(int argc, char* argv[], meap_ref_options* options)
 	int ret = 1;
 	
 	init_meap_ref_options(options);
-	while((opt_char = getopt(argc, argv, "d:r:w:o:t:n:b:m:x:")) != -1)
+	while((opt_char = getopt(argc, argv, "d:r:w:o:t:n:b:m:x:e:s:f:L:")) != -1)
 	{
 		switch(opt_char)
 		{
@@ -114,6 +150,24 @@ param_read_t(int argc, char* argv[], meap_ref_options* options)
 					ERROR("Invalid argument to option 'x': %s\n", optarg);
 				}
 				break;
+			case 'e':
+				if (optarg[0] == '0') {
+					options->ext_kernel = EXT_KERNEL_DIFF;
+				} else if (optarg[0] == '1') {
+					options->ext_kernel = EXT_KERNEL_SIMD;
+				} else {
+					ERROR("Invalid argument to option 'e': %s\n", optarg);
+				}
+				break;
+			case 's':
+				options->seed_sampling = parse_seed_sampling(optarg);
+				break;
+			case 'f':
+				options->seed_freq_fraction = parse_seed_freq_fraction(optarg);
+				break;
+			case 'L':
+				options->max_read_size = atoi(optarg);
+				break;
 			case ':':
 				err_char = (char)optopt;
 				fprintf(stderr, "Error: unrecogised option \'%c\'\n", err_char);
@@ -142,6 +196,10 @@ param_read_t(int argc, char* argv[], meap_ref_options* options)
 		options_err_msg = "candidates must be > 0";
 	else if (options->num_output < 1)
 		options_err_msg = "output alignments must be > 0";
+	else if (options->output_format < FMT_REF || options->output_format > FMT_BAM)
+		options_err_msg = "output format must be 0, 1, 2 or 3";
+	else if (options->max_read_size < 1)
+		options_err_msg = "max read size must be > 0";
 	if (options_err_msg)
 	{
 		fprintf(stderr, "Error: %s\n", options_err_msg);
@@ -189,250 +247,30 @@ int str2num(char *str)
     }
     return (sum);
 }
-int chang_fastqfile(const char *fastaq, const char *fenfolder)
-{
-    FILE *fp, *ot;
-    int kk = 0,read_len;
-    char read_name[1000], onedata[RM], buff1[1000], buff2[RM], *fq, tempstr[200], *oq,ch;
-    sprintf(tempstr, "%s/0.fq", fenfolder);
-    fp = fopen(fastaq, "r");
-    ot = fopen(tempstr, "w");
-    fq = (char *)malloc(100000000);
-    setvbuf(fp, fq, _IOFBF, 100000000);
-    oq = (char *)malloc(100000000);
-    setvbuf(ot, oq, _IOFBF, 100000000);
-	int num_read_items;
-    ch=getc(fp);
-    if(ch=='>')
-    {
-        kk=0;
-        for (; ch!=EOF; ch=getc(fp))
-        {
-            if(ch=='>')
-            {
-                num_read_items = fscanf(fp,"%[^\n]s",read_name);
-				assert(num_read_items = 1);
-                if(kk>0)
-                {
-                    onedata[read_len]='\0';
-                    fprintf(ot, "%d\t\%d\t%s\n", kk-1,read_len,onedata);
-                    read_len=0;
-                    kk++;
-                }
-                else
-                {
-                    kk++;
-                    read_len=0;
-                }
-            }
-            else if(ch!='\n'&&ch!='\r')onedata[read_len++]=ch;
-        }
-        onedata[read_len]='\0';
-        fprintf(ot, "%d\t\%d\t%s\n", kk-1,read_len,onedata);
-    }
-    else
-    {
-        fseek(fp, 0L, SEEK_SET);
-        while (fscanf(fp, "%[^\n]s", read_name) != EOF && fscanf(fp, "%s\n", onedata) != EOF && fscanf(fp, "%[^\n]s", buff1) != EOF && fscanf(fp, "%s\n", buff2) != EOF)
-        {
-            read_len=strlen(onedata);
-            fprintf(ot, "%d\t%d\t%s\n", ++kk,read_len,onedata);
-        }
-    }
-    fclose(fp);
-    fclose(ot);
-    free(fq);
-    free(oq);
-    return (kk);
-
-}
-
 int firsttask(int argc, char *argv[])
 {
 	meap_ref_options* options = (meap_ref_options*)malloc(sizeof(meap_ref_options));
 	int flag = param_read_t(argc, argv, options);
 	if (flag == -1) { print_usage(); exit(1); }
 	
-    int readcount = chang_fastqfile(options->reads, options->wrk_dir);
 	char kkkkk[1024];
     sprintf(kkkkk, "config.txt");
     FILE* fileout = fopen(kkkkk, "w");
-    fprintf(fileout, "%s\n%s\n%s\n%s\n%d\t%d\n", options->wrk_dir, options->reference, options->reads, options->output, options->num_cores, readcount);
+    fprintf(fileout, "%s\n%s\n%s\n%s\n%d\n", options->wrk_dir, options->reference, options->reads, options->output, options->num_cores);
     fclose(fileout);
 	int corenum = options->num_cores;
 	num_candidates = options->num_candidates;
 	num_output = options->num_output;
 	output_format = options->output_format;
 	tech = options->tech;
+	ext_kernel = options->ext_kernel;
+	seed_sampling = options->seed_sampling;
+	seed_freq_fraction = options->seed_freq_fraction;
+	max_read_size = options->max_read_size;
 	free(options);
     return (corenum);
 }
 
-int cmp_temp_result_ptr(const void* a, const void* b)
-{
-	TempResult* pa = *(TempResult**)a;
-	TempResult* pb = *(TempResult**)b;
-	if (pa->aln_size > pb->aln_size) return -1;
-	if (pa->aln_size == pb->aln_size) return 0;
-	return 1;
-}
-
-int get_chr_id(fastaindexinfo* chr_idx, const int num_chr, const long offset)
-{
-	int left = 0, right = num_chr, mid = 0;
-	while (left < right)
-	{
-		mid = (left + right) >> 1;
-		if (offset >= chr_idx[mid].chrstart)
-		{
-			if (mid == num_chr - 1) break;
-			if (offset < chr_idx[mid + 1].chrstart) break;
-			left = mid + 1;
-		}
-		else
-		{
-			right = mid;
-		}
-	}
-	return mid;
-}
-
-void
-filter_contained_results(TempResult** pptr, const int num_results, int* valid)
-{
-	int i = 0, j;
-	int b1, e1, id1, b2, e2, id2;
-	
-	for (i = 0; i < num_results; ++i) valid[i] = 1;
-	for (i = 0; i < num_results - 1; ++i)
-	{
-		if (!valid[i]) continue;
-		b1 = pptr[i]->qb;
-		e1 = pptr[i]->qe;
-		id1 = pptr[i]->read_id;
-		for (j = i + 1; j < num_results; ++j)
-		{
-			if (!valid[j]) continue;
-			b2 = pptr[j]->qb;
-			e2 = pptr[j]->qe;
-			id2 = pptr[j]->read_id;
-			if (id2 != id1) continue;
-			if (pptr[i]->read_dir != pptr[j]->read_dir) continue;
-			if (b2 >= b1 && e2 <= e1) valid[j] = 0;
-		}
-	}
-}
-
-void
-output_query_results(fastaindexinfo* chr_idx, const int num_chr, TempResult** pptr, const int num_results, FILE* out)
-{
-	//int valid[num_results];
-	//qsort(pptr, num_results, sizeof(TempResult*), cmp_temp_result_ptr);
-	//filter_contained_results(pptr, num_results, valid);
-	const int n = num_results;
-	int output_cnt = 0;
-	int i;
-	for (i = 0; i < n; ++i)
-	{
-		//if (!valid[i]) continue;
-		int sid = get_chr_id(chr_idx, num_chr, pptr[i]->sb);
-		output_one_result(pptr[i]->read_id,
-						  chr_idx[sid].chrname,
-						  pptr[i]->read_dir,
-						  pptr[i]->qb,
-						  pptr[i]->qe,
-						  pptr[i]->qs,
-						  pptr[i]->vscore,
-						  pptr[i]->sb - chr_idx[sid].chrstart,
-						  pptr[i]->se - chr_idx[sid].chrstart,
-						  chr_idx[sid].chrsize,
-						  pptr[i]->qmap,
-						  pptr[i]->smap,
-						  output_format,
-						  out);
-		++output_cnt;
-		if (output_cnt == num_output) break;
-	}
-}
-
-int result_combine(int readcount, int filecount, char *workpath, char *outfile, char *fastaq, int main_argc, char* main_argv[])
-{
-	char path[1024], buffer[1024];
-	sprintf(path, "%s/chrindex.txt", workpath);
-	FILE* chr_idx_file = fopen(path, "r");
-	if (!chr_idx_file) { fprintf(stderr, "failed to open file %s for reading.\n", path); abort(); }
-	int num_chr = 0;
-	while(fgets(buffer, 1024, chr_idx_file)) ++num_chr;
-	--num_chr;
-	fastaindexinfo* chr_idx = (fastaindexinfo*)malloc(sizeof(fastaindexinfo) * num_chr);
-	fseek(chr_idx_file, 0L, SEEK_SET);
-	int i, flag;
-	for (i = 0; i < num_chr; ++i)
-	{
-		flag = fscanf(chr_idx_file, "%ld\t%s\t%ld\n", &chr_idx[i].chrstart, chr_idx[i].chrname, &chr_idx[i].chrsize);
-		assert(flag == 3);
-	}
-	fclose(chr_idx_file);
-	chr_idx_file = NULL;
-	
-	fprintf(stderr, "output file name: %s\n", outfile);
-	FILE* out = fopen(outfile, "w");
-	char* out_buffer = (char*)malloc(8192);
-	setvbuf(out, out_buffer, _IOFBF, 8192);
-	
-	if (output_format == FMT_SAM)
-	{
-		print_sam_header(out);
-		print_sam_references(chr_idx, num_chr, out);
-		print_sam_program(main_argc, main_argv, out);
-	}
-	
-	const int trsize = num_candidates + 6;
-	TempResult* pptr[trsize];
-	for (i = 0; i < trsize; ++i) pptr[i] = create_temp_result();
-	int num_results = 0;
-	TempResult* trslt = create_temp_result();
-	char* trf_buffer = (char*)malloc(8192);
-	for (i = 1; i <= filecount; ++i)
-	{
-		sprintf(path, "%s/%d.r", workpath, i);
-		FILE* thread_results_file = fopen(path, "r");
-		if (!thread_results_file) { fprintf(stderr, "failed to open file %s for reading.\n", path); abort(); }
-		setvbuf(thread_results_file, trf_buffer, _IOFBF, 8192);
-		num_results = 0;
-		int rok = load_temp_result(trslt, thread_results_file);
-		if (rok) { copy_temp_result(trslt, pptr[num_results]); ++num_results; }
-		int last_qid = pptr[0]->read_id;
-		while (rok)
-		{
-			rok = load_temp_result(trslt, thread_results_file);
-			if (!rok) break;
-
-			if (trslt->read_id != last_qid)
-			{
-				output_query_results(chr_idx, num_chr, pptr, num_results, out);
-				num_results = 0;
-			}
-			
-			last_qid = trslt->read_id;
-			copy_temp_result(trslt, pptr[num_results]);
-			++num_results;
-		}
-		if (num_results) output_query_results(chr_idx, num_chr, pptr, num_results, out);
-		
-		fclose(thread_results_file);
-	}
-	
-	for (i = 0; i < trsize; ++i) pptr[i] = destroy_temp_result(pptr[i]);
-	destroy_temp_result(trslt);
-	fclose(out);
-	free(out_buffer);
-	free(trf_buffer);
-	free(chr_idx);
-	
-	return 0;
-}
-
 long get_file_size(const char *path)
 {
     long filesize = -1;
@@ -448,7 +286,7 @@ long get_file_size(const char *path)
     return filesize;
 }
 
-extern int meap_ref_impl_large(int, int, int);
+extern int meap_ref_impl_large(int, int, int, int, int, int, double, int, int, char**);
 
 #define __run_system(cmd) \
 	do { \
@@ -456,9 +294,65 @@ extern int meap_ref_impl_large(int, int, int);
 	if (__rc_status != 0) { fprintf(stderr, "[%s, %u] system() error. Error code is %d.\n", __func__, __LINE__, __rc_status); exit(1); } \
 } while (0);
 
+// mecat2ref index -r reference -o index [-s seeds] [-f fraction]
+// builds the reference index once so that the mapping runs can share it
+int build_index_main(int argc, char* argv[])
+{
+	const char* reference = NULL;
+	const char* output = NULL;
+	int sampling = kDefaultSeedSampling;
+	double freq_fraction = DEFAULT_SEED_FREQ_FRACTION;
+	int opt_char;
+	opterr = 0;
+	while((opt_char = getopt(argc, argv, "r:o:s:f:")) != -1)
+	{
+		switch(opt_char)
+		{
+			case 'r':
+				reference = optarg;
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			case 's':
+				sampling = parse_seed_sampling(optarg);
+				break;
+			case 'f':
+				freq_fraction = parse_seed_freq_fraction(optarg);
+				break;
+			default:
+				print_usage();
+				return EXIT_FAILURE;
+		}
+	}
+	if (!reference || !output)
+	{
+		fprintf(stderr, "Error: reference and index must be specified\n");
+		print_usage();
+		return EXIT_FAILURE;
+	}
+	if (is_ref_index_file(reference))
+	{
+		fprintf(stderr, "Error: %s is already a reference index\n", reference);
+		return EXIT_FAILURE;
+	}
+	
+	struct timeval tpstart, tpend;
+	gettimeofday(&tpstart, NULL);
+	RefIndex refidx;
+	refidx.build(reference, 13, sampling == SEED_MINIMIZER ? REF_MINIMIZER_WINDOW : 0, freq_fraction);
+	refidx.save(output);
+	gettimeofday(&tpend, NULL);
+	float timeuse = 1000000 * (tpend.tv_sec - tpstart.tv_sec) + tpend.tv_usec - tpstart.tv_usec;
+	timeuse /= 1000000;
+	fprintf(stderr, "The Building Reference Index Time: %f sec\n", timeuse);
+	return EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
 	prog_name = argv[0];
+	if (argc > 1 && strcmp(argv[1], "index") == 0) return build_index_main(argc - 1, argv + 1);
 	
     char cmd[300], outfile[200];
     int corenum;
@@ -466,8 +360,7 @@ int main(int argc, char *argv[])
     struct timeval tpstart, tpend;
     struct timeval mapstart, mapend;
     float timeuse;
-    char saved[150], fastqfile[150], fastafile[150], tempstr[150];
-    int  readcount;
+    char saved[150], fastqfile[150], fastafile[150];
     FILE *fid1, *fid2;
 
     gettimeofday(&tpstart, NULL);
@@ -489,18 +382,16 @@ int main(int argc, char *argv[])
     read_results = fgets(outfile, 150, fid1);
 	assert(read_results);
     outfile[strlen(outfile) - 1] = '\0';
-    int num_read_items = fscanf(fid1, "%d %d\n", &corenum,&readcount);
-	assert(num_read_items == 2);
+    int num_read_items = fscanf(fid1, "%d\n", &corenum);
+	assert(num_read_items == 1);
     fclose(fid1);
     filelength=get_file_size(fastafile);
     gettimeofday(&mapstart, NULL);
-	meap_ref_impl_large(num_candidates, num_output, tech);
+	meap_ref_impl_large(num_candidates, num_output, tech, ext_kernel, output_format, seed_sampling, seed_freq_fraction, max_read_size, argc, argv);
     gettimeofday(&mapend, NULL);
     timeuse = 1000000 * (mapend.tv_sec - mapstart.tv_sec) + mapend.tv_usec - mapstart.tv_usec;
     timeuse /= 1000000;
 
-    sprintf(tempstr,"%s/0.fq",saved);
-    result_combine(readcount, corenum, saved, outfile,tempstr, argc, argv);
     gettimeofday(&tpend, NULL);
     timeuse = 1000000 * (tpend.tv_sec - tpstart.tv_sec) + tpend.tv_usec - tpstart.tv_usec;
     timeuse /= 1000000;
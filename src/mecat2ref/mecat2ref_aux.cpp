@@ -83,7 +83,7 @@ int find_location(int *t_loc,int *t_seedn,int *t_score,long *loc,int k,int *rep_
 }
 
 void
-extract_sequences(const char* raw_ref,
+extract_sequences(const PackedRef& ref,
 				  const char* raw_read,
 				  const long ref_start,
 				  const int read_start,
@@ -101,15 +101,8 @@ extract_sequences(const char* raw_ref,
 	right_ref_size = min(R2, (long)(R * 1.2));
 	const u1_t* et = get_dna_encode_table();
 	
-	const char* rs = raw_ref + ref_start - left_ref_size;
-	const char* re = raw_ref + ref_start + right_ref_size;
-	tstr.clear();
-	for (const char* r = rs; r != re; ++r) {
-		u1_t c = *r;
-		c = et[c];
-		if (c > 3) c = 0;
-		tstr.push_back((char)c);
-	}
+	tstr.resize(left_ref_size + right_ref_size);
+	ref.decode(ref_start - left_ref_size, ref_start + right_ref_size, tstr.data());
 	
 	qstr.clear();
 	for (int i = 0; i < read_size; ++i) {
@@ -122,7 +115,7 @@ extract_sequences(const char* raw_ref,
 
 bool extend_candidate(candidate_save& can,
 					  GapAligner* aligner,
-					  const char* raw_ref,
+					  const PackedRef& ref,
 					  const long ref_size,
 					  const char* fwd_raw_read,
 					  const char* rev_raw_read,
@@ -139,7 +132,7 @@ bool extend_candidate(candidate_save& can,
 	int read_start = can.loc2;
 	long ref_start = can.loc1 - 1;
 	long left_ref_size, right_ref_size;
-	extract_sequences(raw_ref, 
+	extract_sequences(ref, 
 					  raw_read, 
 					  ref_start, 
 					  read_start,
@@ -160,6 +153,7 @@ bool extend_candidate(candidate_save& can,
 		r.qs = read_len;
 		r.sb = ref_start - left_ref_size + aligner->target_start();
 		r.se = ref_start - left_ref_size + aligner->target_end();
+		reserve_temp_result(&r, strlen(aligner->query_mapped_string()) + 1);
 		strcpy(r.qmap, aligner->query_mapped_string());
 		strcpy(r.smap, aligner->target_mapped_string());
 
@@ -311,7 +305,7 @@ rescue_clipped_align(AlignInfo* alnv,
 					  TempResult* results,
 					  int& nresults,
 					  GapAligner* aligner,
-					  const char* raw_ref,
+					  const PackedRef& ref,
 					  const long ref_size,
 					  const char* fwd_raw_read,
 					  const char* rev_raw_read,
@@ -365,7 +359,7 @@ rescue_clipped_align(AlignInfo* alnv,
 		if (alnv[i].prev_id == -1 && find_left_clipped_candidate(alnv[i], can, database, block_size, read_len, BC, ddfs_cutoff)) {
 			bool r = extend_candidate(can, 
 							 aligner, 
-							 raw_ref, 
+							 ref, 
 							 ref_size,
 							 fwd_raw_read, 
 							 rev_raw_read, 
@@ -401,7 +395,7 @@ rescue_clipped_align(AlignInfo* alnv,
 		if (alnv[i].next_id == -1 && find_right_clipped_candidate(alnv[i], can, database, block_size, read_len, ref_size, BC, ddfs_cutoff)) {
 			bool r = extend_candidate(can, 
 									  aligner, 
-									  raw_ref, 
+									  ref, 
 									  ref_size,
 									  fwd_raw_read, 
 									  rev_raw_read, 
@@ -451,23 +445,52 @@ rescue_clipped_align(AlignInfo* alnv,
 	if (k) naln = k;
 }
 
+// MAPQ of the primary alignment, from the gap between its voting score and the best
+// voting score of the other alignments of the read
+static int
+primary_mapq(AlignInfo* alnv, const int naln, TempResult* results, const int primary)
+{
+	const int best = results[alnv[primary].id].vscore;
+	int second = 0;
+	for (int i = 0; i < naln; ++i) {
+		if (i == primary || alnv[i].parent_id != -1) continue;
+		second = max(second, results[alnv[i].id].vscore);
+	}
+	if (best <= 0 || second >= best) return 0;
+	return 60 * (best - second) / best;
+}
+
 void
 output_results(AlignInfo* alnv,
 			   int& naln,
 			   TempResult* results,
 			   int& nresults,
 			   int num_output,
+			   const char* read_name,
+			   const char* read,
+			   const fastaindexinfo* chr_idx,
+			   const int num_chr,
+			   const int format,
 			   FILE* out)
 {
-	int n = 0;
+	SamReadInfo sri;
+	sri.read_name = read_name;
+	sri.read = read;
+	int n = 0, m = 0, mapq = 0;
 	for (int i = 0; i < naln && n < num_output; ++i) {
 		if (alnv[i].parent_id != -1) continue;
-		int id = alnv[i].id;
-		output_temp_result(results + id, out);
-		id = alnv[i].prev_id;
-		if (id != -1) output_temp_result(results + id, out);
-		id = alnv[i].next_id;
-		if (id != -1) output_temp_result(results + id, out);
+		// the first alignment is the primary one and the clipped parts of it are supplementary,
+		// the other alignments and their parts are secondary
+		if (n == 0) mapq = primary_mapq(alnv, naln, results, i);
+		int ids[3] = { alnv[i].id, alnv[i].prev_id, alnv[i].next_id };
+		for (int j = 0; j < 3 && m < num_output; ++j) {
+			if (ids[j] == -1) continue;
+			if (n > 0) sri.flag = SAM_FLAG_SECONDARY;
+			else sri.flag = (j > 0) ? SAM_FLAG_SUPPLEMENTARY : 0;
+			sri.mapq = (n > 0) ? 0 : mapq;
+			output_temp_result(results + ids[j], chr_idx, num_chr, format, &sri, out);
+			++m;
+		}
 		++n;
 	}
 }
@@ -4,6 +4,7 @@
 #include "../common/gapalign.h"
 #include "output.h"
 #include "mecat2ref_defs.h"
+#include "packed_ref.h"
 #include <vector>
 
 struct AlignInfo
@@ -46,7 +47,7 @@ find_location(int *t_loc,int *t_seedn,int *t_score,long *loc,int k,int *rep_loc,
 
 bool extend_candidate(candidate_save& can,
 					  GapAligner* aligner,
-					  const char* raw_ref,
+					  const PackedRef& ref,
 					  const long ref_size,
 					  const char* fwd_raw_read,
 					  const char* rev_raw_read,
@@ -65,7 +66,7 @@ rescue_clipped_align(AlignInfo* alnv,
 					 TempResult* results,
 					 int& nresults,
 					 GapAligner* aligner,
-					 const char* raw_ref,
+					 const PackedRef& ref,
 					 const long ref_size,
 					 const char* fwd_raw_read,
 					 const char* rev_raw_read,
@@ -85,6 +86,11 @@ output_results(AlignInfo* alnv,
 			   TempResult* results,
 			   int& nresults,
 			   int num_output,
+			   const char* read_name,
+			   const char* read,
+			   const fastaindexinfo* chr_idx,
+			   const int num_chr,
+			   const int format,
 			   FILE* out);
 
 #define CLIPPED 2000
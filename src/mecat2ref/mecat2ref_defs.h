@@ -26,6 +26,10 @@
 #define MAX 10
 #define SVM 100000
 #define PLL 1000
+// the read positions of the minimizer seeds are kept in units of at least this many bases
+#define MINIMIZER_SEED_UNIT 2
+// largest seed number Back_List::seedno holds, longer reads are seeded more sparsely
+#define MAX_SEED_NO 65535
 
 typedef struct
 {
@@ -77,11 +81,14 @@ typedef struct
 {
     int readno,readlen;
     char *seqloc;
+    char *name;
 } ReadFasta;
 
 struct Back_List
 {
-    short int score, score2, loczhi[SM],seedno[SM],seednum;
+    short int score, score2, loczhi[SM];
+    unsigned short seedno[SM];
+    int seednum;
     int index;
 };
 
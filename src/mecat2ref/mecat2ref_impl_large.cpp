@@ -1,14 +1,25 @@
 #include "mecat2ref_defs.h"
 #include "output.h"
 #include "mecat2ref_aux.h"
+#include "ref_index.h"
+#include "read_batch.h"
+#include "result_writer.h"
+#include "batch_queue.h"
+#include "sam_record.h"
+#include "bgzf.h"
+#include "minimizer.h"
 #include "../common/diff_gapalign.h"
 #include "../common/xdrop_gapalign.h"
+#include "../common/kmer_extractor.h"
 
 #include <algorithm>
 using namespace std;
 
 static int MAXC = 0;
 static int TECH = TECH_PACBIO;
+static int EXT_KERNEL = EXT_KERNEL_DIFF;
+static int SEED_SAMPLING = SEED_STRIDED;
+static double SEED_FREQ_FRACTION = DEFAULT_SEED_FREQ_FRACTION;
 static int num_output = MAXC;
 static const double ddfs_cutoff_pacbio = 0.25;
 static const double ddfs_cutoff_nanopore = 0.1;
@@ -16,77 +27,41 @@ static double ddfs_cutoff = ddfs_cutoff_pacbio;
 
 static pthread_t *thread;
 static int threadnum=2;
-static FILE **outfile;
-static pthread_mutex_t mutilock; 
-static int runnumber=0,runthreadnum=0, readcount,terminalnum;
-static int *countin;
-static long **databaseindex,*allloc,seqcount,sumcount;
+static OrderedResultWriter *result_writer;
+static ReadBatchQueue *batch_queue;
+static fastaindexinfo *chr_idx;
+static int num_chr;
+static int output_format;
+static long seqcount;
+static RefIndex refidx;
 static int seed_len;
-static char *REFSEQ;
-static char *savework,workpath[300],fastqfile[300];
-static ReadFasta *readinfo;
+static char workpath[300],fastqfile[300];
 
-static long get_file_size(const char *path)
+static int transnum_buchang(char *seqm,int *value,int *endn,int len_str,int readnum,int BC,u1_t *pac)
 {
-    long filesize = -1;
-    struct stat statbuff;
-    if(stat(path, &statbuff) < 0)
-    {
-        return filesize;
-    }
-    else
-    {
-        filesize = statbuff.st_size;
-    }
-    return filesize;
-}
-
-static unsigned short atcttrans(char c)
-{
-    if(c=='A')return 0;
-    else if(c=='T')return 1;
-    else if(c=='C')return 2;
-    else if(c=='G')return 3;
-    else return 4;
-}
-
-static long sumvalue_x(int *intarry,int count)
-{
-    long i,sumval=0;
-    for(i=0; i<count; i++)
-    {
-        if(intarry[i]>0&&intarry[i]<129)sumval=sumval+intarry[i];
-        else if(intarry[i]>128)intarry[i]=0;
-    }
-    return(sumval);
+    *endn=(len_str-readnum)%BC;
+    return extract_strided_kmers_ascii(seqm,len_str,readnum,BC,pac,value);
 }
 
-static int transnum_buchang(char *seqm,int *value,int *endn,int len_str,int readnum,int BC)
+// the seeds of a read: its k-mers sampled every BC bases, or its minimizers when the
+// reference is indexed by minimizers. seedno[i] is the position of seed i in units of
+// BC bases plus 1; the minimizers take BC = MINIMIZER_SEED_UNIT for that. BC is raised
+// for the reads so long that their seed numbers would exceed MAX_SEED_NO.
+static int read_seeds(char *seqm,int len_str,int *BC,int *value,int *seedno,u1_t *pac)
 {
-    int eit=0,temp;
-    int i,j,start,num;
-    num=(len_str-readnum)/BC+1;
-    *endn=(len_str-readnum)%BC;
-    //if((len_str%readnum)>0)num=num+1;
-    for(i=0; i<num; i++)
+    int i,n,endn;
+    const int min_bc=(len_str+MAX_SEED_NO-1)/MAX_SEED_NO;
+    if(refidx.minimizer_window)
     {
-        eit=0;
-        start=i*BC;
-        //if(i==num-1){eit=0;start=len_str-readnum;}
-        for(j=0; j<readnum; j++)
-        {
-            temp=atcttrans(seqm[start+j]);
-            if(temp==4)
-            {
-                eit=-1;
-                break;
-            }
-            eit=eit<<2;
-            eit=eit+temp;
-        }
-        value[i]=eit;
+        *BC=max(MINIMIZER_SEED_UNIT,min_bc);
+        n=extract_minimizers_ascii(seqm,len_str,seed_len,refidx.minimizer_window,value,seedno);
+        for(i=0; i<n; i++)seedno[i]=seedno[i]/(*BC)+1;
+        return n;
     }
-    return(num);
+    if(*BC<min_bc)*BC=min_bc;
+    n=transnum_buchang(seqm,value,&endn,len_str,seed_len,*BC,pac);
+    for(i=0; i<n; i++)seedno[i]=i+1;
+    return n;
 }
 
 static void insert_loc(struct Back_List *spr,int loc,int seedn,float len)
@@ -132,164 +107,89 @@ static void insert_loc(struct Back_List *spr,int loc,int seedn,float len)
 
 static void creat_ref_index(char *fastafile)
 {
-    unsigned int eit,temp;
-    int  indexcount=0,leftnum=0;
-    long length,count,i,start, rsize = 0;
-    FILE *fasta,*fastaindex;
-    char *seq,ch,nameall[200];
-    //
-    if(seed_len==14)indexcount=268435456;
-    else if(seed_len==13)indexcount=67108864;
-    else if(seed_len==12)indexcount=16777216;
-    else if(seed_len==11)indexcount=4194304;
-    else if(seed_len==10)indexcount=1048576;
-    else if(seed_len==9)indexcount=262144;
-    else if(seed_len==8)indexcount=65536;
-    else if(seed_len==7)indexcount=16384;
-    else if(seed_len==6)indexcount=4096;
-    leftnum=34-2*seed_len;
-    //read reference seq
-    length=get_file_size(fastafile);
-    fasta=fopen(fastafile, "r");
-    sprintf(nameall,"%s/chrindex.txt",workpath);
-    fastaindex=fopen(nameall,"w");
+    if(is_ref_index_file(fastafile))refidx.load(fastafile);
+    else refidx.build(fastafile,seed_len,SEED_SAMPLING==SEED_MINIMIZER?REF_MINIMIZER_WINDOW:0,SEED_FREQ_FRACTION);
+    seed_len=refidx.seed_len;
+    seqcount=refidx.ref.size;
+}
 
-    REFSEQ=(char *)malloc((length+1000)*sizeof(char));
-    seq=REFSEQ;
-    for (ch=getc(fasta),count=0; ch!=EOF; ch=getc(fasta))
+// the sequences of the reference from its chromosome table
+static void load_chr_index()
+{
+    const char *line=refidx.chr_table.c_str(),*end=line+refidx.chr_table.size();
+    //the last line is the FileEnd line
+    num_chr=0;
+    for(const char *p=line; p<end; p++)if(*p=='\n')num_chr++;
+    if(num_chr>0)num_chr--;
+    safe_malloc(chr_idx,fastaindexinfo,num_chr);
+    for(int i=0; i<num_chr; i++)
     {
-        if(ch=='>')
-        {
-            assert(fscanf(fasta,"%[^\n]s",nameall) == 1);
-			if (rsize) fprintf(fastaindex, "%ld\n", rsize);
-			rsize = 0;
-			for(i=0;i<strlen(nameall);i++)if(nameall[i]==' '||nameall[i]=='\t')break;
-			nameall[i]='\0';
-            fprintf(fastaindex,"%ld\t%s\t",count,nameall);
-        }
-        else if(ch!='\n'&&ch!='\r')
-        {
-            if(ch>'Z')ch=toupper(ch);
-            seq[count]=ch;
-            count=count+1;
-			++rsize;
-        }
+        int flag=sscanf(line,"%ld\t%63s\t%ld\n",&chr_idx[i].chrstart,chr_idx[i].chrname,&chr_idx[i].chrsize);
+        r_assert(flag==3);
+        line=strchr(line,'\n')+1;
     }
-    fclose(fasta);
-	fprintf(fastaindex, "%ld\n", rsize);
-    fprintf(fastaindex,"%ld\t%s\n",count,"FileEnd");
-    seq[count]='\0';
-    fclose(fastaindex);
-    seqcount=count;
-    printf("%ld\n",seqcount);
-//printf("Constructing look-up table...\n");
-    countin=(int *)malloc((indexcount)*sizeof(int));
-    for(i=0; i<indexcount; i++)countin[i]=0;
+}
 
-// Count the number
-    eit=0;
-    start=0;
-    for(i=0; i<seqcount; i++)
-    {
-        if(seq[i]=='N'||(temp=atcttrans(seq[i]))==4)
-        {
-            eit=0;
-            start=0;
-            continue;
-        }
-        temp=atcttrans(seq[i]);
-        if(start<seed_len-1)
-        {
-            eit=eit<<2;
-            eit=eit+temp;
-            start=start+1;
-        }
-        else if(start>=seed_len-1)
-        {
-            eit=eit<<2;
-            eit=eit+temp;
-            start=start+1;
-            countin[eit]=countin[eit]+1;
-            eit=eit<<leftnum;
-            eit=eit>>leftnum;
-        }
-    }
 
+// the buffers of the read being mapped, grown with the longest read seen
+struct ReadBuffers
+{
+    int capacity;
+    int *mvalue,*mseedno;
+    u1_t *packed_read;
+    char *fwd,*rev;
+
+    ReadBuffers():capacity(0),mvalue(NULL),mseedno(NULL),packed_read(NULL),fwd(NULL),rev(NULL) {}
+    ~ReadBuffers() { release(); }
 
-//Max_index
-    sumcount=sumvalue_x(countin,indexcount);
-    allloc=(long *)malloc(sumcount*sizeof(long));
-    databaseindex=(long **)malloc((indexcount)*sizeof(long*));
-//allocate memory
-    sumcount=0;
-    for(i=0; i<indexcount; i++)
+    void reserve(const int read_len)
     {
-        if(countin[i]>0)
-        {
-            databaseindex[i]=allloc+sumcount;
-            sumcount=sumcount+countin[i];
-            countin[i]=0;
-        }
-        else databaseindex[i]=NULL;
+        if(read_len<capacity)return;
+        const int size=max(read_len+1,2*capacity);
+        release();
+        safe_malloc(mvalue,int,size);
+        safe_malloc(mseedno,int,size);
+        safe_malloc(packed_read,u1_t,size/4+8);
+        safe_malloc(fwd,char,size);
+        safe_malloc(rev,char,size);
+        capacity=size;
     }
 
-    // printf("xiao");//10834098
-
-//constructing the look-up table
-    eit=0;
-    start=0;
-    for(i=0; i<seqcount; i++)
+    void release()
     {
-        if(seq[i]=='N'||(temp=atcttrans(seq[i]))==4)
-        {
-            eit=0;
-            start=0;
-            continue;
-        }
-        temp=atcttrans(seq[i]);
-        if(start<seed_len-1)
-        {
-            eit=eit<<2;
-            eit=eit+temp;
-            start=start+1;
-        }
-        else if(start>=seed_len-1)
-        {
-            eit=eit<<2;
-            eit=eit+temp;
-            start=start+1;
-
-            if(databaseindex[eit]!=NULL)
-            {
-                countin[eit]=countin[eit]+1;
-                databaseindex[eit][countin[eit]-1]=i+2-seed_len;
-            }
-            eit=eit<<leftnum;
-            eit=eit>>leftnum;
-        }
+        free(mvalue);
+        free(mseedno);
+        free(packed_read);
+        free(fwd);
+        free(rev);
     }
-}
-
+};
 
-static void reference_mapping(int threadint)
+static void reference_mapping()
 {
     int cleave_num,read_len;
-    int mvalue[20000],flag_end;
-    long *leadarray,u_k,s_k,loc;
+    int *mvalue,*mseedno,flag_end;
+    u1_t *packed_read;
+    ReadBuffers read_buffers;
+    long leadarray,seedloc,u_k,s_k,loc;
     int count1=0,i,j,k,templong,read_name;
     struct Back_List *database,*temp_spr,*temp_spr1;
     int repeat_loc = 0,*index_list,*index_spr;
     long location_loc[4],left_length1,right_length1,left_length2,right_length2,loc_list,start_loc;
     short int *index_score,*index_ss;
     int temp_list[200],temp_seedn[200],temp_score[200];
-    int localnum,read_i,read_end,fileid;
+    int read_i;
+    ReadChunk chunk;
+    ReadFasta *readinfo;
     int endnum,ii;
-    char *seq,*onedata,onedata1[RM],onedata2[RM],FR;
+    char *onedata,*onedata1,*onedata2,FR;
+    FILE *chunk_out;
+    char *chunk_text;
+    size_t chunk_size;
     int cc1,canidatenum,loc_seed;
     int num1,num2,BC;
     int low,high,mid,seedcount;
     candidate_save canidate_loc[MAXC],canidate_temp;
-    seq=REFSEQ;
     j=seqcount/ZV+5;
 	
 	int* fwd_index_list = (int*)malloc(sizeof(int) * j);
@@ -312,46 +212,38 @@ static void reference_mapping(int threadint)
 	int naln;
 	TempResult results[MAXC + 6];
 	int nresults;
-	long aln_bytes = 1;
-	aln_bytes = aln_bytes * 2 * (MAXC + 6) * MAX_SEQ_SIZE;
-	char* aln_seqs = new char[aln_bytes];
-	u_k = 0;
 	for (int i = 0; i < MAXC + 6; ++i) {
-		results[i].qmap = aln_seqs + u_k;
-		u_k += MAX_SEQ_SIZE;
-		results[i].smap = aln_seqs + u_k;
-		u_k += MAX_SEQ_SIZE;
+		results[i].qmap = NULL;
+		results[i].smap = NULL;
+		results[i].map_capacity = 0;
 	}
 	
 	vector<char> qstr;
 	vector<char> tstr;
 	GapAligner* aligner = NULL;
 	if (TECH == TECH_PACBIO) {
-		aligner = new DiffAligner(0);
+		if (EXT_KERNEL == EXT_KERNEL_SIMD) aligner = new SimdDiffAligner(0);
+		else aligner = new DiffAligner(0);
 	} else if (TECH == TECH_NANOPORE) {
 		aligner = new XdropAligner(0);
 	} else {
 		ERROR("TECH must be either %d or %d", TECH_PACBIO, TECH_NANOPORE);
 	}
 
-    fileid=1;
-    while(fileid)
+    while(batch_queue->get_chunk(chunk))
     {
-        pthread_mutex_lock(&mutilock);
-        localnum=runnumber;
-        runnumber++;
-        pthread_mutex_unlock(&mutilock);
-        if(localnum>=terminalnum)
-        {
-            fileid=0;
-            break;
-        }
-        if(localnum==terminalnum-1)read_end=readcount;
-        else read_end=(localnum+1)*PLL;
-        for(read_i=localnum*PLL; read_i<read_end; read_i++)
+        readinfo=chunk.reads;
+        chunk_out=open_memstream(&chunk_text,&chunk_size);
+        for(read_i=0; read_i<chunk.num_reads; read_i++)
         {
             read_name=readinfo[read_i].readno;
             read_len=readinfo[read_i].readlen;
+            read_buffers.reserve(read_len);
+            mvalue=read_buffers.mvalue;
+            mseedno=read_buffers.mseedno;
+            packed_read=read_buffers.packed_read;
+            onedata1=read_buffers.fwd;
+            onedata2=read_buffers.rev;
             strcpy(onedata1,readinfo[read_i].seqloc);
 
             canidatenum=0;
@@ -409,20 +301,21 @@ static void reference_mapping(int threadint)
                 }
                 endnum=0;
                 read_len=strlen(onedata);
-                cleave_num=transnum_buchang(onedata,mvalue,&endnum,read_len,seed_len,BC);
+                cleave_num=read_seeds(onedata,read_len,&BC,mvalue,mseedno,packed_read);
                 j=0;
                 index_spr=index_list;
                 index_ss=index_score;
                 endnum=0;
                 for(k=0; k<cleave_num; k++)if(mvalue[k]>=0)
                     {
-                        count1=countin[mvalue[k]];
+                        count1=refidx.counts[mvalue[k]];
                         //if(count1>20)continue;
-                        leadarray=databaseindex[mvalue[k]];
+                        leadarray=refidx.offsets.get(mvalue[k]);
                         for(i=0; i<count1; i++,leadarray++)
                         {
-                            templong=(*leadarray)/ZV;
-                            u_k=(*leadarray)%ZV;
+                            seedloc=refidx.positions.get(leadarray);
+                            templong=seedloc/ZV;
+                            u_k=seedloc%ZV;
                             if(templong>=0)
                             {
                                 temp_spr=database+templong;
@@ -432,9 +325,9 @@ static void reference_mapping(int threadint)
                                     if(loc<=SM)
                                     {
                                         temp_spr->loczhi[loc-1]=u_k;
-                                        temp_spr->seedno[loc-1]=k+1;
+                                        temp_spr->seedno[loc-1]=mseedno[k];
                                     }
-                                    else insert_loc(temp_spr,u_k,k+1,BC);
+                                    else insert_loc(temp_spr,u_k,mseedno[k],BC);
                                     if(templong>0)s_k=temp_spr->score+(temp_spr-1)->score;
                                     else s_k=temp_spr->score;
                                     if(endnum<s_k)endnum=s_k;
@@ -567,7 +460,7 @@ static void reference_mapping(int threadint)
             {
 				extend_candidate(canidate_loc[i], 
 								 aligner, 
-								 seq, 
+								 refidx.ref, 
 								 seqcount,
 								 onedata1, 
 								 onedata2, 
@@ -586,7 +479,7 @@ static void reference_mapping(int threadint)
 								  results,
 								  nresults,
 								  aligner, 
-								  seq, 
+								  refidx.ref, 
 								  seqcount,
 								  onedata1, 
 								  onedata2, 
@@ -600,7 +493,7 @@ static void reference_mapping(int threadint)
 								  rev_database,
 								  ddfs_cutoff);
 			
-			output_results(alns, naln, results, nresults, num_output, outfile[threadint]);
+			output_results(alns, naln, results, nresults, num_output, readinfo[read_i].name, readinfo[read_i].seqloc, chr_idx, num_chr, output_format, chunk_out);
 			
 			for (int t = 0; t < fnblk; ++t) {
 				int bid = fwd_index_list[t];
@@ -615,7 +508,8 @@ static void reference_mapping(int threadint)
 				rev_database[bid].index = -1;
 			}
 
-			if (naln == 0)
+			// the minimizers of the read do not depend on BC, so there is no second try
+			if (naln == 0 && !refidx.minimizer_window)
             {
                 canidatenum=0;
                 for(ii=1; ii<=2; ii++)
@@ -672,20 +566,21 @@ static void reference_mapping(int threadint)
 
                     endnum=0;
                     read_len=strlen(onedata);
-                    cleave_num=transnum_buchang(onedata,mvalue,&endnum,read_len,seed_len,BC);
+                    cleave_num=read_seeds(onedata,read_len,&BC,mvalue,mseedno,packed_read);
                     j=0;
                     index_spr=index_list;
                     index_ss=index_score;
                     endnum=0;
                     for(k=0; k<cleave_num; k++)if(mvalue[k]>=0)
                         {
-                            count1=countin[mvalue[k]];
+                            count1=refidx.counts[mvalue[k]];
                             //if(count1>20)continue;
-                            leadarray=databaseindex[mvalue[k]];
+                            leadarray=refidx.offsets.get(mvalue[k]);
                             for(i=0; i<count1; i++,leadarray++)
                             {
-                                templong=(*leadarray)/ZVS;
-                                u_k=(*leadarray)%ZVS;
+                                seedloc=refidx.positions.get(leadarray);
+                                templong=seedloc/ZVS;
+                                u_k=seedloc%ZVS;
                                 if(templong>=0)
                                 {
                                     temp_spr=database+templong;
@@ -695,9 +590,9 @@ static void reference_mapping(int threadint)
                                         if(loc<=SM)
                                         {
                                             temp_spr->loczhi[loc-1]=u_k;
-                                            temp_spr->seedno[loc-1]=k+1;
+                                            temp_spr->seedno[loc-1]=mseedno[k];
                                         }
-                                        else insert_loc(temp_spr,u_k,k+1,BC);
+                                        else insert_loc(temp_spr,u_k,mseedno[k],BC);
                                         if(templong>0)s_k=temp_spr->score+(temp_spr-1)->score;
                                         else s_k=temp_spr->score;
                                         if(endnum<s_k)endnum=s_k;
@@ -830,7 +725,7 @@ static void reference_mapping(int threadint)
                 {
 					extend_candidate(canidate_loc[i], 
 									 aligner, 
-									 seq, 
+									 refidx.ref, 
 									 seqcount,
 									 onedata1, 
 									 onedata2, 
@@ -849,7 +744,7 @@ static void reference_mapping(int threadint)
 									  results,
 									  nresults,
 									  aligner, 
-									  seq, 
+									  refidx.ref, 
 									  seqcount,
 									  onedata1, 
 									  onedata2, 
@@ -863,7 +758,7 @@ static void reference_mapping(int threadint)
 									  rev_database,
 									  ddfs_cutoff);
 				
-				output_results(alns, naln, results, nresults, num_output, outfile[threadint]);
+				output_results(alns, naln, results, nresults, num_output, readinfo[read_i].name, readinfo[read_i].seqloc, chr_idx, num_chr, output_format, chunk_out);
 				
 				for (int t = 0; t < fnblk; ++t) {
 					int bid = fwd_index_list[t];
@@ -879,6 +774,15 @@ static void reference_mapping(int threadint)
 				}
             }
         }
+        fclose(chunk_out);
+        if(output_format==FMT_BAM)
+        {
+            char *bgzf_text=bgzf_compress(chunk_text,chunk_size,&chunk_size);
+            free(chunk_text);
+            chunk_text=bgzf_text;
+        }
+        result_writer->add(chunk.chunk_id,chunk_text,chunk_size);
+        batch_queue->finish_chunk(chunk);
     }
 	delete aligner;
     free(fwd_database);
@@ -887,63 +791,36 @@ static void reference_mapping(int threadint)
 	free(rev_database);
     free(rev_index_list);
     free(rev_index_score);
-	delete[] aln_seqs;
+	for (int i = 0; i < MAXC + 6; ++i) {
+		free(results[i].qmap);
+		free(results[i].smap);
+	}
 }
 
 
 static void* multithread(void* arg)
 {
-    int localthreadno;
-    pthread_mutex_lock(&mutilock);
-    localthreadno=runthreadnum;
-    runthreadnum++;
-    pthread_mutex_unlock(&mutilock);
-    reference_mapping(localthreadno);
+    reference_mapping();
 	return NULL;
 }
 
-static int load_fastq(FILE *fq)
-{
-    int readlen,readno,sum=0,flag;
-    char *pre;
-    readcount=0;
-    pre=savework;
-    while((flag=fscanf(fq,"%d\t%d\t%s\n",&readno,&readlen,pre))!=EOF&&readcount<SVM&&sum<MAXSTR)
-    {
-        readinfo[readcount].seqloc=pre;
-        readinfo[readcount].readno=readno;
-        readlen=strlen(pre);
-        readinfo[readcount].readlen=readlen;
-        sum=sum+readlen+1;
-        pre=pre+readlen+1;
-        readcount++;
-    }
-    if(flag!=EOF)
-    {
-        readinfo[readcount].seqloc=pre;
-        readinfo[readcount].readno=readno;
-        readlen=strlen(pre);
-        readinfo[readcount].readlen=readlen;
-        readcount++;
-        return(1);
-    }
-    else return(0);
-}
-
-
-int meap_ref_impl_large(int maxc, int noutput, int tech)
+int meap_ref_impl_large(int maxc, int noutput, int tech, int ext_kernel, int format, int seed_sampling, double seed_freq_fraction, int max_read_size, int argc, char* argv[])
 {
 	MAXC = maxc;
 	TECH = tech;
+	EXT_KERNEL = ext_kernel;
 	num_output = noutput;
+	output_format = format;
+	SEED_SAMPLING = seed_sampling;
+	SEED_FREQ_FRACTION = seed_freq_fraction;
     char tempstr[300],fastafile[300];
-    int corenum,readall;
-    int fileflag,threadno,threadflag;
-    FILE *fp,*fastq;
+    int corenum;
+    int threadno,threadflag;
+    FILE *fp;
     struct timeval tpstart, tpend;
     float timeuse;
     fp=fopen("config.txt","r");
-    assert(fscanf(fp,"%s\n%s\n%s\n%s\n%d %d\n",workpath,fastafile,fastqfile,tempstr,&corenum,&readall) == 6);
+    assert(fscanf(fp,"%s\n%s\n%s\n%s\n%d\n",workpath,fastafile,fastqfile,tempstr,&corenum) == 5);
     fclose(fp);
     threadnum=corenum;
     //building reference index
@@ -959,55 +836,63 @@ int meap_ref_impl_large(int maxc, int noutput, int tech)
 
     gettimeofday(&tpstart, NULL);
 
-    savework=(char *)malloc((MAXSTR+RM)*sizeof(char));
-    readinfo=(ReadFasta*)malloc((SVM+2)*sizeof(ReadFasta));
     thread=(pthread_t*)malloc(threadnum*sizeof(pthread_t));
-    outfile=(FILE **)malloc(threadnum*sizeof(FILE *));
-    for(threadno=0; threadno<threadnum; threadno++)
+    load_chr_index();
+    fprintf(stderr, "output file name: %s\n", tempstr);
+    FILE* out = fopen(tempstr, "w");
+    if (!out) ERROR("failed to open file %s for writing", tempstr);
+    char* out_buffer = (char*)malloc(8192);
+    setvbuf(out, out_buffer, _IOFBF, 8192);
+    if (output_format == FMT_SAM)
     {
-        sprintf(tempstr,"%s/%d.r",workpath,threadno+1);
-        outfile[threadno]=fopen(tempstr,"w");
+        print_sam_header(out);
+        print_sam_references(chr_idx, num_chr, out);
+        print_sam_program(argc, argv, out);
     }
-    sprintf(tempstr,"%s/0.fq",workpath);
-    fastq=fopen(tempstr,"r");
-    //multi process thread
-    fileflag=1;
-    while(fileflag)
+    else if (output_format == FMT_BAM)
     {
-        fileflag=load_fastq(fastq);
-        if(readcount%PLL==0)terminalnum=readcount/PLL;
-        else terminalnum=readcount/PLL+1;
-        if(readcount<=0)break;
-        runnumber=0;
-        runthreadnum=0;
-
-
-        pthread_mutex_init(&mutilock,NULL);
-        //creat thread
-        if(readcount>0)
+        char *text,*bgzf_text;
+        size_t text_size,bgzf_size;
+        FILE *text_out=open_memstream(&text,&text_size);
+        print_sam_header(text_out);
+        print_sam_references(chr_idx, num_chr, text_out);
+        print_sam_program(argc, argv, text_out);
+        fclose(text_out);
+        std::vector<char> header;
+        build_bam_header(text, text_size, chr_idx, num_chr, header);
+        free(text);
+        bgzf_text=bgzf_compress(header.data(),header.size(),&bgzf_size);
+        fwrite(bgzf_text,1,bgzf_size,out);
+        free(bgzf_text);
+    }
+    result_writer = new OrderedResultWriter(out);
+    //the mapping threads run until every read is mapped. the main thread loads the
+    //next batch of reads meanwhile, and a thread done with the chunks of one batch
+    //goes on with the next batch without waiting for the others
+    batch_queue = new ReadBatchQueue(2);
+    for(threadno=0; threadno<threadnum; threadno++)
+    {
+        threadflag= pthread_create(&thread[threadno], NULL, multithread, NULL);
+        if(threadflag)
         {
-            for(threadno=0; threadno<threadnum; threadno++)
-            {
-                threadflag= pthread_create(&thread[threadno], NULL, multithread, NULL);
-                if(threadflag)
-                {
-                    printf("ERROR; return code is %d\n", threadflag);
-                    return EXIT_FAILURE;
-                }
-            }
-            //waiting thread
-            for(threadno=0; threadno<threadnum; threadno++)pthread_join(thread[threadno],NULL);
-
+            printf("ERROR; return code is %d\n", threadflag);
+            return EXIT_FAILURE;
         }
-
-        // reference_mapping(1);
     }
-    fclose(fastq);
+    ReadBatchLoader loader(fastqfile,max_read_size);
+    while(1)
+    {
+        ReadBatch* batch=batch_queue->get_free_batch();
+        if(!loader.load(*batch))break;
+        batch_queue->push(batch);
+    }
+    if(loader.num_skipped_reads())
+        LOG(stderr,"%ld reads longer than %d are skipped",loader.num_skipped_reads(),max_read_size);
+    batch_queue->close();
+    for(threadno=0; threadno<threadnum; threadno++)pthread_join(thread[threadno],NULL);
+    delete batch_queue;
     //clear creat index memory
-    free(countin);
-    free(databaseindex);
-    free(allloc);
-    free(REFSEQ);
+    refidx.clear();
 
     gettimeofday(&tpend, NULL);
     timeuse = 1000000 * (tpend.tv_sec - tpstart.tv_sec) + tpend.tv_usec - tpstart.tv_usec;
@@ -1016,10 +901,11 @@ int meap_ref_impl_large(int maxc, int noutput, int tech)
     fprintf(fp, "The Mapping Time: %f sec\n", timeuse);
     fclose(fp);
 
-    for(threadno=0; threadno<threadnum; threadno++)fclose(outfile[threadno]);
-    free(outfile);
-    free(savework);
-    free(readinfo);
+    delete result_writer;
+    if(output_format==FMT_BAM)fwrite(bgzf_eof_block,1,sizeof(bgzf_eof_block),out);
+    fclose(out);
+    free(out_buffer);
+    free(chr_idx);
     free(thread);
     return 0;
 }
@@ -0,0 +1,47 @@
+#include "minimizer.h"
+
+namespace {
+
+struct MinimizerCollector
+{
+	int* kmer_ids;
+	int* positions;
+	int  n;
+
+	void operator()(const u4_t kmer, const long pos) {
+		kmer_ids[n] = kmer;
+		positions[n] = pos;
+		++n;
+	}
+};
+
+}
+
+int
+extract_minimizers_ascii(const char* s, const int size, const int kmer_size, const int window,
+						 int* kmer_ids, int* positions)
+{
+	const u1_t* encode = get_dna_encode_table();
+	const u4_t mask = ((u4_t)1 << (2 * kmer_size)) - 1;
+	MinimizerSampler sampler(kmer_size, window);
+	MinimizerCollector c;
+	c.kmer_ids = kmer_ids;
+	c.positions = positions;
+	c.n = 0;
+	u4_t kmer = 0;
+	int valid = 0;
+	for (int i = 0; i < size; ++i)
+	{
+		const u1_t e = encode[(u1_t)s[i]];
+		if (e > 3)
+		{
+			kmer = 0;
+			valid = 0;
+			sampler.reset();
+			continue;
+		}
+		kmer = ((kmer << 2) | e) & mask;
+		if (++valid >= kmer_size) sampler.add(kmer, i + 1 - kmer_size, c);
+	}
+	return c.n;
+}
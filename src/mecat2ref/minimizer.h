@@ -0,0 +1,92 @@
+#ifndef MINIMIZER_H
+#define MINIMIZER_H
+
+#include "../common/defs.h"
+
+// largest minimizer window
+#define MAX_MINIMIZER_WINDOW 32
+
+// invertible hash of a k-mer of 2 * kmer_size bits, so that the order of the
+// k-mers does not follow their bases and no two k-mers share a hash
+static inline u8_t
+minimizer_hash(u8_t key, const int kmer_size)
+{
+	const u8_t mask = ((u8_t)1 << (2 * kmer_size)) - 1;
+	key = (~key + (key << 21)) & mask;
+	key = key ^ key >> 24;
+	key = ((key + (key << 3)) + (key << 8)) & mask;
+	key = key ^ key >> 14;
+	key = ((key + (key << 2)) + (key << 4)) & mask;
+	key = key ^ key >> 28;
+	key = (key + (key << 31)) & mask;
+	return key;
+}
+
+// (w, k) minimizer sampling: of every window consecutive k-mers the one of the
+// smallest hash is kept, the leftmost one on ties. the k-mers of a sequence are
+// fed in order by add(), and reset() starts a new sequence, or a new stretch of
+// it after bases other than A, C, G or T.
+// the reference and the reads are sampled the same way, so that a k-mer kept in
+// a read is found in the index wherever it is kept in the reference.
+class MinimizerSampler
+{
+public:
+	MinimizerSampler(const int kmer_size, const int window)
+		: kmer_size(kmer_size), window(window) {
+		r_assert(window > 0 && window <= MAX_MINIMIZER_WINDOW);
+		reset();
+	}
+
+	void reset() {
+		n = 0;
+		min_i = -1;
+		last_pos = -1;
+	}
+
+	// the k-mer starting at pos is the next one. f(kmer, pos) is called for the minimizer of
+	// every complete window, once for the consecutive windows that share it.
+	template <typename F>
+	void add(const u4_t kmer, const long pos, F& f) {
+		Entry& e = entries[n % window];
+		e.hash = minimizer_hash(kmer, kmer_size);
+		e.kmer = kmer;
+		e.pos = pos;
+		if (min_i >= 0 && min_i + window <= n) {
+			// the minimizer left the window
+			min_i = n - window + 1;
+			for (long i = min_i + 1; i <= n; ++i)
+				if (entries[i % window].hash < entries[min_i % window].hash) min_i = i;
+		} else if (min_i < 0 || e.hash < entries[min_i % window].hash) {
+			min_i = n;
+		}
+		++n;
+		if (n >= window && entries[min_i % window].pos != last_pos) {
+			const Entry& m = entries[min_i % window];
+			last_pos = m.pos;
+			f(m.kmer, m.pos);
+		}
+	}
+
+private:
+	struct Entry
+	{
+		u8_t hash;
+		u4_t kmer;
+		long pos;
+	};
+
+	int   kmer_size;
+	int   window;
+	Entry entries[MAX_MINIMIZER_WINDOW];
+	long  n;
+	long  min_i;
+	long  last_pos;
+};
+
+// the minimizers of an ascii sequence. minimizer i is kmer_ids[i], starting at base positions[i].
+// the k-mers containing a base other than A, C, G or T are skipped. returns the number of minimizers.
+int
+extract_minimizers_ascii(const char* s, const int size, const int kmer_size, const int window,
+						 int* kmer_ids, int* positions);
+
+#endif // MINIMIZER_H
@@ -1,4 +1,5 @@
 #include "output.h"
+#include "sam_record.h"
 
 #include <assert.h>
 #include <string.h>
@@ -113,79 +114,6 @@ void print_sam_program(int argc, char* argv[], FILE* out)
 	fprintf(out, "PN:mecat2ref\n");
 }
 
-void
-output_cigar(const int qstart,
-			 const int qend,
-			 const int qsize,
-			 const char* qmap,
-			 const char* smap,
-			 FILE* out)
-{
-	int qlen = strlen(qmap);
-	int slen = strlen(smap);
-	assert(qlen == slen);
-	if (qstart) fprintf(out, "%dH", qstart);
-	int i = 0, j, n = qlen;
-	while (i < n)
-	{
-		if (qmap[i] == '-') // delete from reference
-		{
-			j = i + 1;
-			while (j < n && qmap[j] == '-') ++j;
-			fprintf(out, "%dD", j - i);
-		}
-		else if (smap[i] == '-') // insertion into reference
-		{
-			j = i + 1;
-			while (j < n && smap[j] == '-') ++j;
-			fprintf(out, "%dI", j - i);
-		}
-		else // match or mismatch
-		{
-			j = i + 1;
-			while (j < n && qmap[j] != '-' && smap[j] != '-') ++j;
-			fprintf(out, "%dM", j - i);
-		}
-		i = j;
-	}
-	if (qend != qsize) fprintf(out, "%dH", qsize - qend);
-}
-
-void
-output_sam(const int read_id,
-		   const char* chr_name,
-		   const char qdir,
-		   const int qstart,
-		   const int qend,
-		   const int qsize,
-		   const int vscore,
-		   const long sstart,
-		   const long send,
-		   const long ssize,
-		   const char* qmap,
-		   const char* smap,
-		   FILE* out)
-{
-	int flag = 0;
-	if (qdir == 'R') flag = 0x10; // SEQ being reverse complemented
-	fprintf(out, "%d\t", read_id); /// 1) qname
-	fprintf(out, "%d\t", flag); /// 2) flag
-	fprintf(out, "%s\t", chr_name); /// 3) rname
-	fprintf(out, "%ld\t", sstart + 1); /// 4) 1-based left most position
-	fprintf(out, "255\t"); /// 5) mapq
-	output_cigar(qstart, qend, qsize, qmap, smap, out); /// 6) cigar
-	fprintf(out, "\t");
-	fprintf(out, "*\t"); /// 7) rnext
-	fprintf(out, "0\t"); /// 8) pnext
-	fprintf(out, "0\t"); /// 9) tlen
-	/// 10) seq
-	const int n = strlen(qmap);
-	int i;
-	for (i = 0; i < n; ++i) if (qmap[i] != '-') fprintf(out, "%c", qmap[i]);
-	fprintf(out, "\t");
-	fprintf(out, "*\n"); /// 11) qual
-}
-		   
 void
 output_one_result(const int read_id,
 				  const char* chr_name,
@@ -206,8 +134,6 @@ output_one_result(const int read_id,
 		print_ref_result(read_id,chr_name,qdir,qstart,qend,qsize,vscore,sstart,send,ssize,qmap,smap,out);
 	else if (format == 1)
 		print_m4_result(read_id,chr_name,qdir,qstart,qend,qsize,vscore,sstart,send,ssize,qmap,smap,out);
-	else if (format == 2)
-		output_sam(read_id,chr_name,qdir,qstart,qend,qsize,vscore,sstart,send,ssize,qmap,smap,out);
 }
 
 void
@@ -235,45 +161,62 @@ set_temp_result(int read_id,
 	result->smap = smap;
 }
 
-void
-output_temp_result(TempResult* result, FILE* out)
+int
+get_chr_id(const fastaindexinfo* chr_idx, const int num_chr, const long offset)
 {
-	fprintf(out, "%d\t%c\t%d\t%d\t%d\t%d\t%ld\t%ld\n%s\n%s\n",
-				 result->read_id,
-				 result->read_dir,
-				 result->vscore,
-				 result->qb,
-				 result->qe,
-				 result->qs,
-				 result->sb,
-				 result->se,
-				 result->qmap,
-				 result->smap);
+	int left = 0, right = num_chr, mid = 0;
+	while (left < right)
+	{
+		mid = (left + right) >> 1;
+		if (offset >= chr_idx[mid].chrstart)
+		{
+			if (mid == num_chr - 1) break;
+			if (offset < chr_idx[mid + 1].chrstart) break;
+			left = mid + 1;
+		}
+		else
+		{
+			right = mid;
+		}
+	}
+	return mid;
 }
 
-int
-load_temp_result(TempResult* result, FILE* in)
+void
+output_temp_result(const TempResult* result, const fastaindexinfo* chr_idx, const int num_chr, const int format, const SamReadInfo* sri, FILE* out)
 {
-	int r = fscanf(in, "%d\t%c\t%d\t%d\t%d\t%d\t%ld\t%ld\n%s\n%s\n",
-				   &result->read_id,
-				   &result->read_dir,
-				   &result->vscore,
-				   &result->qb,
-				   &result->qe,
-				   &result->qs,
-				   &result->sb,
-				   &result->se,
-				   result->qmap,
-				   result->smap);
-	return (r == EOF) ? 0 : 1;
+	int sid = get_chr_id(chr_idx, num_chr, result->sb);
+	if (format == FMT_SAM)
+	{
+		output_sam(result, chr_idx[sid].chrname, chr_idx[sid].chrstart, sri, out);
+		return;
+	}
+	if (format == FMT_BAM)
+	{
+		output_bam(result, sid, chr_idx[sid].chrstart, sri, out);
+		return;
+	}
+	output_one_result(result->read_id,
+					  chr_idx[sid].chrname,
+					  result->read_dir,
+					  result->qb,
+					  result->qe,
+					  result->qs,
+					  result->vscore,
+					  result->sb - chr_idx[sid].chrstart,
+					  result->se - chr_idx[sid].chrstart,
+					  chr_idx[sid].chrsize,
+					  result->qmap,
+					  result->smap,
+					  format,
+					  out);
 }
 
 TempResult*
 create_temp_result()
 {
 	TempResult* result = (TempResult*)calloc(sizeof(TempResult), 1);
-	result->qmap = (char*)malloc(100000);
-	result->smap = (char*)malloc(100000);
+	reserve_temp_result(result, 100000);
 	return result;
 }
 
@@ -286,6 +229,17 @@ destroy_temp_result(TempResult* result)
 	return NULL;
 }
 
+void
+reserve_temp_result(TempResult* result, const int map_size)
+{
+	if (map_size <= result->map_capacity) return;
+	result->map_capacity = (map_size > 2 * result->map_capacity) ? map_size : 2 * result->map_capacity;
+	free(result->qmap);
+	free(result->smap);
+	result->qmap = (char*)malloc(result->map_capacity);
+	result->smap = (char*)malloc(result->map_capacity);
+}
+
 void
 copy_temp_result(TempResult* src, TempResult* dst)
 {
@@ -297,6 +251,7 @@ copy_temp_result(TempResult* src, TempResult* dst)
 	dst->qs = src->qs;
 	dst->sb = src->sb;
 	dst->se = src->se;
+	reserve_temp_result(dst, strlen(src->qmap) + 1);
 	strcpy(dst->qmap, src->qmap);
 	strcpy(dst->smap, src->smap);
 }
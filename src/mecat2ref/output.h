@@ -6,6 +6,7 @@
 #define FMT_REF 0
 #define FMT_M4 1
 #define FMT_SAM 2
+#define FMT_BAM 3
 
 typedef struct 
 {
@@ -50,29 +51,6 @@ void print_sam_references(fastaindexinfo* fii, const int num_chr, FILE* out);
 
 void print_sam_program(int argc, char* argv[], FILE* out);
 
-void
-output_cigar(const int qstart,
-			const int qend,
-			const int qsize,
-			const char* qmap,
-			const char* smap,
-			FILE* out);
-
-void
-output_sam(const int read_id,
-		   const char* chr_name,
-		   const char qdir,
-		   const int qstart,
-		   const int qend,
-		   const int qsize,
-		   const int vscore,
-		   const long sstart,
-		   const long send,
-		   const long ssize,
-		   const char* qmap,
-		   const char* smap,
-		   FILE* out);
-
 void
 output_one_result(const int read_id,
 				  const char* chr_name,
@@ -102,6 +80,7 @@ typedef struct
 	int aln_size;
 	char* qmap;
 	char* smap;
+	int map_capacity;	// size of qmap and smap
 } TempResult;
 
 TempResult*
@@ -110,6 +89,10 @@ create_temp_result();
 TempResult*
 destroy_temp_result(TempResult* result);
 
+// makes qmap and smap of result hold map_size characters, the stored alignment is lost
+void
+reserve_temp_result(TempResult* result, const int map_size);
+
 void
 copy_temp_result(TempResult* src, TempResult* dst);
 
@@ -126,10 +109,26 @@ set_temp_result(int read_id,
 				char* smap,
 				TempResult* result);
 
-void
-output_temp_result(TempResult* result, FILE* out);
-
+// index of the sequence of chr_idx that contains offset
 int
-load_temp_result(TempResult* result, FILE* in);
+get_chr_id(const fastaindexinfo* chr_idx, const int num_chr, const long offset);
+
+#define SAM_FLAG_REVERSE 0x10
+#define SAM_FLAG_SECONDARY 0x100
+#define SAM_FLAG_SUPPLEMENTARY 0x800
+
+// what a SAM or BAM record needs besides the alignment
+typedef struct
+{
+	const char* read_name;
+	const char* read;	// the read as given, in forward direction
+	int flag;			// SAM_FLAG_SECONDARY or SAM_FLAG_SUPPLEMENTARY, the strand is added from the result
+	int mapq;
+} SamReadInfo;
+
+// outputs result in format, its offsets are converted to offsets in the sequence that contains it.
+// sri is only used by the SAM and BAM formats.
+void
+output_temp_result(const TempResult* result, const fastaindexinfo* chr_idx, const int num_chr, const int format, const SamReadInfo* sri, FILE* out);
 
 #endif // _OUTPUT_H
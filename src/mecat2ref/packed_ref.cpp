@@ -0,0 +1,29 @@
+#include "packed_ref.h"
+
+#include <cstring>
+
+void
+PackedRef::reserve(const long max_size)
+{
+	const long bytes = (max_size + 3) / 4;
+	if (bytes <= capacity) return;
+	pac = (u1_t*)realloc(pac, bytes);
+	r_assert(pac);
+	memset(pac + capacity, 0, bytes - capacity);
+	capacity = bytes;
+}
+
+void
+PackedRef::decode(const long from, const long to, char* codes) const
+{
+	for (long i = from; i < to; ++i) codes[i - from] = code(i);
+}
+
+void
+RefPositions::alloc(const long n, const long max_value)
+{
+	if (max_value >= (1L << 40)) ERROR("reference is too long (%ld bases)", max_value);
+	safe_malloc(lo, u4_t, n + 1);
+	hi = NULL;
+	if (max_value > (long)0xffffffffL) safe_malloc(hi, u1_t, n + 1);
+}
@@ -0,0 +1,96 @@
+#ifndef PACKED_REF_H
+#define PACKED_REF_H
+
+#include "../common/defs.h"
+
+#include <vector>
+
+// the reference bases packed 2 bits each, 4 to a byte.
+// bases other than A, C, G and T are packed as A and the runs of them are
+// kept in a side table, so that they can still be told apart from A.
+struct PackedRef
+{
+	struct NRun
+	{
+		long start;
+		long size;
+	};
+
+	u1_t* pac;
+	long size;
+	long capacity;
+	std::vector<NRun> nruns;
+
+	PackedRef() : pac(NULL), size(0), capacity(0) {}
+	~PackedRef() { clear(); }
+
+	void clear() {
+		free(pac);
+		pac = NULL;
+		size = capacity = 0;
+		nruns.clear();
+	}
+
+	// room for max_size bases
+	void reserve(const long max_size);
+
+	// appends an ascii base
+	void add_base(const char c) {
+		const u1_t e = get_dna_encode_table()[(u1_t)c];
+		if (e > 3) {
+			if (nruns.empty() || nruns.back().start + nruns.back().size != size) {
+				NRun r;
+				r.start = size;
+				r.size = 0;
+				nruns.push_back(r);
+			}
+			++nruns.back().size;
+		} else {
+			pac[size >> 2] |= e << ((size & 3) << 1);
+		}
+		++size;
+	}
+
+	// code 0..3 of base i, 0 for the bases of the N runs
+	int code(const long i) const {
+		return (pac[i >> 2] >> ((i & 3) << 1)) & 3;
+	}
+
+	// writes the codes of bases [from, to) to codes
+	void decode(const long from, const long to, char* codes) const;
+};
+
+// seed positions of the reference.
+// the low 32 bits of every position are held in lo, the 8 bits above them in hi
+// only when the largest position does not fit in 32 bits.
+struct RefPositions
+{
+	u4_t* lo;
+	u1_t* hi;
+
+	RefPositions() : lo(NULL), hi(NULL) {}
+	~RefPositions() { clear(); }
+
+	void clear() {
+		free(lo);
+		free(hi);
+		lo = NULL;
+		hi = NULL;
+	}
+
+	// room for n positions no greater than max_value
+	void alloc(const long n, const long max_value);
+
+	long get(const long i) const {
+		long p = lo[i];
+		if (hi) p |= ((long)hi[i]) << 32;
+		return p;
+	}
+
+	void set(const long i, const long p) {
+		lo[i] = (u4_t)p;
+		if (hi) hi[i] = (u1_t)(p >> 32);
+	}
+};
+
+#endif // PACKED_REF_H
@@ -0,0 +1,58 @@
+#include "read_batch.h"
+
+#include <zlib.h>
+
+// the first character of a fastq file is '@'
+static bool
+is_fastq_file(const char* path)
+{
+	gzFile in = gzopen(path, "rb");
+	if (!in) ERROR("cannot open file \'%s\' for reading", path);
+	int c;
+	while ((c = gzgetc(in)) != -1 && isspace(c));
+	gzclose(in);
+	return c == '@';
+}
+
+ReadBatchLoader::ReadBatchLoader(const char* reads_file, const int max_read_size)
+	: reader(reads_file), max_read_size(max_read_size), num_skipped(0)
+{
+	next_read_id = is_fastq_file(reads_file) ? 1 : 0;
+}
+
+bool
+ReadBatchLoader::load(ReadBatch& batch)
+{
+	batch.seqs.clear();
+	batch.reads.clear();
+	long num_bases = 0;
+	while (batch.size() < SVM && num_bases < MAXSTR)
+	{
+		if (reader.read_one_seq(seq) == -1) break;
+		const int read_len = seq.size();
+		if (read_len > max_read_size) { ++next_read_id; ++num_skipped; continue; }
+		ReadFasta rf;
+		rf.readno = next_read_id++;
+		rf.readlen = read_len;
+		rf.seqloc = NULL;
+		rf.name = NULL;
+		batch.reads.push_back(rf);
+		batch.seqs.insert(batch.seqs.end(), seq.sequence().begin(), seq.sequence().begin() + read_len);
+		batch.seqs.push_back('\0');
+		const char* name = seq.header().begin();
+		int name_len = 0;
+		while (name_len < seq.header().size() && name_len < MAX_READ_NAME_SIZE && !isspace(name[name_len])) ++name_len;
+		batch.seqs.insert(batch.seqs.end(), name, name + name_len);
+		batch.seqs.push_back('\0');
+		num_bases += read_len + 1;
+	}
+	// seqs is not resized any more
+	char* seqloc = batch.seqs.data();
+	for (int i = 0; i < batch.size(); ++i) {
+		batch.reads[i].seqloc = seqloc;
+		seqloc += batch.reads[i].readlen + 1;
+		batch.reads[i].name = seqloc;
+		seqloc += strlen(seqloc) + 1;
+	}
+	return batch.size() > 0;
+}
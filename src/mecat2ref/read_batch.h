@@ -0,0 +1,44 @@
+#ifndef READ_BATCH_H
+#define READ_BATCH_H
+
+#include "mecat2ref_defs.h"
+#include "../common/fasta_reader.h"
+
+#include <vector>
+
+// reads loaded from the reads file.
+// seqloc and name of every read point into seqs, the name is the header up to the first blank
+struct ReadBatch
+{
+	std::vector<char> seqs;
+	std::vector<ReadFasta> reads;
+
+	int size() const { return reads.size(); }
+};
+
+// longest read name kept, the limit of SAM and BAM
+#define MAX_READ_NAME_SIZE 254
+
+// streams the reads of a fasta or fastq file, plain or gzip compressed, in batches
+// of at most SVM reads or MAXSTR bases. the reads are numbered from 0 in a fasta
+// file and from 1 in a fastq file. reads longer than max_read_size are skipped,
+// they keep their numbers.
+class ReadBatchLoader
+{
+public:
+	ReadBatchLoader(const char* reads_file, const int max_read_size);
+
+	// loads the next batch, returns false when no read is left
+	bool load(ReadBatch& batch);
+
+	long num_skipped_reads() const { return num_skipped; }
+
+private:
+	FastaReader reader;
+	Sequence    seq;
+	int         next_read_id;
+	int         max_read_size;
+	long        num_skipped;
+};
+
+#endif // READ_BATCH_H
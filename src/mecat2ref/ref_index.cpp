@@ -0,0 +1,355 @@
+#include "ref_index.h"
+#include "minimizer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+struct RefIndexHeader
+{
+	char magic[8];
+	u4_t version;
+	u4_t seed_len;
+	i8_t ref_size;
+	i8_t num_nruns;
+	i8_t indexcount;
+	i8_t sumcount;
+	i8_t chr_table_size;
+	u4_t offsets_hi;
+	u4_t positions_hi;
+	u4_t minimizer_window;
+	u4_t occ_cutoff;
+};
+
+// the sections of an index file, each starting at a multiple of 8 bytes
+enum {
+	kSecPac,
+	kSecNRuns,
+	kSecCounts,
+	kSecOffsetsLo,
+	kSecOffsetsHi,
+	kSecPositionsLo,
+	kSecPositionsHi,
+	kSecChrTable,
+	kNumSections
+};
+
+static size_t
+section_layout(const RefIndexHeader& h, size_t* off)
+{
+	size_t bytes[kNumSections];
+	bytes[kSecPac] = (h.ref_size + 3) / 4;
+	bytes[kSecNRuns] = h.num_nruns * sizeof(PackedRef::NRun);
+	bytes[kSecCounts] = h.indexcount;
+	bytes[kSecOffsetsLo] = (h.indexcount + 1) * sizeof(u4_t);
+	bytes[kSecOffsetsHi] = h.offsets_hi ? h.indexcount + 1 : 0;
+	bytes[kSecPositionsLo] = h.sumcount * sizeof(u4_t);
+	bytes[kSecPositionsHi] = h.positions_hi ? h.sumcount : 0;
+	bytes[kSecChrTable] = h.chr_table_size;
+	size_t p = (sizeof(RefIndexHeader) + 7) & ~(size_t)7;
+	for (int i = 0; i < kNumSections; ++i) {
+		off[i] = p;
+		p = (p + bytes[i] + 7) & ~(size_t)7;
+	}
+	return p;
+}
+
+void
+RefIndex::clear()
+{
+	if (map_addr) {
+		ref.pac = NULL;
+		counts = NULL;
+		offsets.lo = NULL;
+		offsets.hi = NULL;
+		positions.lo = NULL;
+		positions.hi = NULL;
+		munmap(map_addr, map_size);
+		map_addr = NULL;
+		map_size = 0;
+	}
+	ref.clear();
+	free(counts);
+	counts = NULL;
+	offsets.clear();
+	positions.clear();
+	chr_table.clear();
+}
+
+// the largest number of occurrences of a kept seed. the seeds occurring more often are
+// the top freq_fraction of the distinct seeds, but a seed occurring at most
+// MIN_SEED_OCC_CUTOFF times is always kept. the counts saturate at 255.
+static int
+seed_occ_cutoff(const u1_t* counts, const long count, const double freq_fraction)
+{
+    long hist[256],distinct=0,above=0;
+    int c;
+    memset(hist,0,sizeof(hist));
+    for(long i=0; i<count; i++)hist[counts[i]]++;
+    for(c=1; c<256; c++)distinct+=hist[c];
+    const double max_above=freq_fraction*distinct;
+    for(c=255; c>1&&above+hist[c]<=max_above; c--)above+=hist[c];
+    if(c<MIN_SEED_OCC_CUTOFF)c=MIN_SEED_OCC_CUTOFF;
+    if(c>254)c=254;
+    return c;
+}
+
+// drops the seeds occurring more than occ_cutoff times, returns the number of positions kept
+static long
+sumvalue_x(u1_t *intarry,long count,int occ_cutoff)
+{
+    long i,sumval=0;
+    for(i=0; i<count; i++)
+    {
+        if(intarry[i]>0&&intarry[i]<=occ_cutoff)sumval=sumval+intarry[i];
+        else if(intarry[i]>occ_cutoff)intarry[i]=0;
+    }
+    return(sumval);
+}
+
+// calls f(seed, pos) for the seeds of the reference, pos being the 0-based start of the seed:
+// every k-mer, or the minimizers when minimizer_window > 0. the k-mers overlapping an N run are skipped.
+template <typename F>
+static void
+for_each_ref_seed(const PackedRef& ref, const int seed_len, const int minimizer_window, F& f)
+{
+    const u4_t mask=(1U<<(2*seed_len))-1;
+    MinimizerSampler sampler(seed_len, minimizer_window ? minimizer_window : 1);
+    u4_t eit=0;
+    long i;
+    int start=0;
+    size_t nrun=0;
+    for(i=0; i<ref.size; i++)
+    {
+        if(nrun<ref.nruns.size()&&ref.nruns[nrun].start==i)
+        {
+            i=ref.nruns[nrun].start+ref.nruns[nrun].size-1;
+            ++nrun;
+            eit=0;
+            start=0;
+            sampler.reset();
+            continue;
+        }
+        eit=((eit<<2)|ref.code(i))&mask;
+        if(++start<seed_len)continue;
+        if(minimizer_window)sampler.add(eit,i+1-seed_len,f);
+        else f(eit,i+1-seed_len);
+    }
+}
+
+namespace {
+
+struct SeedCounter
+{
+    u1_t* counts;
+    void operator()(const u4_t seed, const long pos) {
+        if(counts[seed]<255)counts[seed]=counts[seed]+1;
+    }
+};
+
+// the positions are stored 1-based
+struct SeedFiller
+{
+    u1_t* counts;
+    const RefPositions* offsets;
+    RefPositions* positions;
+    void operator()(const u4_t seed, const long pos) {
+        const long off=offsets->get(seed);
+        if(offsets->get(seed+1)>off)
+        {
+            positions->set(off+counts[seed],pos+1);
+            counts[seed]=counts[seed]+1;
+        }
+    }
+};
+
+}
+
+static long
+get_file_size(const char *path)
+{
+    struct stat statbuff;
+    if(stat(path, &statbuff) < 0) return -1;
+    return statbuff.st_size;
+}
+
+void
+RefIndex::build(const char* fastafile, const int seed_len, const int minimizer_window, const double freq_fraction)
+{
+    long length,count,i, rsize = 0;
+    FILE *fasta;
+    char ch,nameall[200],line[300];
+    clear();
+    this->seed_len=seed_len;
+    this->minimizer_window=minimizer_window;
+    indexcount=1L<<(2*seed_len);
+    //read reference seq
+    length=get_file_size(fastafile);
+    fasta=fopen(fastafile, "r");
+    if(!fasta)ERROR("failed to open file %s for reading", fastafile);
+
+    ref.reserve(length+1000);
+    for (ch=getc(fasta),count=0; ch!=EOF; ch=getc(fasta))
+    {
+        if(ch=='>')
+        {
+            assert(fscanf(fasta,"%[^\n]s",nameall) == 1);
+			if (rsize) {
+				sprintf(line, "%ld\n", rsize);
+				chr_table += line;
+			}
+			rsize = 0;
+			for(i=0;i<strlen(nameall);i++)if(nameall[i]==' '||nameall[i]=='\t')break;
+			nameall[i]='\0';
+            sprintf(line,"%ld\t%s\t",count,nameall);
+            chr_table += line;
+        }
+        else if(ch!='\n'&&ch!='\r')
+        {
+            ref.add_base(ch);
+            count=count+1;
+			++rsize;
+        }
+    }
+    fclose(fasta);
+	sprintf(line, "%ld\n", rsize);
+	chr_table += line;
+    sprintf(line,"%ld\t%s\n",count,"FileEnd");
+    chr_table += line;
+    printf("%ld\n",ref.size);
+//printf("Constructing look-up table...\n");
+    // the counts saturate at 255, sumvalue_x drops the seeds that occur more than occ_cutoff times
+    safe_calloc(counts,u1_t,indexcount);
+
+// Count the number
+    SeedCounter counter;
+    counter.counts=counts;
+    for_each_ref_seed(ref,seed_len,minimizer_window,counter);
+
+//Max_index
+    occ_cutoff=seed_occ_cutoff(counts,indexcount,freq_fraction);
+    fprintf(stderr,"seeds occurring more than %d times are ignored\n",occ_cutoff);
+    sumcount=sumvalue_x(counts,indexcount,occ_cutoff);
+    positions.alloc(sumcount,ref.size);
+    offsets.alloc(indexcount,sumcount);
+//allocate memory
+    sumcount=0;
+    for(i=0; i<indexcount; i++)
+    {
+        offsets.set(i,sumcount);
+        sumcount=sumcount+counts[i];
+        counts[i]=0;
+    }
+    offsets.set(indexcount,sumcount);
+
+//constructing the look-up table
+    SeedFiller filler;
+    filler.counts=counts;
+    filler.offsets=&offsets;
+    filler.positions=&positions;
+    for_each_ref_seed(ref,seed_len,minimizer_window,filler);
+}
+
+static void
+write_section(FILE* out, size_t& pos, const size_t off, const void* data, const size_t bytes)
+{
+	static const char zeros[8] = { 0 };
+	r_assert(off >= pos && off - pos < 8);
+	if (off > pos && fwrite(zeros, 1, off - pos, out) != off - pos) ERROR("failed to write the reference index");
+	if (bytes && fwrite(data, 1, bytes, out) != bytes) ERROR("failed to write the reference index");
+	pos = off + bytes;
+}
+
+void
+RefIndex::save(const char* path) const
+{
+	RefIndexHeader h;
+	memset(&h, 0, sizeof(RefIndexHeader));
+	memcpy(h.magic, REF_INDEX_MAGIC, 8);
+	h.version = REF_INDEX_VERSION;
+	h.seed_len = seed_len;
+	h.minimizer_window = minimizer_window;
+	h.occ_cutoff = occ_cutoff;
+	h.ref_size = ref.size;
+	h.num_nruns = ref.nruns.size();
+	h.indexcount = indexcount;
+	h.sumcount = sumcount;
+	h.chr_table_size = chr_table.size();
+	h.offsets_hi = (offsets.hi != NULL);
+	h.positions_hi = (positions.hi != NULL);
+	size_t off[kNumSections];
+	const size_t file_size = section_layout(h, off);
+
+	FILE* out = fopen(path, "wb");
+	if (!out) ERROR("failed to open file %s for writing", path);
+	size_t pos = 0;
+	write_section(out, pos, 0, &h, sizeof(RefIndexHeader));
+	write_section(out, pos, off[kSecPac], ref.pac, (ref.size + 3) / 4);
+	write_section(out, pos, off[kSecNRuns], ref.nruns.data(), ref.nruns.size() * sizeof(PackedRef::NRun));
+	write_section(out, pos, off[kSecCounts], counts, indexcount);
+	write_section(out, pos, off[kSecOffsetsLo], offsets.lo, (indexcount + 1) * sizeof(u4_t));
+	write_section(out, pos, off[kSecOffsetsHi], offsets.hi, offsets.hi ? indexcount + 1 : 0);
+	write_section(out, pos, off[kSecPositionsLo], positions.lo, sumcount * sizeof(u4_t));
+	write_section(out, pos, off[kSecPositionsHi], positions.hi, positions.hi ? sumcount : 0);
+	write_section(out, pos, off[kSecChrTable], chr_table.data(), chr_table.size());
+	write_section(out, pos, file_size, NULL, 0);
+	if (fclose(out)) ERROR("failed to write the reference index %s", path);
+}
+
+void
+RefIndex::load(const char* path)
+{
+	clear();
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) ERROR("failed to open file %s for reading", path);
+	struct stat sb;
+	r_assert(fstat(fd, &sb) == 0);
+	if ((size_t)sb.st_size < sizeof(RefIndexHeader)) ERROR("%s is not a reference index", path);
+	map_size = sb.st_size;
+	map_addr = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map_addr == MAP_FAILED) {
+		map_addr = NULL;
+		ERROR("failed to map the reference index %s", path);
+	}
+
+	const char* base = (const char*)map_addr;
+	RefIndexHeader h;
+	memcpy(&h, base, sizeof(RefIndexHeader));
+	if (memcmp(h.magic, REF_INDEX_MAGIC, 8)) ERROR("%s is not a reference index", path);
+	if (h.version != REF_INDEX_VERSION)
+		ERROR("reference index %s has version %u, version %d is required. Please rebuild it.", path, h.version, REF_INDEX_VERSION);
+	size_t off[kNumSections];
+	if (section_layout(h, off) != map_size) ERROR("reference index %s is truncated", path);
+
+	seed_len = h.seed_len;
+	minimizer_window = h.minimizer_window;
+	occ_cutoff = h.occ_cutoff;
+	indexcount = h.indexcount;
+	sumcount = h.sumcount;
+	ref.pac = (u1_t*)(base + off[kSecPac]);
+	ref.size = h.ref_size;
+	const PackedRef::NRun* nruns = (const PackedRef::NRun*)(base + off[kSecNRuns]);
+	ref.nruns.assign(nruns, nruns + h.num_nruns);
+	counts = (u1_t*)(base + off[kSecCounts]);
+	offsets.lo = (u4_t*)(base + off[kSecOffsetsLo]);
+	offsets.hi = h.offsets_hi ? (u1_t*)(base + off[kSecOffsetsHi]) : NULL;
+	positions.lo = (u4_t*)(base + off[kSecPositionsLo]);
+	positions.hi = h.positions_hi ? (u1_t*)(base + off[kSecPositionsHi]) : NULL;
+	chr_table.assign(base + off[kSecChrTable], h.chr_table_size);
+}
+
+bool
+is_ref_index_file(const char* path)
+{
+	char magic[8];
+	FILE* in = fopen(path, "rb");
+	if (!in) return false;
+	const bool r = fread(magic, 1, 8, in) == 8 && memcmp(magic, REF_INDEX_MAGIC, 8) == 0;
+	fclose(in);
+	return r;
+}
@@ -0,0 +1,65 @@
+#ifndef REF_INDEX_H
+#define REF_INDEX_H
+
+#include "packed_ref.h"
+
+#include <string>
+
+#define REF_INDEX_MAGIC "MECATRIX"
+#define REF_INDEX_VERSION 2
+
+// the seeds occurring at most this many times are always indexed
+#define MIN_SEED_OCC_CUTOFF 32
+// the default fraction of the most frequent distinct seeds left out of the index
+#define DEFAULT_SEED_FREQ_FRACTION 0.0002
+// the seeds of the index: every k-mer of the reference, sampled every few bases in
+// the reads, or the minimizers of both
+#define SEED_STRIDED 0
+#define SEED_MINIMIZER 1
+// the window of the minimizers when the reference is sampled by minimizers
+#define REF_MINIMIZER_WINDOW 10
+
+// the reference and its seed look-up table.
+// counts[s] positions of seed s start at offsets[s] in positions. the seeds are all
+// the k-mers of the reference, or its (minimizer_window, seed_len) minimizers, and
+// the seeds occurring more than occ_cutoff times have no position. occ_cutoff is
+// taken from the histogram of the seed counts.
+// chr_table is the content of chrindex.txt, one line "start\tname\tsize" per
+// sequence followed by "size\tFileEnd".
+// the index is either built from a fasta file or mapped read-only from an index
+// file written by save(), so that the pages are shared by the mapping processes.
+struct RefIndex
+{
+	int seed_len;
+	int minimizer_window;
+	int occ_cutoff;
+	long indexcount;
+	long sumcount;
+	PackedRef ref;
+	u1_t* counts;
+	RefPositions offsets;
+	RefPositions positions;
+	std::string chr_table;
+
+	void* map_addr;
+	size_t map_size;
+
+	RefIndex() : seed_len(0), minimizer_window(0), occ_cutoff(0), indexcount(0), sumcount(0), counts(NULL), map_addr(NULL), map_size(0) {}
+	~RefIndex() { clear(); }
+
+	void clear();
+
+	// minimizer_window is 0 for indexing every k-mer. the seeds among the top freq_fraction
+	// of the most frequent distinct seeds are left out.
+	void build(const char* fastafile, const int seed_len, const int minimizer_window, const double freq_fraction);
+
+	void save(const char* path) const;
+
+	void load(const char* path);
+};
+
+// whether path is an index file written by RefIndex::save()
+bool
+is_ref_index_file(const char* path);
+
+#endif // REF_INDEX_H
@@ -0,0 +1,35 @@
+#include "result_writer.h"
+#include "../common/defs.h"
+
+OrderedResultWriter::OrderedResultWriter(FILE* out)
+	: out(out), next_chunk_id(0)
+{
+	pthread_mutex_init(&lock, NULL);
+}
+
+OrderedResultWriter::~OrderedResultWriter()
+{
+	r_assert(pending.empty());
+	pthread_mutex_destroy(&lock);
+}
+
+void
+OrderedResultWriter::add(const long chunk_id, char* text, const size_t size)
+{
+	pthread_mutex_lock(&lock);
+	Chunk c;
+	c.text = text;
+	c.size = size;
+	pending[chunk_id] = c;
+	std::map<long, Chunk>::iterator it;
+	while ((it = pending.begin()) != pending.end() && it->first == next_chunk_id)
+	{
+		if (it->second.size && fwrite(it->second.text, 1, it->second.size, out) != it->second.size)
+			ERROR("failed to write the mapping results");
+		free(it->second.text);
+		pending.erase(it);
+		++next_chunk_id;
+	}
+	fflush(out);
+	pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,36 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <map>
+
+// writes the results of the chunks of reads in read order.
+// the chunks are numbered consecutively from 0 through all the batches. the mapping
+// thread that finishes a chunk hands its formatted results over with add(), and every
+// chunk whose predecessors have all been written is written at once, so that the
+// output grows while the mapping is still running.
+class OrderedResultWriter
+{
+public:
+	OrderedResultWriter(FILE* out);
+	~OrderedResultWriter();
+
+	// takes over text, which is freed once written
+	void add(const long chunk_id, char* text, const size_t size);
+
+private:
+	struct Chunk
+	{
+		char*  text;
+		size_t size;
+	};
+
+	FILE*                  out;
+	pthread_mutex_t        lock;
+	long                   next_chunk_id;
+	std::map<long, Chunk>  pending;
+};
+
+#endif // RESULT_WRITER_H
@@ -0,0 +1,247 @@
+#include "sam_record.h"
+
+#include <cctype>
+#include <cstring>
+
+static char
+read_base(const char c)
+{
+	switch (toupper(c)) {
+		case 'A': return 'A';
+		case 'C': return 'C';
+		case 'G': return 'G';
+		case 'T': return 'T';
+	}
+	return 'N';
+}
+
+static char
+complement_base(const char c)
+{
+	switch (c) {
+		case 'A': return 'T';
+		case 'C': return 'G';
+		case 'G': return 'C';
+		case 'T': return 'A';
+	}
+	return 'N';
+}
+
+static void
+add_cigar_op(std::vector<u4_t>& cigar, const int op, const u4_t len)
+{
+	if (len == 0) return;
+	if (!cigar.empty() && (int)(cigar.back() & 0xf) == op) cigar.back() += len << 4;
+	else cigar.push_back(len << 4 | op);
+}
+
+static void
+append_int(std::string& s, long v)
+{
+	char buf[24];
+	int n = 0;
+	const bool neg = v < 0;
+	if (neg) v = -v;
+	do { buf[n++] = '0' + v % 10; v /= 10; } while (v);
+	if (neg) s += '-';
+	while (n) s += buf[--n];
+}
+
+void
+build_sam_alignment(const TempResult* result, const SamReadInfo* sri, SamAlignment& sa)
+{
+	const char* qmap = result->qmap;
+	const char* smap = result->smap;
+	const int qsize = result->qs;
+	const bool hard_clip = (sri->flag & SAM_FLAG_SUPPLEMENTARY) != 0;
+	const int clip_op = hard_clip ? CIGAR_H : CIGAR_S;
+	sa.flag = sri->flag | ((result->read_dir == 'R') ? SAM_FLAG_REVERSE : 0);
+	sa.cigar.clear();
+	sa.md.clear();
+	sa.seq.clear();
+	sa.nm = 0;
+	sa.ref_len = 0;
+
+	add_cigar_op(sa.cigar, clip_op, result->qb);
+	int matches = 0;
+	for (int i = 0; qmap[i]; ++i)
+	{
+		if (qmap[i] == '-') // delete from reference
+		{
+			add_cigar_op(sa.cigar, CIGAR_D, 1);
+			if (i == 0 || qmap[i - 1] != '-')
+			{
+				append_int(sa.md, matches);
+				matches = 0;
+				sa.md += '^';
+			}
+			sa.md += smap[i];
+			++sa.nm;
+			++sa.ref_len;
+		}
+		else if (smap[i] == '-') // insertion into reference
+		{
+			add_cigar_op(sa.cigar, CIGAR_I, 1);
+			++sa.nm;
+		}
+		else // match or mismatch
+		{
+			add_cigar_op(sa.cigar, CIGAR_M, 1);
+			if (qmap[i] == smap[i])
+			{
+				++matches;
+			}
+			else
+			{
+				append_int(sa.md, matches);
+				matches = 0;
+				sa.md += smap[i];
+				++sa.nm;
+			}
+			++sa.ref_len;
+		}
+	}
+	append_int(sa.md, matches);
+	add_cigar_op(sa.cigar, clip_op, qsize - result->qe);
+
+	// the read bases on the strand the alignment was computed on
+	const int sb = hard_clip ? result->qb : 0;
+	const int se = hard_clip ? result->qe : qsize;
+	sa.seq.resize(se - sb);
+	if (result->read_dir == 'R')
+		for (int i = sb; i < se; ++i) sa.seq[i - sb] = complement_base(read_base(sri->read[qsize - 1 - i]));
+	else
+		for (int i = sb; i < se; ++i) sa.seq[i - sb] = read_base(sri->read[i]);
+}
+
+void
+output_sam(const TempResult* result, const char* chr_name, const long chr_start, const SamReadInfo* sri, FILE* out)
+{
+	static const char cigar_ops[] = "MIDNSHP=X";
+	SamAlignment sa;
+	build_sam_alignment(result, sri, sa);
+	std::string r;
+	r.reserve(2 * sa.seq.size() + sa.md.size() + 8 * sa.cigar.size() + 256);
+	r += sri->read_name; /// 1) qname
+	r += '\t';
+	append_int(r, sa.flag); /// 2) flag
+	r += '\t';
+	r += chr_name; /// 3) rname
+	r += '\t';
+	append_int(r, result->sb - chr_start + 1); /// 4) 1-based left most position
+	r += '\t';
+	append_int(r, sri->mapq); /// 5) mapq
+	r += '\t';
+	for (size_t i = 0; i < sa.cigar.size(); ++i) /// 6) cigar
+	{
+		append_int(r, sa.cigar[i] >> 4);
+		r += cigar_ops[sa.cigar[i] & 0xf];
+	}
+	r += "\t*\t0\t0\t"; /// 7) rnext 8) pnext 9) tlen
+	r += sa.seq; /// 10) seq
+	r += "\t*\tNM:i:"; /// 11) qual
+	append_int(r, sa.nm);
+	r += "\tMD:Z:";
+	r += sa.md;
+	r += '\n';
+	fwrite(r.data(), 1, r.size(), out);
+}
+
+static void
+put_u16(std::vector<char>& b, const u4_t v)
+{
+	b.push_back(v & 0xff);
+	b.push_back((v >> 8) & 0xff);
+}
+
+static void
+put_u32(std::vector<char>& b, const u4_t v)
+{
+	put_u16(b, v & 0xffff);
+	put_u16(b, v >> 16);
+}
+
+// 4-bit code of a base in "=ACMGRSVTWYHKDBN"
+static u1_t
+bam_seq_code(const char c)
+{
+	switch (c) {
+		case 'A': return 1;
+		case 'C': return 2;
+		case 'G': return 4;
+		case 'T': return 8;
+	}
+	return 15;
+}
+
+// the BAI bin of the reference interval [beg, end)
+static int
+reg2bin(int beg, int end)
+{
+	--end;
+	if (beg >> 14 == end >> 14) return ((1 << 15) - 1) / 7 + (beg >> 14);
+	if (beg >> 17 == end >> 17) return ((1 << 12) - 1) / 7 + (beg >> 17);
+	if (beg >> 20 == end >> 20) return ((1 << 9) - 1) / 7 + (beg >> 20);
+	if (beg >> 23 == end >> 23) return ((1 << 6) - 1) / 7 + (beg >> 23);
+	if (beg >> 26 == end >> 26) return ((1 << 3) - 1) / 7 + (beg >> 26);
+	return 0;
+}
+
+void
+output_bam(const TempResult* result, const int ref_id, const long chr_start, const SamReadInfo* sri, FILE* out)
+{
+	SamAlignment sa;
+	build_sam_alignment(result, sri, sa);
+	const int pos = result->sb - chr_start;
+	const int l_seq = sa.seq.size();
+	const int l_read_name = strlen(sri->read_name) + 1;
+	std::vector<char> b;
+	b.reserve(64 + l_read_name + 4 * sa.cigar.size() + l_seq * 2 + sa.md.size());
+	put_u32(b, 0); // block_size, set below
+	put_u32(b, ref_id);
+	put_u32(b, pos);
+	b.push_back(l_read_name);
+	b.push_back(sri->mapq);
+	put_u16(b, reg2bin(pos, pos + sa.ref_len));
+	put_u16(b, sa.cigar.size());
+	put_u16(b, sa.flag);
+	put_u32(b, l_seq);
+	put_u32(b, (u4_t)-1); // next_refID
+	put_u32(b, (u4_t)-1); // next_pos
+	put_u32(b, 0); // tlen
+	b.insert(b.end(), sri->read_name, sri->read_name + l_read_name);
+	for (size_t i = 0; i < sa.cigar.size(); ++i) put_u32(b, sa.cigar[i]);
+	for (int i = 0; i < l_seq; i += 2)
+	{
+		u1_t c = bam_seq_code(sa.seq[i]) << 4;
+		if (i + 1 < l_seq) c |= bam_seq_code(sa.seq[i + 1]);
+		b.push_back(c);
+	}
+	b.insert(b.end(), l_seq, (char)0xff); // qual
+	b.push_back('N'); b.push_back('M'); b.push_back('i');
+	put_u32(b, sa.nm);
+	b.push_back('M'); b.push_back('D'); b.push_back('Z');
+	b.insert(b.end(), sa.md.begin(), sa.md.end());
+	b.push_back('\0');
+
+	const u4_t block_size = b.size() - 4;
+	for (int i = 0; i < 4; ++i) b[i] = (block_size >> (8 * i)) & 0xff;
+	fwrite(b.data(), 1, b.size(), out);
+}
+
+void
+build_bam_header(const char* text, const size_t text_size, const fastaindexinfo* chr_idx, const int num_chr, std::vector<char>& header)
+{
+	header.clear();
+	header.push_back('B'); header.push_back('A'); header.push_back('M'); header.push_back('\1');
+	put_u32(header, text_size);
+	header.insert(header.end(), text, text + text_size);
+	put_u32(header, num_chr);
+	for (int i = 0; i < num_chr; ++i)
+	{
+		const int l_name = strlen(chr_idx[i].chrname) + 1;
+		put_u32(header, l_name);
+		header.insert(header.end(), chr_idx[i].chrname, chr_idx[i].chrname + l_name);
+		put_u32(header, chr_idx[i].chrsize);
+	}
+}
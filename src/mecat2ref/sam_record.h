@@ -0,0 +1,42 @@
+#ifndef SAM_RECORD_H
+#define SAM_RECORD_H
+
+#include "output.h"
+#include "../common/defs.h"
+
+#include <string>
+#include <vector>
+
+// BAM codes of the CIGAR operations
+#define CIGAR_M 0
+#define CIGAR_I 1
+#define CIGAR_D 2
+#define CIGAR_S 4
+#define CIGAR_H 5
+
+// what the SAM and BAM records of an alignment share
+struct SamAlignment
+{
+	int flag;
+	std::vector<u4_t> cigar;	// length << 4 | operation
+	int nm;						// edit distance to the reference
+	std::string md;				// MD tag, the reference bases that differ from the read
+	std::string seq;			// the read bases in SEQ, on the strand of the reference
+	long ref_len;				// number of reference bases covered
+};
+
+// supplementary alignments are hard clipped, the others are soft clipped and carry the whole read
+void
+build_sam_alignment(const TempResult* result, const SamReadInfo* sri, SamAlignment& sa);
+
+void
+output_sam(const TempResult* result, const char* chr_name, const long chr_start, const SamReadInfo* sri, FILE* out);
+
+void
+output_bam(const TempResult* result, const int ref_id, const long chr_start, const SamReadInfo* sri, FILE* out);
+
+// the uncompressed BAM header: the SAM header text and the reference sequences
+void
+build_bam_header(const char* text, const size_t text_size, const fastaindexinfo* chr_idx, const int num_chr, std::vector<char>& header);
+
+#endif // SAM_RECORD_H